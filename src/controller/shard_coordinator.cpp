@@ -0,0 +1,323 @@
+#include "shard_coordinator.h"
+#include "model/result_cache.h"
+#include "model/simulation_runner.h"
+#include "model/varint.h"
+#include "../utils/logger.h"
+#include <cerrno>
+#include <deque>
+#include <map>
+#include <vector>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace arctic {
+
+namespace {
+
+struct TShard {
+    Ui64 Begin = 0;
+    Ui64 End = 0;
+    Ui32 Attempt = 0;
+};
+
+struct TWorker {
+    pid_t Pid = -1;
+    int Fd = -1;
+    bool Busy = false;
+    TShard Shard;
+    std::vector<Ui8> Inbox;
+};
+
+bool WriteAll(int fd, const Ui8* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool WriteFrame(int fd, const std::vector<Ui8>& payload) {
+    std::vector<Ui8> frame;
+    WriteVarint(frame, payload.size());
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    return WriteAll(fd, frame.data(), frame.size());
+}
+
+bool ReadAll(int fd, Ui8* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = read(fd, data, size);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        size -= got;
+    }
+    return true;
+}
+
+bool ReadFrame(int fd, std::vector<Ui8>& payload) {
+    Ui64 length = 0;
+    for (Ui32 shift = 0; shift < 64; shift += 7) {
+        Ui8 byte = 0;
+        if (!ReadAll(fd, &byte, 1)) {
+            return false;
+        }
+        length |= static_cast<Ui64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            payload.resize(length);
+            return ReadAll(fd, payload.data(), length);
+        }
+    }
+    return false;
+}
+
+// Достаёт из буфера один полный кадр, если он уже пришёл целиком.
+bool PopFrame(std::vector<Ui8>& inbox, std::vector<Ui8>& payload) {
+    const Ui8* pos = inbox.data();
+    const Ui8* end = inbox.data() + inbox.size();
+    Ui64 length = 0;
+    if (!ReadVarint(pos, end, length) || length > static_cast<Ui64>(end - pos)) {
+        return false;
+    }
+    payload.assign(pos, pos + length);
+    inbox.erase(inbox.begin(), inbox.begin() + (pos - inbox.data()) + length);
+    return true;
+}
+
+[[noreturn]] void WorkerLoop(int fd, const TSimulationConfig& config, const TShardingOptions& options) {
+    std::vector<Ui8> request;
+    while (ReadFrame(fd, request)) {
+        const Ui8* pos = request.data();
+        const Ui8* end = request.data() + request.size();
+        Ui64 begin = 0;
+        Ui64 shardEnd = 0;
+        Ui64 attempt = 0;
+        if (!ReadVarint(pos, end, begin) || !ReadVarint(pos, end, shardEnd) || !ReadVarint(pos, end, attempt)) {
+            _exit(2);
+        }
+        if (attempt == 0 && options.CrashAtSimIndex >= begin && options.CrashAtSimIndex < shardEnd) {
+            _exit(1);
+        }
+
+        TSimulationStats delta;
+        for (Ui64 simIndex = begin; simIndex < shardEnd; ++simIndex) {
+            delta.AddResult(RunSingleSimulation(config, options.BaseSeed, simIndex));
+        }
+
+        std::vector<Ui8> reply;
+        WriteVarint(reply, begin);
+        WriteVarint(reply, shardEnd);
+        delta.Serialize(reply);
+        if (!WriteFrame(fd, reply)) {
+            _exit(3);
+        }
+    }
+    _exit(0);
+}
+
+bool SpawnWorker(TWorker& worker, const std::vector<TWorker>& workers, const TSimulationConfig& config,
+                 const TShardingOptions& options) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        LOG_ERROR("RunShardedEstimate: socketpair failed, errno " + std::to_string(errno));
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_ERROR("RunShardedEstimate: fork failed, errno " + std::to_string(errno));
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // Иначе воркеры пишут в файл лога координатора и переименовывают его сегменты.
+        Logger::DetachFileAfterFork();
+        // Иначе чужие сокеты останутся открытыми и координатор не увидит EOF.
+        close(fds[0]);
+        for (const TWorker& other : workers) {
+            if (other.Fd >= 0) {
+                close(other.Fd);
+            }
+        }
+        WorkerLoop(fds[1], config, options);
+    }
+    close(fds[1]);
+    worker = TWorker();
+    worker.Pid = pid;
+    worker.Fd = fds[0];
+    return true;
+}
+
+void StopWorker(TWorker& worker) {
+    if (worker.Busy && worker.Pid > 0) {
+        kill(worker.Pid, SIGKILL);
+    }
+    if (worker.Fd >= 0) {
+        close(worker.Fd);
+        worker.Fd = -1;
+    }
+    if (worker.Pid > 0) {
+        waitpid(worker.Pid, nullptr, 0);
+        worker.Pid = -1;
+    }
+}
+
+} // namespace
+
+bool RunShardedEstimate(const TSimulationConfig& config, const TShardingOptions& options, TSimulationStats& stats) {
+    if (options.Workers == 0 || options.ShardSize == 0) {
+        LOG_ERROR("RunShardedEstimate: workers and shard size must be positive");
+        return false;
+    }
+
+    std::deque<TShard> pending;
+    for (Ui64 begin = options.FirstSimIndex; begin < options.FirstSimIndex + options.SimCount; begin += options.ShardSize) {
+        TShard shard;
+        shard.Begin = begin;
+        shard.End = std::min(begin + options.ShardSize, options.FirstSimIndex + options.SimCount);
+        pending.push_back(shard);
+    }
+    size_t shardsLeft = pending.size();
+
+    std::vector<TWorker> workers(std::min<size_t>(options.Workers, std::max<size_t>(1, shardsLeft)));
+    for (TWorker& worker : workers) {
+        if (!SpawnWorker(worker, workers, config, options)) {
+            for (TWorker& started : workers) {
+                StopWorker(started);
+            }
+            return false;
+        }
+    }
+
+    bool ok = true;
+    std::vector<Ui8> payload;
+    // Сводки прогонов в статистике идут по индексам, поэтому шарды сливаются
+    // в порядке индексов, а не по мере готовности.
+    std::map<Ui64, TSimulationStats> finished;
+    while (ok && shardsLeft > 0) {
+        for (TWorker& worker : workers) {
+            if (worker.Busy || pending.empty()) {
+                continue;
+            }
+            worker.Shard = pending.front();
+            pending.pop_front();
+            worker.Busy = true;
+            std::vector<Ui8> request;
+            WriteVarint(request, worker.Shard.Begin);
+            WriteVarint(request, worker.Shard.End);
+            WriteVarint(request, worker.Shard.Attempt);
+            // Если запись не удалась, воркер мёртв: это обнаружится ниже как EOF.
+            WriteFrame(worker.Fd, request);
+        }
+
+        std::vector<pollfd> pollFds;
+        std::vector<size_t> pollWorkers;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            if (workers[i].Busy) {
+                pollFds.push_back({workers[i].Fd, POLLIN, 0});
+                pollWorkers.push_back(i);
+            }
+        }
+        if (poll(pollFds.data(), pollFds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("RunShardedEstimate: poll failed, errno " + std::to_string(errno));
+            ok = false;
+            break;
+        }
+
+        for (size_t p = 0; p < pollFds.size() && ok; ++p) {
+            if (!pollFds[p].revents) {
+                continue;
+            }
+            TWorker& worker = workers[pollWorkers[p]];
+            Ui8 buffer[4096];
+            ssize_t got = read(worker.Fd, buffer, sizeof(buffer));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                TShard failed = worker.Shard;
+                StopWorker(worker);
+                failed.Attempt++;
+                LOG_WARNING("RunShardedEstimate: worker died on shard [" + std::to_string(failed.Begin) + ", " +
+                            std::to_string(failed.End) + "), attempt " + std::to_string(failed.Attempt));
+                if (failed.Attempt >= options.MaxShardAttempts) {
+                    LOG_ERROR("RunShardedEstimate: shard failed too many times, giving up");
+                    ok = false;
+                    break;
+                }
+                pending.push_front(failed);
+                ok = SpawnWorker(worker, workers, config, options);
+                continue;
+            }
+            worker.Inbox.insert(worker.Inbox.end(), buffer, buffer + got);
+
+            if (PopFrame(worker.Inbox, payload)) {
+                const Ui8* pos = payload.data();
+                const Ui8* end = payload.data() + payload.size();
+                Ui64 begin = 0;
+                Ui64 shardEnd = 0;
+                TSimulationStats delta;
+                if (!ReadVarint(pos, end, begin) || !ReadVarint(pos, end, shardEnd) ||
+                    begin != worker.Shard.Begin || shardEnd != worker.Shard.End ||
+                    !delta.Deserialize(pos, end)) {
+                    LOG_ERROR("RunShardedEstimate: malformed reply from worker " + std::to_string(worker.Pid));
+                    ok = false;
+                    break;
+                }
+                finished.emplace(begin, std::move(delta));
+                worker.Busy = false;
+                shardsLeft--;
+            }
+        }
+    }
+
+    for (TWorker& worker : workers) {
+        StopWorker(worker);
+    }
+    if (ok) {
+        for (const auto& [begin, delta] : finished) {
+            stats.Merge(delta);
+        }
+    }
+    return ok;
+}
+
+bool RunCachedEstimate(const TSimulationConfig& config, TShardingOptions options, Ui64 simCount, TCheckpoint& result) {
+    if (!TResultCache::Instance().Get(config, result)) {
+        result = TCheckpoint::ForConfig(config);
+        result.BaseSeed = options.BaseSeed;
+    }
+    if (result.NextSimIndex >= simCount) {
+        return true;
+    }
+    options.BaseSeed = result.BaseSeed;
+    options.FirstSimIndex = result.NextSimIndex;
+    options.SimCount = simCount - result.NextSimIndex;
+    TSimulationStats delta;
+    if (!RunShardedEstimate(config, options, delta)) {
+        return false;
+    }
+    result.Stats.Merge(delta);
+    result.NextSimIndex = simCount;
+    TResultCache::Instance().Put(result);
+    return true;
+}
+
+} // namespace arctic
@@ -0,0 +1,34 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <limits>
+#include "model/checkpoint.h"
+#include "model/simulation_params.h"
+#include "model/simulation_stats.h"
+
+namespace arctic {
+
+struct TShardingOptions {
+    Ui32 Workers = 2;
+    Ui64 BaseSeed = 0;
+    Ui64 FirstSimIndex = 0;
+    Ui64 SimCount = 0;
+    Ui64 ShardSize = 256;
+    Ui32 MaxShardAttempts = 3;
+    // Для тестов: воркер завершается аварийно на первой попытке шарда с этим индексом.
+    Ui64 CrashAtSimIndex = std::numeric_limits<Ui64>::max();
+};
+
+// Раздаёт воркер-процессам непересекающиеся диапазоны индексов прогонов
+// [FirstSimIndex, FirstSimIndex + SimCount) и складывает присланные ими
+// дельты статистики. Шард упавшего воркера отдаётся заново новому воркеру.
+// Обмен идёт через Unix-сокеты кадрами [varint длина][payload], так что
+// локальные процессы можно заменить удалёнными узлами без смены протокола.
+// Прогоны идут с config, воркеры получают его вместе с памятью родителя при fork.
+bool RunShardedEstimate(const TSimulationConfig& config, const TShardingOptions& options, TSimulationStats& stats);
+
+// Доводит оценку для config до simCount прогонов, продолжая
+// запись из TResultCache (её BaseSeed и NextSimIndex важнее options), и кладёт
+// результат обратно. Повторный запуск точки перебора досчитывает только недостающее.
+bool RunCachedEstimate(const TSimulationConfig& config, TShardingOptions options, Ui64 simCount, TCheckpoint& result);
+
+} // namespace arctic
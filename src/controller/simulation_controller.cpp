@@ -11,12 +11,6 @@ const Ui32 kScreenWidth = 1920;
 const Ui32 kScreenHeight = 1080;
 
 
-std::mt19937& GetThreadLocalRng() {
-    thread_local static std::mt19937 rng(std::random_device{}() + 
-                                         std::hash<std::thread::id>{}(std::this_thread::get_id()));
-    return rng;
-}
-
 void SimulationController::Initialize() {
     LOG("Initializing SimulationController"); 
     try {
@@ -30,10 +24,37 @@ void SimulationController::Initialize() {
         GFont.Load("data/arctic_one_bmf.fnt");
 
         InitializeGui(Gui);
-        Sim.Reset();
-        DataLossByDay.clear();
-        TotalSimsByDay.clear();
+        if (GRecordTraces) {
+            TTraceWriter::Instance().Open(GTraceFileName);
+        }
         GSims = 0;
+        if (GBaseSeed == 0) {
+            GBaseSeed = (static_cast<Ui64>(std::random_device{}()) << 32) | std::random_device{}();
+        }
+        Params = TSimulationParams::FromGlobals();
+        if (Params.HazardModel == kHazardReplay && !FindFailureLog(Params.FailureLogFingerprint)) {
+            if (const auto log = OpenFailureLog(GFailureLogFileName)) {
+                Params.FailureLogFingerprint = log->GetFingerprint();
+            }
+        }
+        UpdateAnalyticEstimate();
+        EngineParams = Params;
+        TSimulationConfig config;
+        if (!TSimulationConfig::FromParams(Params, config)) {
+            LOG_ERROR("Simulation is not started: failure log " + GFailureLogFileName + " could not be loaded");
+            return;
+        }
+        TEngineSnapshot initial;
+        initial.Params = Params;
+        initial.ControlCalibrationRuns = config.ControlCalibrationRuns;
+        initial.StratifiedSampling = config.StratifiedSampling;
+        initial.BaseSeed = GBaseSeed;
+        ResumeFromCheckpoint(config, initial);
+        LastCheckpointTime = std::chrono::steady_clock::now();
+
+        // Прогоны идут на отдельных потоках, кадр только читает последний снимок статистики.
+        const Ui32 workers = std::max(1u, std::thread::hardware_concurrency() - 1);
+        SimEngine.Start(workers, initial);
     } catch (const std::exception& e) {
         LOG_ERROR("Exception in Initialize: " + std::string(e.what()));
     } catch (...) {
@@ -44,65 +65,85 @@ void SimulationController::Initialize() {
 
 void SimulationController::Update() {
     LOG_DEBUG("Update start");
-    HandleGuiEvents();
-
-    if (GDoRestart) {
+    if (HandleGuiEvents()) {
+        UpdateAnalyticEstimate();
+    }
+    if (Params == EngineParams) {
+        if (HasWhatIf) {
+            HasWhatIf = false;
+            Plot.Invalidate();
+        }
+    } else if (!UpdateWhatIf()) {
         LOG_DEBUG("Restarting simulation");
-        GDoRestart = false;
-
-        DataLossByDay.clear();
-        TotalSimsByDay.clear();
-        GSims = 0;
+        // Отвергнутые движком параметры не отправляются повторно в каждом кадре.
+        SimEngine.PostParams(Params, GBaseSeed);
+        EngineParams = Params;
+        HasWhatIf = false;
+        Plot.Invalidate();
     }
 
-    const unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency() - 1);
-    LOG_DEBUG("Launching " + std::to_string(num_threads) + " simulation threads.");
-
-
-    std::vector<std::future<SimulationResult>> futures;
-
+    UpdateStatistics();
+    SaveCheckpointIfDue();
 
-    for (unsigned int i = 0; i < num_threads; ++i) {
+    LOG_DEBUG("Update end, total simulations: " + std::to_string(GSims));
+}
 
+void SimulationController::UpdateAnalyticEstimate() {
+    // Цепь решается за миллисекунды, так что считается прямо в кадре смены параметров.
+    HasAnalytic = EstimateLossMarkov(Params, Analytic);
+    Plot.Invalidate();
+}
 
-        futures.push_back(std::async(std::launch::async, &SimulationController::RunSingleSimulation, this));
+bool SimulationController::UpdateWhatIf() {
+    // Снимок может ещё относиться к параметрам до последней отправки в движок.
+    const TEngineSnapshot& snapshot = SimEngine.ReadSnapshot();
+    TSimulationParams sameRate = Params;
+    sameRate.FailureRate = snapshot.Params.FailureRate;
+    if (!(snapshot.Params == EngineParams) || !(sameRate == snapshot.Params)) {
+        return false;
     }
-    // Идея для оптимизации:
-    // поток прерывает работу если получил дата лосс
-    // потоки пишут в очередь
-    // мы читаем по одному
-
-    for (auto& fut : futures) {
-        try {
-            SimulationResult result = fut.get(); 
-
-
-            GSims++;
-
-
-            for (int day = 0; day < result.daysSimulated; ++day) {
-                if (!TotalSimsByDay.count(day)) TotalSimsByDay[day] = 0;
-                TotalSimsByDay[day]++;
-            }
-
-
-            if (result.lossDay != -1) {
-                for (int d = result.lossDay; d < 30; ++d) {
-                    if (!DataLossByDay.count(d)) DataLossByDay[d] = 0;
-                    DataLossByDay[d]++;
-                }
-            }
-        } catch (const std::exception& e) {
-            LOG_ERROR("Exception caught while getting simulation result: " + std::string(e.what()));
-        } catch (...) {
-            LOG_ERROR("Unknown exception caught while getting simulation result.");
-        }
+    // Пока сводки копятся, оценка обновляется с каждым снимком, потом только при смене интенсивности.
+    if (HasWhatIf && WhatIf.FailureRate == Params.FailureRate && WhatIf.Runs == snapshot.Stats.RunSummaries.Size()) {
+        return true;
     }
+    HasWhatIf = ReweightFailureRate(snapshot.Stats, snapshot.Params, Params.FailureRate, WhatIf) &&
+                WhatIf.EffectiveSampleSize >= GReweightMinEss;
+    Plot.Invalidate();
+    return HasWhatIf;
+}
 
+void SimulationController::ResumeFromCheckpoint(const TSimulationConfig& config, TEngineSnapshot& initial) {
+    TCheckpoint checkpoint;
+    bool found = !GCheckpointFileName.empty() && LoadCheckpoint(GCheckpointFileName, checkpoint);
+    if (found && !checkpoint.IsSameEstimate(TCheckpoint::ForConfig(config))) {
+        LOG("Checkpoint " + GCheckpointFileName + " has different parameters or estimation settings, keeping it in the result cache");
+        // Оценка для других параметров не пропадает: она пригодится, если к ним вернутся.
+        TResultCache::Instance().Put(checkpoint);
+        found = false;
+    }
+    if (!found && !TResultCache::Instance().Get(config, checkpoint)) {
+        return;
+    }
+    GBaseSeed = checkpoint.BaseSeed;
+    initial.BaseSeed = checkpoint.BaseSeed;
+    initial.NextSimIndex = checkpoint.NextSimIndex;
+    initial.Stats = std::move(checkpoint.Stats);
+    GSims = initial.Stats.Sims;
+    LOG("Resumed with " + std::to_string(GSims) + " simulations" + (found ? " from checkpoint " + GCheckpointFileName : " from the result cache"));
+}
 
-    UpdateStatistics();
+void SimulationController::SaveCheckpointIfDue() {
+    const TEngineSnapshot& snapshot = SimEngine.ReadSnapshot();
+    if (GCheckpointFileName.empty() || GCheckpointIntervalSeconds == 0 || snapshot.Stats.Sims == 0) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - LastCheckpointTime < std::chrono::seconds(GCheckpointIntervalSeconds)) {
+        return;
+    }
+    LastCheckpointTime = now;
 
-    LOG_DEBUG("Update end, total simulations: " + std::to_string(GSims));
+    SaveCheckpoint(GCheckpointFileName, snapshot.ToCheckpoint());
 }
 
 void SimulationController::ProcessInput() {
@@ -114,108 +155,16 @@ void SimulationController::ProcessInput() {
 }
 
 
-SimulationResult SimulationController::RunSingleSimulation() {
-
-    auto& rng = GetThreadLocalRng();
-
-    Simulation localSim; 
-    localSim.Reset();    
-
-    SimulationResult result;
-    bool hadDataLoss = false;
-
-    const Si32 maxIterations = 30 * 24; 
-    Si32 iterations = 0;
-
-    for (int day = 0; day < 30; ++day) {
-        result.daysSimulated++; 
-
-        for (int hour = 0; hour < 24; ++hour) {
-            iterations++;
-            if (iterations > maxIterations) {
-                LOG_ERROR("Single simulation exceeded maximum iterations!");
-
-
-                return result;
-            }
-
-            localSim.SimulateHour(rng);
-            if (!localSim.LostGroupInfo.empty()) { 
-                 if (!hadDataLoss) {
-                     result.lossDay = day;
-                     hadDataLoss = true;
-                 }
-                 break;
-            }
-        }
-        if (hadDataLoss) {
-            break;
-        }
-    }
-
-    return result;
-}
-
-void SimulationController::RunSimulation() {
-    LOG_DEBUG("Starting simulation run");
-    Sim.Reset();
-    bool hadDataLoss = false;
-    int lossDay = -1; 
-
-    const Si32 maxIterations = 30 * 24;
-    Si32 iterations = 0;
-    auto& rng = GetThreadLocalRng();
-
-    for (Si32 day = 0; day < 30; ++day) {
-
-
-        if (!TotalSimsByDay.count(day)) TotalSimsByDay[day] = 0;
-        TotalSimsByDay[day]++;
-
-        for (Si32 hour = 0; hour < 24; ++hour) {
-            iterations++;
-            if (iterations > maxIterations) {
-                LOG_ERROR("Simulation exceeded maximum iterations!");
-
-                 goto end_simulation; 
-            }
-
-            Sim.SimulateHour(rng);
-
-            if (!Sim.LostGroupInfo.empty()) { 
-                if (!hadDataLoss) { 
-                    LOG_DEBUG("Data loss occurred on day " + std::to_string(day));
-                    lossDay = day;
-                    hadDataLoss = true;
-
-                }
-
-                break;
-            }
-        }
-        if (hadDataLoss) {
-            break;
-        }
-    }
-
-end_simulation: 
-
-    if (hadDataLoss) {
-        for (Si32 d = lossDay; d < 30; ++d) {
-            if (!DataLossByDay.count(d)) DataLossByDay[d] = 0;
-            DataLossByDay[d]++;
-        }
-    }
-    GSims++;
-    LOG_DEBUG("Simulation completed. Total sims: " + std::to_string(GSims));
-}
-
 void SimulationController::UpdateStatistics() {
-    if (GSims > 0) {
-        double overallLossCount = DataLossByDay.count(29) ? DataLossByDay[29] : 0.0;
-        GDataLossProb = overallLossCount / static_cast<double>(GSims);
-
-        LOG_DEBUG("UpdateStatistics: Overall Stats - Total Losses: " + std::to_string(overallLossCount) +
+    const TEngineSnapshot& snapshot = SimEngine.ReadSnapshot();
+    const TSimulationStats& stats = snapshot.Stats;
+    GSims = stats.Sims;
+    if (HasWhatIf) {
+        GDataLossProb = WhatIf.GetLossProbability(Params.HorizonHours);
+    } else if (GSims > 0) {
+        GDataLossProb = stats.GetLossProbability(snapshot.Params.HorizonHours);
+
+        LOG_DEBUG("UpdateStatistics: Overall Stats - Total Losses: " + std::to_string(stats.GetLossCount()) +
                    ", Total Sims Run: " + std::to_string(GSims));
         LOG_DEBUG("UpdateStatistics: Calculated GDataLossProb = " + std::to_string(GDataLossProb));
     } else {
@@ -224,79 +173,168 @@ void SimulationController::UpdateStatistics() {
     }
 }
 
-void SimulationController::HandleGuiEvents() {
-    if (GDisksPerDc != Gui.ScrollDisksPerDc->GetValue()) {
-        GDisksPerDc = Gui.ScrollDisksPerDc->GetValue();
-        GDoRestart = true;
+bool SimulationController::HandleGuiEvents() {
+    bool changed = false;
+    if (Params.HorizonHours != static_cast<Ui32>(Gui.ScrollHorizonDays->GetValue()) * 24) {
+        Params.HorizonHours = Gui.ScrollHorizonDays->GetValue() * 24;
+        changed = true;
+        std::stringstream str;
+        str << "Horizon: " << Params.HorizonHours / 24 << " days";
+        Gui.TextHorizon->SetText(str.str());
+    }
+    if (Params.DisksPerDc != Gui.ScrollDisksPerDc->GetValue()) {
+        Params.DisksPerDc = Gui.ScrollDisksPerDc->GetValue();
+        changed = true;
         std::stringstream str;
-        str << "Disks per DC: " << GDisksPerDc;
+        str << "Disks per DC: " << Params.DisksPerDc;
         Gui.TextDisksPerDc->SetText(str.str());
     }
-    if (GDiskSize != Gui.ScrollDiskSize->GetValue()) {
-        GDiskSize = Gui.ScrollDiskSize->GetValue();
-        GDoRestart = true;
+    if (Params.DiskSize != Gui.ScrollDiskSize->GetValue()) {
+        Params.DiskSize = Gui.ScrollDiskSize->GetValue();
+        changed = true;
         std::stringstream str;
-        str << "Disk Size: " << GDiskSize << " GB";
+        str << "Disk Size: " << Params.DiskSize << " GB";
         Gui.TextDiskSize->SetText(str.str());
     }
-    if (GFailureRate != Gui.ScrollFailureRate->GetValue()) {
-        GFailureRate = Gui.ScrollFailureRate->GetValue();
-        GDoRestart = true;
+    if (Params.FailureRate != Gui.ScrollFailureRate->GetValue()) {
+        Params.FailureRate = Gui.ScrollFailureRate->GetValue();
+        changed = true;
         std::stringstream str;
-        str << "Failure Rate: " << GFailureRate << " disks/day";
+        str << "Failure Rate: " << Params.FailureRate << " disks/day";
         Gui.TextFailureRate->SetText(str.str());
     }
-    if (GSpareDisksPerDc != Gui.ScrollSpareDisks->GetValue()) {
-        GSpareDisksPerDc = Gui.ScrollSpareDisks->GetValue();
-        GDoRestart = true;
+    if (Params.SpareDisksPerDc != Gui.ScrollSpareDisks->GetValue()) {
+        Params.SpareDisksPerDc = Gui.ScrollSpareDisks->GetValue();
+        changed = true;
         std::stringstream str;
-        str << "Spare Disks per DC: " << GSpareDisksPerDc;
+        str << "Spare Disks per DC: " << Params.SpareDisksPerDc;
         Gui.TextSpareDisks->SetText(str.str());
     }
-    if (GWriteSpeed != Gui.ScrollWriteSpeed->GetValue()) {
-        GWriteSpeed = Gui.ScrollWriteSpeed->GetValue();
-        GDoRestart = true;
+    if (Params.WriteSpeed != Gui.ScrollWriteSpeed->GetValue()) {
+        Params.WriteSpeed = Gui.ScrollWriteSpeed->GetValue();
+        changed = true;
         std::stringstream str;
-        str << "Write Speed: " << GWriteSpeed << " MB/s";
+        str << "Write Speed: " << Params.WriteSpeed << " MB/s";
         Gui.TextWriteSpeed->SetText(str.str());
     }
 
-    if (GPDiskRecoveryTimeHours != Gui.ScrollRecoveryTime->GetValue()) {
-        GPDiskRecoveryTimeHours = Gui.ScrollRecoveryTime->GetValue();
-        GDoRestart = true;
+    if (Params.PDiskRecoveryTimeHours != Gui.ScrollRecoveryTime->GetValue()) {
+        Params.PDiskRecoveryTimeHours = Gui.ScrollRecoveryTime->GetValue();
+        changed = true;
         std::stringstream str;
-        str << "PDisk Recovery Time: " << GPDiskRecoveryTimeHours << " hours";
+        str << "PDisk Recovery Time: " << Params.PDiskRecoveryTimeHours << " hours";
         Gui.TextRecoveryTime->SetText(str.str());
     }
 
     // Обработка слайдера VDisks/PDisk
-    if (GVDisksPerPDisk != Gui.ScrollVDisksPerPDisk->GetValue()) {
-        GVDisksPerPDisk = Gui.ScrollVDisksPerPDisk->GetValue();
-        GDoRestart = true;
+    if (Params.VDisksPerPDisk != Gui.ScrollVDisksPerPDisk->GetValue()) {
+        Params.VDisksPerPDisk = Gui.ScrollVDisksPerPDisk->GetValue();
+        changed = true;
         std::stringstream str;
-        str << "VDisks per PDisk: " << GVDisksPerPDisk;
+        str << "VDisks per PDisk: " << Params.VDisksPerPDisk;
         Gui.TextVDisksPerPDisk->SetText(str.str());
     }
+
+    if (Params.ErasureScheme != static_cast<Ui32>(Gui.ScrollErasureScheme->GetValue())) {
+        Params.ErasureScheme = Gui.ScrollErasureScheme->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "Erasure Scheme: " << GetErasureScheme(Params.ErasureScheme).Name;
+        Gui.TextErasureScheme->SetText(str.str());
+    }
+
+    if (Params.NumDCs != static_cast<Ui32>(Gui.ScrollNumDCs->GetValue())) {
+        Params.NumDCs = Gui.ScrollNumDCs->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "DCs: " << Params.NumDCs;
+        Gui.TextNumDCs->SetText(str.str());
+    }
+
+    if (Params.HostOutagesPerYear != static_cast<Ui32>(Gui.ScrollHostOutages->GetValue())) {
+        Params.HostOutagesPerYear = Gui.ScrollHostOutages->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "Host Outages: " << Params.HostOutagesPerYear << " per year";
+        Gui.TextHostOutages->SetText(str.str());
+    }
+
+    if (Params.RackOutagesPerYear != static_cast<Ui32>(Gui.ScrollRackOutages->GetValue())) {
+        Params.RackOutagesPerYear = Gui.ScrollRackOutages->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "Rack Outages: " << Params.RackOutagesPerYear << " per year";
+        Gui.TextRackOutages->SetText(str.str());
+    }
+
+    if (Params.DcOutagesPerYear != static_cast<Ui32>(Gui.ScrollDcOutages->GetValue())) {
+        Params.DcOutagesPerYear = Gui.ScrollDcOutages->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "DC Outages: " << Params.DcOutagesPerYear << " per year";
+        Gui.TextDcOutages->SetText(str.str());
+    }
+
+    if (Params.DcReplicationSpeed != static_cast<Ui32>(Gui.ScrollDcReplicationSpeed->GetValue())) {
+        Params.DcReplicationSpeed = Gui.ScrollDcReplicationSpeed->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "DC Replication Network: ";
+        if (Params.DcReplicationSpeed > 0) {
+            str << Params.DcReplicationSpeed << " MB/s";
+        } else {
+            str << "unlimited";
+        }
+        Gui.TextDcReplicationSpeed->SetText(str.str());
+    }
+
+    if (Params.HazardModel != static_cast<Ui32>(Gui.ScrollHazardModel->GetValue())) {
+        Params.HazardModel = Gui.ScrollHazardModel->GetValue();
+        if (Params.HazardModel == kHazardPiecewise && Params.PiecewiseHazard.empty()) {
+            LoadPiecewiseHazard(GHazardTableFileName, Params.PiecewiseHazard);
+        }
+        if (Params.HazardModel == kHazardReplay && !FindFailureLog(Params.FailureLogFingerprint)) {
+            if (const auto log = OpenFailureLog(GFailureLogFileName)) {
+                Params.FailureLogFingerprint = log->GetFingerprint();
+            }
+        }
+        changed = true;
+        std::stringstream str;
+        str << "Failure Model: " << GetHazardModelName(Params.HazardModel);
+        Gui.TextHazardModel->SetText(str.str());
+    }
+
+    if (Params.FleetAgeDays != static_cast<Ui32>(Gui.ScrollFleetAge->GetValue())) {
+        Params.FleetAgeDays = Gui.ScrollFleetAge->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "Fleet Age: " << Params.FleetAgeDays << " days";
+        Gui.TextFleetAge->SetText(str.str());
+    }
+
+    if (Params.NewBatchPercent != static_cast<Ui32>(Gui.ScrollNewBatch->GetValue())) {
+        Params.NewBatchPercent = Gui.ScrollNewBatch->GetValue();
+        changed = true;
+        std::stringstream str;
+        str << "New Batch: " << Params.NewBatchPercent << "%";
+        Gui.TextNewBatch->SetText(str.str());
+    }
+    return changed;
 }
 
 void SimulationController::Draw() {
     LOG_DEBUG("Draw start");
     Clear();
 
-    std::map<Si64, Si64> probabilityByDay;
-    for (Si32 day = 0; day < 30; ++day) {
-        if (TotalSimsByDay.count(day) && TotalSimsByDay[day] > 0) {
-            double probability = static_cast<double>(DataLossByDay[day]) /
-                               static_cast<double>(TotalSimsByDay[day]);
-            probability = std::min(probability, 1.0);
-            probabilityByDay[day] = static_cast<Si64>(probability * 1000000.0);
-        } else {
-            probabilityByDay[day] = 0;
-        }
+    // Геометрия графика пересобирается только при публикации нового снимка.
+    const TEngineSnapshot& snapshot = SimEngine.ReadSnapshot();
+    if (!Plot.IsUpToDate(snapshot.Version)) {
+        BuildPlot(Plot, snapshot.Stats, snapshot.Version, snapshot.Params.HorizonHours / 24.0,
+                  HasAnalytic ? &Analytic : nullptr, HasWhatIf ? &WhatIf : nullptr);
     }
 
-    DrawSimulation(probabilityByDay);
-    UpdateGuiText(Gui);
+    DrawSimulation(Plot);
+    UpdateGuiText(Gui, snapshot.Stats, HasWhatIf ? &WhatIf : nullptr);
     Gui.Gui->Draw(Vec2Si32(0, 0));
     ShowFrame();
     LOG_DEBUG("Draw end");
@@ -1,6 +1,13 @@
 #pragma once
 #include <arctic/engine/easy.h>
 #include "model/simulation.h"
+#include "model/simulation_stats.h"
+#include "model/checkpoint.h"
+#include "model/markov_estimator.h"
+#include "model/rate_reweighting.h"
+#include "model/result_cache.h"
+#include "model/simulation_runner.h"
+#include "controller/simulation_engine.h"
 #include "view/gui_elements.h"
 #include <map>
 #include <string>
@@ -10,6 +17,7 @@
 #include <vector>
 #include <numeric>
 #include <random>
+#include <chrono>
 
 namespace arctic {
 
@@ -17,11 +25,6 @@ extern const Ui32 kScreenWidth;
 extern const Ui32 kScreenHeight;
 
 
-struct SimulationResult {
-    int lossDay = -1;         
-    int daysSimulated = 0;    
-};
-
 class SimulationController : public Engine {
 public:
     void Initialize();
@@ -30,16 +33,30 @@ public:
     void Draw();
 
 private:
-    void RunSimulation();
     void UpdateStatistics();
-    void HandleGuiEvents();
-    SimulationResult RunSingleSimulation();
+    // Переносит положения слайдеров в Params, возвращает true, если что-то изменилось.
+    bool HandleGuiEvents();
+    void ResumeFromCheckpoint(const TSimulationConfig& config, TEngineSnapshot& initial);
+    void SaveCheckpointIfDue();
+    // Пересчитывает аналитическую кривую для текущих Params, пока Monte Carlo её уточняет.
+    void UpdateAnalyticEstimate();
+    // Если Params отличаются от параметров движка только интенсивностью отказов,
+    // пересчитывает для неё накопленные прогоны. false - пересчёт невозможен или
+    // его ESS ниже GReweightMinEss, и нужны новые прогоны.
+    bool UpdateWhatIf();
 
-    Simulation Sim;
     GuiElements Gui;
-    std::map<Si32, Si32> DataLossByDay;
-    std::map<Si32, Si32> TotalSimsByDay;
-    bool DoRestart = false;
+    // Параметры, выставленные в интерфейсе; глобальные меняет только SimEngine.
+    TSimulationParams Params;
+    // Последние параметры, отправленные в SimEngine.
+    TSimulationParams EngineParams;
+    TSimulationEngine SimEngine;
+    TPlotCache Plot;
+    TMarkovEstimate Analytic;
+    bool HasAnalytic = false;
+    TReweightedLoss WhatIf;
+    bool HasWhatIf = false;
+    std::chrono::steady_clock::time_point LastCheckpointTime;
 };
 
 } 
\ No newline at end of file
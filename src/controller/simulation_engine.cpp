@@ -0,0 +1,219 @@
+#include "simulation_engine.h"
+#include "model/simulation_runner.h"
+#include "model/result_cache.h"
+#include "../utils/logger.h"
+
+namespace arctic {
+
+namespace {
+
+// Чаще кадра публиковать бессмысленно.
+const auto kPublishInterval = std::chrono::milliseconds(15);
+
+} // namespace
+
+TCheckpoint TEngineSnapshot::ToCheckpoint() const {
+    TCheckpoint checkpoint;
+    checkpoint.Params = Params;
+    checkpoint.ControlCalibrationRuns = ControlCalibrationRuns;
+    checkpoint.StratifiedSampling = StratifiedSampling;
+    checkpoint.BaseSeed = BaseSeed;
+    checkpoint.NextSimIndex = NextSimIndex;
+    checkpoint.Stats = Stats;
+    return checkpoint;
+}
+
+TSimulationEngine::~TSimulationEngine() {
+    Stop();
+}
+
+bool TSimulationEngine::Start(Ui32 workers, const TEngineSnapshot& initial) {
+    Stop();
+    TSimulationConfig config;
+    if (!TSimulationConfig::FromParams(initial.Params, config)) {
+        LOG_ERROR("Simulation engine is not started: the parameters can not be simulated");
+        return false;
+    }
+    Config = std::make_shared<const TSimulationConfig>(std::move(config));
+    {
+        std::lock_guard<std::mutex> lock(ResultsMutex);
+        State = initial;
+        State.ControlCalibrationRuns = Config->ControlCalibrationRuns;
+        State.StratifiedSampling = Config->StratifiedSampling;
+        OutOfOrder.clear();
+        Generation = initial.Generation;
+        BaseSeed = initial.BaseSeed;
+        NextToClaim = initial.NextSimIndex;
+        PublishLocked();
+    }
+    Stopping = false;
+    Cancel = false;
+    Stopped = false;
+
+    workers = std::max<Ui32>(1, workers);
+    std::vector<TCpuSlot> cpus;
+    if (GPinWorkers) {
+        cpus = BuildWorkerCpuOrder(GPinWorkersUseSmt);
+        if (cpus.empty()) {
+            LOG_WARNING("Worker pinning requested, but the CPU list is unavailable; workers are not pinned");
+        } else if (workers > cpus.size()) {
+            // Два прогона на одном CPU только мешают друг другу.
+            workers = static_cast<Ui32>(cpus.size());
+        }
+    }
+
+    Control = std::thread(&TSimulationEngine::ControlLoop, this);
+    for (Ui32 i = 0; i < workers; ++i) {
+        std::optional<TCpuSlot> cpu;
+        if (!cpus.empty()) {
+            cpu = cpus[i];
+        }
+        Workers.emplace_back(&TSimulationEngine::WorkerLoop, this, cpu);
+    }
+    LOG("Simulation engine started with " + std::to_string(Workers.size()) + " workers" +
+        (cpus.empty() ? "" : ", pinned to CPUs"));
+    return true;
+}
+
+void TSimulationEngine::Stop() {
+    if (Stopped.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(CommandMutex);
+        Stopping = true;
+    }
+    Cancel = true;
+    CommandCv.notify_all();
+    for (std::thread& worker : Workers) {
+        worker.join();
+    }
+    Workers.clear();
+    Control.join();
+    TCheckpoint last;
+    {
+        std::lock_guard<std::mutex> lock(ResultsMutex);
+        last = TakeCheckpointLocked();
+    }
+    TResultCache::Instance().Put(last);
+}
+
+bool TSimulationEngine::PostParams(const TSimulationParams& params, Ui64 baseSeed) {
+    TSimulationConfig config;
+    if (!TSimulationConfig::FromParams(params, config)) {
+        LOG_ERROR("Simulation engine keeps the previous parameters: the new ones can not be simulated");
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(CommandMutex);
+        // Промежуточные положения слайдера не нужны, достаточно последних параметров.
+        PendingConfig = std::make_shared<const TSimulationConfig>(std::move(config));
+        PendingBaseSeed = baseSeed;
+    }
+    CommandCv.notify_one();
+    return true;
+}
+
+const TEngineSnapshot& TSimulationEngine::ReadSnapshot() {
+    Snapshots.Update();
+    return Snapshots.GetReadBuffer();
+}
+
+void TSimulationEngine::ControlLoop() {
+    while (true) {
+        std::shared_ptr<const TSimulationConfig> config;
+        Ui64 baseSeed = 0;
+        {
+            std::unique_lock<std::mutex> lock(CommandMutex);
+            CommandCv.wait(lock, [this] { return Stopping || PendingConfig; });
+            if (Stopping) {
+                return;
+            }
+            config = std::move(PendingConfig);
+            baseSeed = PendingBaseSeed;
+        }
+
+        Cancel = true;
+        {
+            // Config читается прогонами, поэтому меняется только без них.
+            std::unique_lock<std::shared_mutex> runLock(RunMutex);
+            std::lock_guard<std::mutex> lock(ResultsMutex);
+            // Оценка старых параметров уходит в кэш, а для новых продолжается закэшированная, если есть.
+            TResultCache& cache = TResultCache::Instance();
+            cache.Put(TakeCheckpointLocked());
+            TCheckpoint cached;
+            if (!cache.Get(*config, cached)) {
+                cached = TCheckpoint::ForConfig(*config);
+                cached.BaseSeed = baseSeed;
+            }
+            Config = std::move(config);
+            Generation++;
+            BaseSeed = cached.BaseSeed;
+            NextToClaim = cached.NextSimIndex;
+            OutOfOrder.clear();
+            State.Params = Config->Params;
+            State.ControlCalibrationRuns = Config->ControlCalibrationRuns;
+            State.StratifiedSampling = Config->StratifiedSampling;
+            State.BaseSeed = cached.BaseSeed;
+            State.Generation = Generation;
+            State.NextSimIndex = cached.NextSimIndex;
+            State.Stats = std::move(cached.Stats);
+            PublishLocked();
+            Cancel = false;
+        }
+        LOG_DEBUG("Simulation engine restarted, generation " + std::to_string(Generation));
+    }
+}
+
+void TSimulationEngine::WorkerLoop(std::optional<TCpuSlot> cpu) {
+    // До первого прогона: модель потока создаётся в нём же и по first-touch
+    // попадает в память узла, на котором поток будет работать.
+    if (cpu) {
+        PinCurrentThread(*cpu);
+    }
+    while (!Stopped) {
+        if (Cancel) {
+            // Уступаем эксклюзивную блокировку смене параметров.
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        std::shared_lock<std::shared_mutex> runLock(RunMutex);
+        const Ui64 generation = Generation;
+        const Ui64 simIndex = NextToClaim.fetch_add(1);
+        const SimulationResult result = RunSingleSimulation(*Config, BaseSeed, simIndex, &Cancel);
+        if (Cancel) {
+            continue;
+        }
+        AddResult(generation, simIndex, result);
+    }
+}
+
+void TSimulationEngine::AddResult(Ui64 generation, Ui64 simIndex, const SimulationResult& result) {
+    std::lock_guard<std::mutex> lock(ResultsMutex);
+    if (generation != State.Generation) {
+        return;
+    }
+    OutOfOrder[simIndex] = result;
+    // Статистика складывается строго по порядку индексов и не зависит от расписания потоков.
+    for (auto it = OutOfOrder.begin(); it != OutOfOrder.end() && it->first == State.NextSimIndex;
+         it = OutOfOrder.erase(it)) {
+        State.Stats.AddResult(it->second);
+        State.NextSimIndex++;
+    }
+    if (std::chrono::steady_clock::now() - LastPublish >= kPublishInterval) {
+        PublishLocked();
+    }
+}
+
+TCheckpoint TSimulationEngine::TakeCheckpointLocked() const {
+    return State.ToCheckpoint();
+}
+
+void TSimulationEngine::PublishLocked() {
+    State.Version++;
+    Snapshots.GetWriteBuffer() = State;
+    Snapshots.Publish();
+    LastPublish = std::chrono::steady_clock::now();
+}
+
+} // namespace arctic
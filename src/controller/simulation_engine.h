@@ -0,0 +1,97 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "model/checkpoint.h"
+#include "model/simulation_params.h"
+#include "model/simulation_stats.h"
+#include "../utils/thread_affinity.h"
+#include "../utils/triple_buffer.h"
+
+namespace arctic {
+
+// Состояние оценки, которое видит интерфейс.
+struct TEngineSnapshot {
+    TSimulationParams Params;
+    // Настройки оценки, с которыми набрана Stats (см. TCheckpoint).
+    Ui32 ControlCalibrationRuns = 0;
+    bool StratifiedSampling = false;
+    Ui64 BaseSeed = 0;
+    // Растёт при каждой смене параметров.
+    Ui64 Generation = 0;
+    // Растёт при каждой публикации, по нему интерфейс понимает, что пора перерисовать график.
+    Ui64 Version = 0;
+    // В Stats учтены ровно прогоны с индексами [0, NextSimIndex), поэтому снимок можно сохранить в чекпоинт.
+    Ui64 NextSimIndex = 0;
+    TSimulationStats Stats;
+
+    TCheckpoint ToCheckpoint() const;
+};
+
+// Гоняет прогоны на своих потоках независимо от кадров интерфейса. Интерфейс
+// отправляет новые параметры через очередь команд и читает последний
+// опубликованный снимок статистики без ожидания.
+class TSimulationEngine {
+public:
+    ~TSimulationEngine();
+
+    // false, если параметры initial нельзя моделировать (см. TSimulationConfig::FromParams).
+    bool Start(Ui32 workers, const TEngineSnapshot& initial);
+    void Stop();
+
+    // Оценка переключается на новые параметры: продолжается их запись из TResultCache
+    // или начинается заново с baseSeed. Текущая оценка кладётся в кэш.
+    // Можно вызывать из потока интерфейса: снимок TSimulationConfig собирается здесь же,
+    // а глобальные параметры движок не читает и не меняет. Если параметры нельзя
+    // моделировать, возвращает false и продолжает прежнюю оценку.
+    bool PostParams(const TSimulationParams& params, Ui64 baseSeed);
+
+    // Только для одного потока-читателя.
+    const TEngineSnapshot& ReadSnapshot();
+
+private:
+    void ControlLoop();
+    // cpu задан, если воркеры закрепляются за CPU (GPinWorkers).
+    void WorkerLoop(std::optional<TCpuSlot> cpu);
+    void AddResult(Ui64 generation, Ui64 simIndex, const SimulationResult& result);
+    void PublishLocked();
+    TCheckpoint TakeCheckpointLocked() const;
+
+    std::vector<std::thread> Workers;
+    std::thread Control;
+
+    std::mutex CommandMutex;
+    std::condition_variable CommandCv;
+    std::shared_ptr<const TSimulationConfig> PendingConfig;
+    Ui64 PendingBaseSeed = 0;
+    bool Stopping = false;
+
+    // Прогоны идут под разделяемой блокировкой, смена параметров берёт её
+    // эксклюзивно, предварительно попросив прогоны прерваться через Cancel.
+    // Так номер прогона, поколение и Config, с которым он считается, согласованы.
+    std::shared_mutex RunMutex;
+    std::shared_ptr<const TSimulationConfig> Config;
+    std::atomic<bool> Cancel{false};
+    std::atomic<bool> Stopped{true};
+    std::atomic<Ui64> NextToClaim{0};
+    Ui64 Generation = 0;
+    Ui64 BaseSeed = 0;
+
+    // Результаты приходят не по порядку и копятся здесь, пока не продолжат
+    // непрерывный префикс индексов.
+    std::mutex ResultsMutex;
+    TEngineSnapshot State;
+    std::map<Ui64, SimulationResult> OutOfOrder;
+    std::chrono::steady_clock::time_point LastPublish;
+    TTripleBuffer<TEngineSnapshot> Snapshots;
+};
+
+} // namespace arctic
@@ -0,0 +1,139 @@
+#include "checkpoint.h"
+#include "varint.h"
+#include "../utils/logger.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+namespace arctic {
+
+namespace {
+
+const char kCheckpointMagic[4] = {'D', 'F', 'C', 'K'};
+const Ui8 kCheckpointVersion = 15;
+
+} // namespace
+
+TCheckpoint TCheckpoint::ForConfig(const TSimulationConfig& config) {
+    TCheckpoint checkpoint;
+    checkpoint.Params = config.Params;
+    checkpoint.ControlCalibrationRuns = config.ControlCalibrationRuns;
+    checkpoint.StratifiedSampling = config.StratifiedSampling;
+    return checkpoint;
+}
+
+bool TCheckpoint::IsSameEstimate(const TCheckpoint& other) const {
+    return Params == other.Params && ControlCalibrationRuns == other.ControlCalibrationRuns &&
+           StratifiedSampling == other.StratifiedSampling;
+}
+
+bool SaveCheckpoint(const std::string& path, const TCheckpoint& checkpoint) {
+    std::vector<Ui8> payload;
+    checkpoint.Params.Serialize(payload);
+    WriteVarint(payload, checkpoint.ControlCalibrationRuns);
+    WriteVarint(payload, checkpoint.StratifiedSampling ? 1 : 0);
+    WriteVarint(payload, checkpoint.BaseSeed);
+    WriteVarint(payload, checkpoint.NextSimIndex);
+    checkpoint.Stats.Serialize(payload);
+
+    const Ui64 checksum = Fnv1a(payload.data(), payload.size());
+
+    const std::string tmpPath = path + ".tmp";
+    FILE* file = std::fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        LOG_ERROR("Could not open checkpoint file for writing: " + tmpPath);
+        return false;
+    }
+    bool ok = std::fwrite(kCheckpointMagic, sizeof(kCheckpointMagic), 1, file) == 1 &&
+              std::fwrite(&kCheckpointVersion, 1, 1, file) == 1 &&
+              std::fwrite(payload.data(), payload.size(), 1, file) == 1 &&
+              std::fwrite(&checksum, sizeof(checksum), 1, file) == 1;
+    ok = ok && std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Could not write checkpoint: " + path);
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool LoadCheckpoint(const std::string& path, TCheckpoint& checkpoint) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<Ui8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const size_t headerSize = sizeof(kCheckpointMagic) + 1;
+    if (data.size() < headerSize + sizeof(Ui64) ||
+        std::memcmp(data.data(), kCheckpointMagic, sizeof(kCheckpointMagic)) != 0 ||
+        data[sizeof(kCheckpointMagic)] != kCheckpointVersion) {
+        LOG_ERROR("Unsupported checkpoint format: " + path);
+        return false;
+    }
+
+    const Ui8* pos = data.data() + headerSize;
+    const Ui8* end = data.data() + data.size() - sizeof(Ui64);
+    Ui64 checksum = 0;
+    std::memcpy(&checksum, end, sizeof(checksum));
+    if (checksum != Fnv1a(pos, end - pos)) {
+        LOG_ERROR("Checkpoint checksum mismatch: " + path);
+        return false;
+    }
+
+    TCheckpoint result;
+    Ui64 calibrationRuns = 0;
+    Ui64 stratified = 0;
+    if (!result.Params.Deserialize(pos, end) ||
+        !ReadVarint(pos, end, calibrationRuns) ||
+        !ReadVarint(pos, end, stratified) || stratified > 1 ||
+        !ReadVarint(pos, end, result.BaseSeed) ||
+        !ReadVarint(pos, end, result.NextSimIndex)) {
+        LOG_ERROR("Corrupted checkpoint header: " + path);
+        return false;
+    }
+    if (!result.Stats.Deserialize(pos, end)) {
+        LOG_ERROR("Corrupted checkpoint statistics: " + path);
+        return false;
+    }
+    result.ControlCalibrationRuns = static_cast<Ui32>(calibrationRuns);
+    result.StratifiedSampling = stratified != 0;
+    checkpoint = std::move(result);
+    return true;
+}
+
+bool MergeCheckpoints(const std::vector<std::string>& paths, TCheckpoint& merged) {
+    bool first = true;
+    for (const std::string& path : paths) {
+        TCheckpoint part;
+        if (!LoadCheckpoint(path, part)) {
+            LOG_ERROR("MergeCheckpoints: could not load " + path);
+            return false;
+        }
+        if (first) {
+            merged = std::move(part);
+            first = false;
+            continue;
+        }
+        if (!(part.Params == merged.Params)) {
+            LOG_ERROR("MergeCheckpoints: parameters of " + path + " do not match.");
+            return false;
+        }
+        if (!part.IsSameEstimate(merged)) {
+            // Стратифицированная и обычная статистика или разные калибровки не складываются.
+            LOG_ERROR("MergeCheckpoints: estimation settings of " + path + " do not match.");
+            return false;
+        }
+        if (part.BaseSeed == merged.BaseSeed) {
+            // Одинаковый поток seed'ов даёт одни и те же прогоны, их нельзя считать независимыми.
+            LOG_WARNING("MergeCheckpoints: " + path + " uses the same base seed, runs may be duplicated.");
+        }
+        merged.Stats.Merge(part.Stats);
+        merged.NextSimIndex = std::max(merged.NextSimIndex, part.NextSimIndex);
+    }
+    return !first;
+}
+
+} // namespace arctic
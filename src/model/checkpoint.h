@@ -0,0 +1,34 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <string>
+#include <vector>
+#include "simulation_params.h"
+#include "simulation_stats.h"
+
+namespace arctic {
+
+// Состояние долгой оценки: параметры, накопленная статистика и позиция в потоке
+// seed'ов (прогон с индексом i всегда получает MakeRunSeed(BaseSeed, i)).
+struct TCheckpoint {
+    TSimulationParams Params;
+    // Настройки оценки из TSimulationConfig: от них зависит, что накоплено в Stats.
+    Ui32 ControlCalibrationRuns = 0;
+    bool StratifiedSampling = false;
+    Ui64 BaseSeed = 0;
+    Ui64 NextSimIndex = 0;
+    TSimulationStats Stats;
+
+    // Пустая оценка с параметрами и настройками config.
+    static TCheckpoint ForConfig(const TSimulationConfig& config);
+    // Статистику можно продолжать или складывать, только если совпадают параметры и настройки.
+    bool IsSameEstimate(const TCheckpoint& other) const;
+};
+
+// Пишет во временный файл и атомарно переименовывает его поверх path.
+bool SaveCheckpoint(const std::string& path, const TCheckpoint& checkpoint);
+bool LoadCheckpoint(const std::string& path, TCheckpoint& checkpoint);
+
+// Складывает частичные оценки нескольких запусков или машин с одинаковыми параметрами.
+bool MergeCheckpoints(const std::vector<std::string>& paths, TCheckpoint& merged);
+
+} // namespace arctic
@@ -0,0 +1,25 @@
+#include "erasure_scheme.h"
+#include "../utils/logger.h"
+#include <string>
+
+namespace arctic {
+
+namespace {
+
+constexpr std::array<TErasureSchemeInfo, kErasureSchemeCount> kErasureSchemes = {
+    MakeErasureSchemeInfo<TMirror3Dc>(),
+    MakeErasureSchemeInfo<TBlock42>(),
+    MakeErasureSchemeInfo<TMirror3Of4>(),
+};
+
+} // namespace
+
+const TErasureSchemeInfo& GetErasureScheme(Ui32 scheme) {
+    if (scheme >= kErasureSchemeCount) {
+        LOG_ERROR("Unknown erasure scheme " + std::to_string(scheme) + ", using mirror-3-dc");
+        return kErasureSchemes[kMirror3DcScheme];
+    }
+    return kErasureSchemes[scheme];
+}
+
+} // namespace arctic
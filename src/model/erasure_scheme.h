@@ -0,0 +1,93 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <algorithm>
+#include <array>
+
+namespace arctic {
+
+// Геометрия группы и предикат потери данных по числу отказавших VDisk'ов в
+// каждом DC группы. Предикаты constexpr и без циклов, поэтому после
+// инстанцирования CheckSchemeDataLoss<TScheme> остаётся линейный код.
+
+struct TMirror3Dc {
+    static constexpr const char* Name = "mirror-3-dc";
+    static constexpr Ui32 NumDCs = 3;
+    static constexpr Ui32 VDisksPerDC = 3;
+
+    // Потеря, если задеты все три DC или один DC потерян целиком и во втором ещё два отказа.
+    static constexpr bool IsDataLoss(const Ui8* failed) {
+        const bool allDCs = (failed[0] > 0) & (failed[1] > 0) & (failed[2] > 0);
+        const bool dc0Lost = (failed[0] >= 3) & ((failed[1] >= 2) | (failed[2] >= 2));
+        const bool dc1Lost = (failed[1] >= 3) & ((failed[0] >= 2) | (failed[2] >= 2));
+        const bool dc2Lost = (failed[2] >= 3) & ((failed[0] >= 2) | (failed[1] >= 2));
+        return allDCs | dc0Lost | dc1Lost | dc2Lost;
+    }
+};
+
+// 4 части данных + 2 чётности и 2 handoff-диска в одном DC, переживает 2 отказа.
+struct TBlock42 {
+    static constexpr const char* Name = "block-4-2";
+    static constexpr Ui32 NumDCs = 1;
+    static constexpr Ui32 VDisksPerDC = 8;
+
+    static constexpr bool IsDataLoss(const Ui8* failed) {
+        return failed[0] > 2;
+    }
+};
+
+// Три копии на четырёх доменах отказа по два VDisk'а; домены - DC группы, так
+// что схеме нужно не меньше четырёх DC. Копии блоба лежат в трёх доменах из
+// четырёх, и он может потеряться, только если отказы задели три домена: два
+// потерянных целиком домена данные не теряют.
+struct TMirror3Of4 {
+    static constexpr const char* Name = "mirror-3of4";
+    static constexpr Ui32 NumDCs = 4;
+    static constexpr Ui32 VDisksPerDC = 2;
+
+    static constexpr bool IsDataLoss(const Ui8* failed) {
+        return (failed[0] > 0) + (failed[1] > 0) + (failed[2] > 0) + (failed[3] > 0) >= 3;
+    }
+};
+
+using TLossPredicate = bool (*)(const Ui8* failedPerDC);
+
+template <typename TScheme>
+bool CheckSchemeDataLoss(const Ui8* failedPerDC) {
+    return TScheme::IsDataLoss(failedPerDC);
+}
+
+struct TErasureSchemeInfo {
+    const char* Name;
+    Ui32 NumDCs;
+    Ui32 VDisksPerDC;
+    TLossPredicate IsDataLoss;
+
+    Ui32 GetGroupSize() const { return NumDCs * VDisksPerDC; }
+};
+
+template <typename TScheme>
+constexpr TErasureSchemeInfo MakeErasureSchemeInfo() {
+    return {TScheme::Name, TScheme::NumDCs, TScheme::VDisksPerDC, &CheckSchemeDataLoss<TScheme>};
+}
+
+enum EErasureScheme : Ui32 {
+    kMirror3DcScheme = 0,
+    kBlock42Scheme,
+    kMirror3Of4Scheme,
+    kErasureSchemeCount
+};
+
+template <typename... TSchemes>
+constexpr Ui32 MaxSchemeDCs() { return std::max({TSchemes::NumDCs...}); }
+
+template <typename... TSchemes>
+constexpr Ui32 MaxSchemeGroupSize() { return std::max({(TSchemes::NumDCs * TSchemes::VDisksPerDC)...}); }
+
+constexpr Ui32 kMaxGroupDCs = MaxSchemeDCs<TMirror3Dc, TBlock42, TMirror3Of4>();
+constexpr Ui32 kMaxGroupVDisks = MaxSchemeGroupSize<TMirror3Dc, TBlock42, TMirror3Of4>();
+
+// Реестр схем для выбора во время выполнения. Для неизвестного номера пишет
+// ошибку в лог и возвращает mirror-3-dc.
+const TErasureSchemeInfo& GetErasureScheme(Ui32 scheme);
+
+} // namespace arctic
@@ -0,0 +1,209 @@
+#include "event_trace.h"
+#include "simulation.h"
+#include "simulation_params.h"
+#include "../utils/logger.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace arctic {
+
+namespace {
+
+const char kTraceMagic[4] = {'D', 'F', 'T', 'R'};
+const Ui8 kTraceVersion = 9;
+
+} // namespace
+
+TTraceRecorder& TTraceRecorder::ThreadLocal() {
+    thread_local static TTraceRecorder recorder;
+    return recorder;
+}
+
+void TTraceRecorder::BeginRun(Ui64 seed, const TSimulationParams& params) {
+    Buffer.clear();
+    LastHour = 0;
+
+    WriteVarint(Buffer, seed);
+    params.Serialize(Buffer);
+}
+
+void TTraceRecorder::Record(ETraceEvent type, double time, Ui32 id, Ui32 extra) {
+    const Ui32 hour = static_cast<Ui32>(time);
+    Buffer.push_back(static_cast<Ui8>(type));
+    WriteVarint(Buffer, hour - LastHour);
+    WriteVarint(Buffer, id);
+    if (TraceEventHasExtra(type)) {
+        WriteVarint(Buffer, extra);
+    }
+    LastHour = hour;
+}
+
+void TTraceRecorder::EndRun(bool keep) {
+    if (keep && !Buffer.empty()) {
+        TTraceWriter::Instance().WriteRun(Buffer);
+    }
+    Buffer.clear();
+}
+
+TTraceWriter& TTraceWriter::Instance() {
+    static TTraceWriter writer;
+    return writer;
+}
+
+bool TTraceWriter::Open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (File.is_open()) {
+        File.close();
+    }
+    File.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!File.is_open()) {
+        LOG_ERROR("Could not open trace file for writing: " + path);
+        return false;
+    }
+    File.write(kTraceMagic, sizeof(kTraceMagic));
+    File.put(static_cast<char>(kTraceVersion));
+    return true;
+}
+
+void TTraceWriter::Close() {
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (File.is_open()) {
+        File.close();
+    }
+}
+
+void TTraceWriter::WriteRun(const std::vector<Ui8>& run) {
+    std::vector<Ui8> length;
+    WriteVarint(length, run.size());
+
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (!File.is_open()) {
+        return;
+    }
+    File.write(reinterpret_cast<const char*>(length.data()), length.size());
+    File.write(reinterpret_cast<const char*>(run.data()), run.size());
+    File.flush();
+}
+
+bool TTraceEventCursor::Next(TTraceEvent& event) {
+    if (Pos >= End) {
+        return false;
+    }
+    event.Type = static_cast<ETraceEvent>(*Pos++);
+    Ui64 delta = 0;
+    Ui64 id = 0;
+    Ui64 extra = 0;
+    if (!ReadVarint(Pos, End, delta) || !ReadVarint(Pos, End, id)) {
+        Pos = End;
+        return false;
+    }
+    if (TraceEventHasExtra(event.Type) && !ReadVarint(Pos, End, extra)) {
+        Pos = End;
+        return false;
+    }
+    Hour += static_cast<Ui32>(delta);
+    event.Hour = Hour;
+    event.Id = static_cast<Ui32>(id);
+    event.Extra = static_cast<Ui32>(extra);
+    return true;
+}
+
+TTraceReader::~TTraceReader() {
+    Close();
+}
+
+bool TTraceReader::Open(const std::string& path) {
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Could not open trace file: " + path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(kTraceMagic) + 1)) {
+        LOG_ERROR("Trace file is empty or unreadable: " + path);
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("Could not mmap trace file: " + path);
+        return false;
+    }
+    Data = static_cast<const Ui8*>(mapped);
+    Size = st.st_size;
+
+    if (std::memcmp(Data, kTraceMagic, sizeof(kTraceMagic)) != 0 || Data[sizeof(kTraceMagic)] != kTraceVersion) {
+        LOG_ERROR("Unsupported trace file format: " + path);
+        Close();
+        return false;
+    }
+
+    const Ui8* pos = Data + sizeof(kTraceMagic) + 1;
+    const Ui8* end = Data + Size;
+    while (pos < end) {
+        Ui64 length = 0;
+        if (!ReadVarint(pos, end, length) || length > static_cast<Ui64>(end - pos)) {
+            LOG_WARNING("Truncated run record in trace file " + path + " after " + std::to_string(Runs.size()) + " runs.");
+            break;
+        }
+        const Ui8* runEnd = pos + length;
+        TTraceRun run;
+        if (!ReadVarint(pos, runEnd, run.Seed) || !run.Params.Deserialize(pos, runEnd)) {
+            LOG_WARNING("Corrupted run header in trace file " + path);
+            break;
+        }
+        run.Events = pos;
+        run.EventsEnd = runEnd;
+        Runs.push_back(run);
+        pos = runEnd;
+    }
+    return true;
+}
+
+void TTraceReader::Close() {
+    if (Data) {
+        munmap(const_cast<Ui8*>(Data), Size);
+    }
+    Data = nullptr;
+    Size = 0;
+    Runs.clear();
+}
+
+bool TTraceReader::Replay(size_t runIndex, Ui32 hours, Simulation& sim) const {
+    if (runIndex >= Runs.size()) {
+        LOG_ERROR("Replay: run index " + std::to_string(runIndex) + " is out of range.");
+        return false;
+    }
+    const TTraceRun& run = Runs[runIndex];
+    TSimulationConfig config;
+    if (!TSimulationConfig::FromParams(run.Params, config)) {
+        LOG_ERROR("Replay: run " + std::to_string(runIndex) + " needs a failure log that is not loaded.");
+        return false;
+    }
+    sim.Reset(config);
+
+    // Случайность в модели только в выборе отказов и аварий доменов, остальное детерминировано.
+    TTraceEventCursor cursor(run);
+    TTraceEvent event;
+    bool hasEvent = cursor.Next(event);
+    for (Ui32 hour = 0; hour < hours; ++hour) {
+        while (hasEvent && event.Hour <= hour) {
+            if (event.Type == ETraceEvent::Failure && event.Hour == hour) {
+                sim.FailPDisk(TPDiskId::FromValue(event.Id));
+            } else if (event.Type == ETraceEvent::OutageStart && event.Hour == hour) {
+                sim.StartOutage(OutageLevelFromExtra(event.Extra), event.Id, OutageHoursFromExtra(event.Extra));
+            }
+            hasEvent = cursor.Next(event);
+        }
+        sim.AdvanceHour();
+    }
+    return true;
+}
+
+} // namespace arctic
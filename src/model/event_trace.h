@@ -0,0 +1,109 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include "simulation_params.h"
+#include "varint.h"
+
+namespace arctic {
+
+class Simulation;
+
+// Бинарный трейс прогонов: заголовок файла, затем записи прогонов
+// [varint длина][varint seed][параметры][события...].
+// Событие: [тип][varint дельта часа][varint id][varint extra для ReplicationStart и OutageStart].
+enum class ETraceEvent : Ui8 {
+    Failure = 1,
+    ReplicationStart = 2,
+    ReplicationComplete = 3,
+    Recovery = 4,
+    DataLoss = 5,
+    // id - номер домена, extra - уровень домена и длительность в часах (MakeOutageExtra).
+    OutageStart = 6
+};
+
+inline bool TraceEventHasExtra(ETraceEvent type) {
+    return type == ETraceEvent::ReplicationStart || type == ETraceEvent::OutageStart;
+}
+
+struct TTraceEvent {
+    ETraceEvent Type = ETraceEvent::Failure;
+    Ui32 Hour = 0;
+    Ui32 Id = 0;
+    Ui32 Extra = 0;
+};
+
+// Пишет в память события одного прогона. У каждого потока свой экземпляр,
+// в общий файл уходят только прогоны, переданные в EndRun с keep = true.
+class TTraceRecorder {
+public:
+    static TTraceRecorder& ThreadLocal();
+
+    // params - параметры, с которыми идёт прогон, их и повторит Replay.
+    void BeginRun(Ui64 seed, const TSimulationParams& params);
+    void Record(ETraceEvent type, double time, Ui32 id, Ui32 extra = 0);
+    void EndRun(bool keep);
+    const std::vector<Ui8>& GetBuffer() const { return Buffer; }
+
+private:
+    std::vector<Ui8> Buffer;
+    Ui32 LastHour = 0;
+};
+
+class TTraceWriter {
+public:
+    static TTraceWriter& Instance();
+
+    bool Open(const std::string& path);
+    void Close();
+    void WriteRun(const std::vector<Ui8>& run);
+
+private:
+    std::mutex Mutex;
+    std::ofstream File;
+};
+
+struct TTraceRun {
+    Ui64 Seed = 0;
+    TSimulationParams Params;
+    const Ui8* Events = nullptr;
+    const Ui8* EventsEnd = nullptr;
+};
+
+class TTraceEventCursor {
+public:
+    TTraceEventCursor(const TTraceRun& run) : Pos(run.Events), End(run.EventsEnd) {}
+    bool Next(TTraceEvent& event);
+
+private:
+    const Ui8* Pos;
+    const Ui8* End;
+    Ui32 Hour = 0;
+};
+
+// Отображает файл трейса в память и разбирает его без копирования.
+class TTraceReader {
+public:
+    TTraceReader() = default;
+    TTraceReader(const TTraceReader&) = delete;
+    TTraceReader& operator=(const TTraceReader&) = delete;
+    ~TTraceReader();
+
+    bool Open(const std::string& path);
+    void Close();
+    size_t GetRunCount() const { return Runs.size(); }
+    const TTraceRun& GetRun(size_t index) const { return Runs[index]; }
+
+    // Восстанавливает состояние симуляции после hours часов прогона runIndex
+    // с записанными в трейсе параметрами; глобальные переменные не меняются.
+    bool Replay(size_t runIndex, Ui32 hours, Simulation& sim) const;
+
+private:
+    const Ui8* Data = nullptr;
+    size_t Size = 0;
+    std::vector<TTraceRun> Runs;
+};
+
+} // namespace arctic
@@ -0,0 +1,235 @@
+#include "failure_log.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace arctic {
+
+namespace {
+
+const char kFailureLogMagic[4] = {'D', 'F', 'L', 'G'};
+const Ui32 kFailureLogVersion = 1;
+const size_t kFailureLogHeaderSize = 16;
+// Журнал длиннее полувека - почти наверняка ошибка во временах, а индекс по часам был бы огромным.
+const Ui64 kMaxFailureLogHours = 50ull * 365 * 24;
+
+bool ByTime(const TFailureRecord& a, const TFailureRecord& b) {
+    return a.TimeSeconds < b.TimeSeconds;
+}
+
+const char* SkipSpaces(const char* pos, const char* end) {
+    while (pos != end && (*pos == ' ' || *pos == '\t')) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Целое поле строки CSV и, если expectComma, запятая после него.
+template <typename T>
+bool ParseField(const char*& pos, const char* end, T& value, bool expectComma) {
+    pos = SkipSpaces(pos, end);
+    const auto [next, error] = std::from_chars(pos, end, value);
+    if (error != std::errc()) {
+        return false;
+    }
+    pos = SkipSpaces(next, end);
+    if (expectComma) {
+        if (pos == end || *pos != ',') {
+            return false;
+        }
+        ++pos;
+    }
+    return true;
+}
+
+// FNV-1a по 64-битным словам, а не по байтам: на журналах в гигабайты побайтовый проход заметно дольше разбора.
+Ui64 HashRecords(std::span<const TFailureRecord> records) {
+    Ui64 hash = 14695981039346656037ull;
+    for (const TFailureRecord& record : records) {
+        for (Ui64 word : {record.TimeSeconds, (static_cast<Ui64>(record.Dc) << 32) | record.Disk}) {
+            hash ^= word;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+std::mutex RegistryMutex;
+std::map<Ui64, std::shared_ptr<const TFailureLog>>& GetRegistry() {
+    static std::map<Ui64, std::shared_ptr<const TFailureLog>> registry;
+    return registry;
+}
+
+} // namespace
+
+bool TFailureLog::Load(const std::string& path) {
+    Parsed.clear();
+    Records = {};
+    HourStart.clear();
+    DcIds.clear();
+    Fingerprint = 0;
+    if (!File.Open(path)) {
+        return false;
+    }
+    const bool isBinary = File.GetSize() >= sizeof(kFailureLogMagic) &&
+                          std::memcmp(File.GetData(), kFailureLogMagic, sizeof(kFailureLogMagic)) == 0;
+    if (!(isBinary ? ParseBinary(path) : ParseCsv(path))) {
+        return false;
+    }
+    // Записи CSV уже скопированы, отображение больше не нужно.
+    if (!Parsed.empty()) {
+        File.Close();
+    }
+    return BuildIndex(path);
+}
+
+bool TFailureLog::ParseBinary(const std::string& path) {
+    const Ui8* data = File.GetData();
+    Ui32 version = 0;
+    Ui64 count = 0;
+    if (File.GetSize() < kFailureLogHeaderSize) {
+        LOG_ERROR("Truncated failure log header: " + path);
+        return false;
+    }
+    std::memcpy(&version, data + 4, sizeof(version));
+    std::memcpy(&count, data + 8, sizeof(count));
+    if (version != kFailureLogVersion) {
+        LOG_ERROR("Unsupported failure log version " + std::to_string(version) + ": " + path);
+        return false;
+    }
+    if (count > (File.GetSize() - kFailureLogHeaderSize) / sizeof(TFailureRecord) ||
+        kFailureLogHeaderSize + count * sizeof(TFailureRecord) != File.GetSize()) {
+        LOG_ERROR("Failure log size does not match its record count: " + path);
+        return false;
+    }
+    // Отображение выровнено по странице, а заголовок кратен размеру записи.
+    Records = {reinterpret_cast<const TFailureRecord*>(data + kFailureLogHeaderSize), static_cast<size_t>(count)};
+    if (!std::is_sorted(Records.begin(), Records.end(), ByTime)) {
+        LOG_WARNING("Failure log is not sorted by time, sorting a copy: " + path);
+        Parsed.assign(Records.begin(), Records.end());
+        std::stable_sort(Parsed.begin(), Parsed.end(), ByTime);
+        Records = Parsed;
+    }
+    return true;
+}
+
+bool TFailureLog::ParseCsv(const std::string& path) {
+    const char* pos = reinterpret_cast<const char*>(File.GetData());
+    const char* const end = pos + File.GetSize();
+    Ui32 lineNumber = 0;
+    while (pos != end) {
+        ++lineNumber;
+        const char* lineEnd = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        const char* next = lineEnd == end ? end : lineEnd + 1;
+        if (lineEnd != pos && lineEnd[-1] == '\r') {
+            --lineEnd;
+        }
+        const char* field = SkipSpaces(pos, lineEnd);
+        pos = next;
+        if (field == lineEnd || *field == '#') {
+            continue;
+        }
+        TFailureRecord record;
+        if (!ParseField(field, lineEnd, record.TimeSeconds, true) || !ParseField(field, lineEnd, record.Dc, true) ||
+            !ParseField(field, lineEnd, record.Disk, false) || field != lineEnd) {
+            // Первая строка может быть заголовком.
+            if (lineNumber == 1) {
+                continue;
+            }
+            LOG_ERROR("Malformed line " + std::to_string(lineNumber) + " in failure log " + path);
+            return false;
+        }
+        Parsed.push_back(record);
+    }
+    if (!std::is_sorted(Parsed.begin(), Parsed.end(), ByTime)) {
+        std::stable_sort(Parsed.begin(), Parsed.end(), ByTime);
+    }
+    Records = Parsed;
+    return true;
+}
+
+bool TFailureLog::BuildIndex(const std::string& path) {
+    if (Records.empty()) {
+        LOG_ERROR("Failure log is empty: " + path);
+        return false;
+    }
+    const Ui64 firstTime = Records.front().TimeSeconds;
+    const Ui64 hours = (Records.back().TimeSeconds - firstTime) / 3600 + 1;
+    if (hours > kMaxFailureLogHours) {
+        LOG_ERROR("Failure log spans " + std::to_string(hours) + " hours, more than supported: " + path);
+        return false;
+    }
+    // Часы после последней записи уже заканчиваются концом журнала.
+    HourStart.assign(hours + 1, Records.size());
+    HourStart[0] = 0;
+    Ui64 hour = 0;
+    for (size_t i = 0; i < Records.size(); ++i) {
+        const Ui64 recordHour = (Records[i].TimeSeconds - firstTime) / 3600;
+        while (hour < recordHour) {
+            HourStart[++hour] = i;
+        }
+        // DC в журнале единицы, так что вставка в отсортированный вектор дешевле сортировки всех записей.
+        if (DcIds.empty() || DcIds.back() != Records[i].Dc) {
+            const auto it = std::lower_bound(DcIds.begin(), DcIds.end(), Records[i].Dc);
+            if (it == DcIds.end() || *it != Records[i].Dc) {
+                DcIds.insert(it, Records[i].Dc);
+            }
+        }
+    }
+    Fingerprint = HashRecords(Records);
+    LOG_DEBUG("Loaded failure log " + path + ": " + std::to_string(Records.size()) + " failures over " +
+             std::to_string(hours) + " hours in " + std::to_string(DcIds.size()) + " DCs");
+    return true;
+}
+
+Ui32 TFailureLog::GetDcIndex(Ui32 dc) const {
+    return static_cast<Ui32>(std::lower_bound(DcIds.begin(), DcIds.end(), dc) - DcIds.begin());
+}
+
+bool SaveFailureLog(const std::string& path, std::vector<TFailureRecord> records) {
+    std::stable_sort(records.begin(), records.end(), ByTime);
+    const Ui64 count = records.size();
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        LOG_ERROR("Could not open failure log for writing: " + path);
+        return false;
+    }
+    bool ok = std::fwrite(kFailureLogMagic, sizeof(kFailureLogMagic), 1, file) == 1 &&
+              std::fwrite(&kFailureLogVersion, sizeof(kFailureLogVersion), 1, file) == 1 &&
+              std::fwrite(&count, sizeof(count), 1, file) == 1 &&
+              (records.empty() || std::fwrite(records.data(), sizeof(TFailureRecord), records.size(), file) == records.size());
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        LOG_ERROR("Could not write failure log: " + path);
+        std::remove(path.c_str());
+    }
+    return ok;
+}
+
+std::shared_ptr<const TFailureLog> OpenFailureLog(const std::string& path) {
+    auto log = std::make_shared<TFailureLog>();
+    if (!log->Load(path)) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(RegistryMutex);
+    // Тот же журнал, загруженный повторно, заменяет прежнюю копию только в реестре:
+    // конфигурации, которые уже держат прежнюю, досчитывают с ней.
+    GetRegistry()[log->GetFingerprint()] = log;
+    return log;
+}
+
+std::shared_ptr<const TFailureLog> FindFailureLog(Ui64 fingerprint) {
+    std::lock_guard<std::mutex> lock(RegistryMutex);
+    const auto& registry = GetRegistry();
+    const auto it = registry.find(fingerprint);
+    return it == registry.end() ? nullptr : it->second;
+}
+
+} // namespace arctic
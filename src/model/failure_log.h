@@ -0,0 +1,66 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "../utils/mapped_file.h"
+
+namespace arctic {
+
+// Отказ диска из журнала эксплуатации. В бинарном журнале записи лежат в этом же
+// виде (little-endian) после заголовка, поэтому читаются прямо из отображения файла.
+struct TFailureRecord {
+    Ui64 TimeSeconds = 0;
+    Ui32 Dc = 0;
+    Ui32 Disk = 0;
+
+    bool operator==(const TFailureRecord&) const = default;
+};
+static_assert(sizeof(TFailureRecord) == 16, "TFailureRecord is the on-disk record layout");
+
+// Журнал реальных отказов для воспроизведения в Simulation (kHazardReplay).
+// Формат определяется по содержимому: бинарный - заголовок "DFLG", версия и
+// число записей, затем записи по времени; CSV - строки "время,DC,диск" с
+// временем в секундах, строки '#' и заголовок в первой строке пропускаются.
+// Час журнала h - записи с (TimeSeconds - первое время) / 3600 == h.
+class TFailureLog {
+public:
+    bool Load(const std::string& path);
+
+    std::span<const TFailureRecord> GetRecords() const { return Records; }
+    // Хэш записей: одинаков для CSV и бинарной копии одного журнала, по нему
+    // журнал находят параметры прогона (TSimulationParams::FailureLogFingerprint).
+    Ui64 GetFingerprint() const { return Fingerprint; }
+    // Часов от первого отказа до последнего включительно.
+    Ui32 GetHourCount() const { return HourStart.empty() ? 0 : static_cast<Ui32>(HourStart.size() - 1); }
+    std::span<const TFailureRecord> GetHour(Ui32 hour) const {
+        return Records.subspan(HourStart[hour], HourStart[hour + 1] - HourStart[hour]);
+    }
+    // Плотный номер DC журнала в порядке возрастания его идентификатора.
+    Ui32 GetDcCount() const { return static_cast<Ui32>(DcIds.size()); }
+    Ui32 GetDcIndex(Ui32 dc) const;
+
+private:
+    bool ParseBinary(const std::string& path);
+    bool ParseCsv(const std::string& path);
+    bool BuildIndex(const std::string& path);
+
+    TMappedFile File;
+    // Записи CSV и неотсортированного бинарного журнала; иначе Records смотрит в File.
+    std::vector<TFailureRecord> Parsed;
+    std::span<const TFailureRecord> Records;
+    std::vector<Ui64> HourStart;
+    std::vector<Ui32> DcIds;
+    Ui64 Fingerprint = 0;
+};
+
+// Пишет бинарный журнал; записи сортируются по времени.
+bool SaveFailureLog(const std::string& path, std::vector<TFailureRecord> records);
+
+// Загружает журнал и регистрирует его по отпечатку, чтобы TSimulationConfig::FromParams
+// нашёл его и в прогонах, в том числе в процессах шардов после fork. nullptr при ошибке.
+std::shared_ptr<const TFailureLog> OpenFailureLog(const std::string& path);
+std::shared_ptr<const TFailureLog> FindFailureLog(Ui64 fingerprint);
+
+} // namespace arctic
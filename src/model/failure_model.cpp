@@ -0,0 +1,166 @@
+#include "failure_model.h"
+#include "../utils/logger.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+namespace arctic {
+
+namespace {
+
+const double kHoursPerYear = 365.0 * 24.0;
+
+// AFR - доля дисков, отказавших за год; интенсивность из неё - -ln(1 - AFR) в год.
+double AfrToHazardPerHour(Ui32 afrMilliPercent) {
+    const double afr = std::min(0.999999, afrMilliPercent / 100000.0);
+    return -std::log1p(-afr) / kHoursPerYear;
+}
+
+} // namespace
+
+const char* GetHazardModelName(Ui32 model) {
+    switch (model) {
+        case kHazardConstant:
+            return "constant";
+        case kHazardWeibull:
+            return "Weibull";
+        case kHazardPiecewise:
+            return "piecewise";
+        case kHazardReplay:
+            return "replay";
+        default:
+            return "unknown";
+    }
+}
+
+bool THazardTable::BuildFromParams(const TSimulationParams& params, double maxAgeHours) {
+    if (BuiltModel == params.HazardModel && BuiltMaxAgeHours == maxAgeHours &&
+        (params.HazardModel == kHazardWeibull
+            ? BuiltShapeMilli == params.WeibullShapeMilli && BuiltScaleDays == params.WeibullScaleDays
+            : BuiltPiecewise == params.PiecewiseHazard)) {
+        return true;
+    }
+    if (!BuildFromParamsUncached(params, maxAgeHours)) {
+        return false;
+    }
+    BuiltModel = params.HazardModel;
+    BuiltMaxAgeHours = maxAgeHours;
+    BuiltShapeMilli = params.WeibullShapeMilli;
+    BuiltScaleDays = params.WeibullScaleDays;
+    BuiltPiecewise = params.PiecewiseHazard;
+    return true;
+}
+
+bool THazardTable::BuildFromParamsUncached(const TSimulationParams& params, double maxAgeHours) {
+    if (params.HazardModel == kHazardWeibull) {
+        const double shape = params.WeibullShapeMilli / 1000.0;
+        const double scale = params.WeibullScaleDays * 24.0;
+        if (shape <= 0 || scale <= 0) {
+            LOG_ERROR("Weibull hazard needs positive shape and scale");
+            return false;
+        }
+        Build([shape, scale](double age) {
+            return std::pow(age / scale, shape);
+        }, maxAgeHours);
+        return true;
+    }
+    if (params.HazardModel == kHazardPiecewise) {
+        if (params.PiecewiseHazard.empty()) {
+            LOG_ERROR("Piecewise hazard is selected, but no hazard table is loaded");
+            return false;
+        }
+        const std::vector<THazardSegment>& segments = params.PiecewiseHazard;
+        Build([&segments](double age) {
+            double cumulative = 0;
+            for (size_t segment = 0; segment < segments.size(); ++segment) {
+                const double begin = segment == 0 ? 0.0 : segments[segment].AgeDays * 24.0;
+                const double end = segment + 1 < segments.size() ? segments[segment + 1].AgeDays * 24.0 : age;
+                if (begin >= age) {
+                    break;
+                }
+                cumulative += (std::min(end, age) - begin) * AfrToHazardPerHour(segments[segment].AfrMilliPercent);
+            }
+            return cumulative;
+        }, maxAgeHours);
+        return true;
+    }
+    LOG_ERROR("Hazard model " + std::string(GetHazardModelName(params.HazardModel)) + " has no per-PDisk hazard table");
+    return false;
+}
+
+double THazardTable::GetCumulative(double ageHours) const {
+    const double maxAge = AgeStep * (CumulativeByAge.size() - 1);
+    if (ageHours >= maxAge) {
+        return CumulativeByAge.back() + (ageHours - maxAge) * TailHazard;
+    }
+    const double position = std::max(0.0, ageHours) / AgeStep;
+    const size_t index = static_cast<size_t>(position);
+    const double fraction = position - index;
+    return CumulativeByAge[index] + (CumulativeByAge[index + 1] - CumulativeByAge[index]) * fraction;
+}
+
+double THazardTable::GetAgeForCumulative(double cumulative) const {
+    const double maxCumulative = CumulativeByAge.back();
+    if (cumulative >= maxCumulative) {
+        const double maxAge = AgeStep * (CumulativeByAge.size() - 1);
+        if (TailHazard <= 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return maxAge + (cumulative - maxCumulative) / TailHazard;
+    }
+    const double position = std::max(0.0, cumulative) / CumulativeStep;
+    const size_t index = std::min(static_cast<size_t>(position), AgeByCumulative.size() - 2);
+    const double fraction = position - index;
+    return AgeByCumulative[index] + (AgeByCumulative[index + 1] - AgeByCumulative[index]) * fraction;
+}
+
+double THazardTable::GetTimeToFailure(double ageHours, double exponential) const {
+    const double target = GetCumulative(ageHours) + exponential;
+    return std::max(0.0, GetAgeForCumulative(target) - ageHours);
+}
+
+bool LoadPiecewiseHazard(const std::string& path, std::vector<THazardSegment>& segments) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Could not open hazard table: " + path);
+        return false;
+    }
+    segments.clear();
+    std::string line;
+    Ui32 lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        double ageDays = 0;
+        double afrPercent = 0;
+        if (std::sscanf(line.c_str(), "%lf,%lf", &ageDays, &afrPercent) != 2) {
+            // Первая строка может быть заголовком.
+            if (lineNumber == 1) {
+                continue;
+            }
+            LOG_ERROR("Malformed line " + std::to_string(lineNumber) + " in hazard table " + path);
+            return false;
+        }
+        if (ageDays < 0 || afrPercent < 0 || afrPercent >= 100) {
+            LOG_ERROR("Out of range values on line " + std::to_string(lineNumber) + " in hazard table " + path);
+            return false;
+        }
+        THazardSegment segment;
+        segment.AgeDays = static_cast<Ui32>(ageDays);
+        segment.AfrMilliPercent = static_cast<Ui32>(std::lround(afrPercent * 1000.0));
+        segments.push_back(segment);
+    }
+    if (segments.empty()) {
+        LOG_ERROR("Hazard table is empty: " + path);
+        return false;
+    }
+    std::sort(segments.begin(), segments.end(), [](const THazardSegment& a, const THazardSegment& b) {
+        return a.AgeDays < b.AgeDays;
+    });
+    return true;
+}
+
+} // namespace arctic
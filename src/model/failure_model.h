@@ -0,0 +1,94 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "random_stream.h"
+#include "simulation_params.h"
+
+namespace arctic {
+
+enum EHazardModel : Ui32 {
+    // Прежняя модель: GFailureRate отказов в сутки на весь кластер.
+    kHazardConstant = 0,
+    kHazardWeibull,
+    kHazardPiecewise,
+    // Отказы из журнала эксплуатации (TFailureLog) вместо розыгрыша.
+    kHazardReplay,
+    kHazardModelCount
+};
+
+const char* GetHazardModelName(Ui32 model);
+
+// Табличная кумулятивная интенсивность H(t) одного PDisk'а в зависимости от возраста
+// и обратная к ней. Время до отказа диска возраста a - это H^-1(H(a) + E) - a, где
+// E ~ Exp(1), и обе таблицы равномерные, так что розыгрыш стоит O(1).
+class THazardTable {
+public:
+    // cumulativeHazard(ageHours) - H(t), таблица строится до maxAgeHours,
+    // дальше интенсивность считается постоянной.
+    template <typename TCumulative>
+    void Build(TCumulative&& cumulativeHazard, double maxAgeHours);
+    // Для Weibull и кусочно-постоянной модели по params.
+    // Если они не менялись с прошлой сборки, таблица не пересчитывается.
+    bool BuildFromParams(const TSimulationParams& params, double maxAgeHours);
+
+    double GetCumulative(double ageHours) const;
+    double GetAgeForCumulative(double cumulative) const;
+    // Время в часах до следующего отказа PDisk'а возраста ageHours.
+    double SampleTimeToFailure(double ageHours, TRandomStream& rng) const {
+        return GetTimeToFailure(ageHours, rng.NextExponential());
+    }
+    // То же по уже разыгранной экспоненциальной величине со средним 1.
+    double GetTimeToFailure(double ageHours, double exponential) const;
+
+private:
+    bool BuildFromParamsUncached(const TSimulationParams& params, double maxAgeHours);
+
+    double AgeStep = 1;
+    double CumulativeStep = 1;
+    double TailHazard = 0;
+    std::vector<double> CumulativeByAge;
+    std::vector<double> AgeByCumulative;
+
+    // Параметры, по которым таблицу последний раз построил BuildFromParams.
+    Ui32 BuiltModel = kHazardModelCount;
+    Ui32 BuiltShapeMilli = 0;
+    Ui32 BuiltScaleDays = 0;
+    double BuiltMaxAgeHours = 0;
+    std::vector<THazardSegment> BuiltPiecewise;
+};
+
+// CSV "возраст в днях,AFR в процентах": AFR действует от указанного возраста до следующей строки.
+bool LoadPiecewiseHazard(const std::string& path, std::vector<THazardSegment>& segments);
+
+template <typename TCumulative>
+void THazardTable::Build(TCumulative&& cumulativeHazard, double maxAgeHours) {
+    const Ui32 kAgePoints = 4096;
+    const Ui32 kCumulativePoints = 4096;
+
+    BuiltModel = kHazardModelCount;
+    AgeStep = maxAgeHours / (kAgePoints - 1);
+    CumulativeByAge.assign(kAgePoints, 0.0);
+    for (Ui32 i = 1; i < kAgePoints; ++i) {
+        CumulativeByAge[i] = cumulativeHazard(i * AgeStep);
+    }
+    TailHazard = (CumulativeByAge[kAgePoints - 1] - CumulativeByAge[kAgePoints - 2]) / AgeStep;
+
+    const double maxCumulative = CumulativeByAge.back();
+    CumulativeStep = maxCumulative > 0 ? maxCumulative / (kCumulativePoints - 1) : 1.0;
+    AgeByCumulative.assign(kCumulativePoints, 0.0);
+    Ui32 age = 0;
+    for (Ui32 i = 0; i < kCumulativePoints; ++i) {
+        const double target = i * CumulativeStep;
+        while (age + 1 < kAgePoints - 1 && CumulativeByAge[age + 1] < target) {
+            ++age;
+        }
+        const double low = CumulativeByAge[age];
+        const double high = CumulativeByAge[age + 1];
+        const double fraction = high > low ? std::min(1.0, std::max(0.0, (target - low) / (high - low))) : 0.0;
+        AgeByCumulative[i] = (age + fraction) * AgeStep;
+    }
+}
+
+} // namespace arctic
@@ -0,0 +1,143 @@
+#include "failure_strata.h"
+#include "erasure_scheme.h"
+#include "failure_model.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace arctic {
+
+namespace {
+
+// Доля прогонов, которая делится между стратами поровну, чтобы ни одна не осталась без прогонов.
+const double kUniformAllocationShare = 0.1;
+
+// Наименьшее число отказавших VDisk'ов группы, при котором схема может потерять данные.
+Ui32 MinFailuresToLoss(const TErasureSchemeInfo& scheme) {
+    std::array<Ui8, kMaxGroupDCs> failed = {};
+    Ui32 best = scheme.GetGroupSize();
+    // Перебор всех векторов отказов по DC как чисел в системе счисления VDisksPerDC + 1.
+    while (true) {
+        Ui32 total = 0;
+        for (Ui32 dc = 0; dc < scheme.NumDCs; ++dc) {
+            total += failed[dc];
+        }
+        if (total < best && scheme.IsDataLoss(failed.data())) {
+            best = total;
+        }
+        Ui32 dc = 0;
+        while (dc < scheme.NumDCs && failed[dc] == scheme.VDisksPerDC) {
+            failed[dc] = 0;
+            ++dc;
+        }
+        if (dc == scheme.NumDCs) {
+            break;
+        }
+        ++failed[dc];
+    }
+    return std::max<Ui32>(best, 1);
+}
+
+} // namespace
+
+bool TFailureStrata::Build(const TSimulationParams& params) {
+    if (Built && BuiltHazardModel == params.HazardModel && BuiltFailureRate == params.FailureRate &&
+        BuiltHorizonHours == params.HorizonHours && BuiltErasureScheme == params.ErasureScheme) {
+        return BuiltResult;
+    }
+    BuiltResult = BuildUncached(params);
+    Built = true;
+    BuiltHazardModel = params.HazardModel;
+    BuiltFailureRate = params.FailureRate;
+    BuiltHorizonHours = params.HorizonHours;
+    BuiltErasureScheme = params.ErasureScheme;
+    return BuiltResult;
+}
+
+bool TFailureStrata::BuildUncached(const TSimulationParams& params) {
+    CountProbability.clear();
+    StratumBegin.clear();
+    Weights.clear();
+    Allocation.clear();
+    AllocationEnd.clear();
+
+    const double rate = params.FailureRate / 24.0;
+    const double frac = rate - std::floor(rate);
+    const Ui32 hours = params.HorizonHours;
+    if (params.HazardModel != kHazardConstant || frac <= 0.0 || hours == 0) {
+        return false;
+    }
+
+    // Binomial(H, frac) через логарифмы, чтобы не переполняться на длинных горизонтах.
+    CountProbability.resize(hours + 1);
+    const double logH = std::lgamma(hours + 1.0);
+    for (Ui32 n = 0; n <= hours; ++n) {
+        CountProbability[n] = std::exp(logH - std::lgamma(n + 1.0) - std::lgamma(hours - n + 1.0) +
+                                       n * std::log(frac) + (hours - n) * std::log1p(-frac));
+    }
+
+    // Границы по квантилям; у дискретного распределения часть страт может слиться.
+    StratumBegin.push_back(0);
+    double cumulative = 0.0;
+    Ui32 stratum = 1;
+    for (Ui32 n = 0; n <= hours && stratum < kMaxFailureStrata; ++n) {
+        cumulative += CountProbability[n];
+        if (cumulative >= static_cast<double>(stratum) / kMaxFailureStrata) {
+            if (n < hours) {
+                StratumBegin.push_back(n + 1);
+            }
+            while (stratum < kMaxFailureStrata && cumulative >= static_cast<double>(stratum) / kMaxFailureStrata) {
+                ++stratum;
+            }
+        }
+    }
+    StratumBegin.push_back(hours + 1);
+
+    // Потеря требует order одновременных отказов в группе, так что её вероятность растёт
+    // примерно как N^order, а стандартное отклонение оценки - как N^(order / 2).
+    // Распределение по Нейману с таким отклонением отдаёт прогоны стратам с большим N.
+    const double order = MinFailuresToLoss(GetErasureScheme(params.ErasureScheme));
+    const Ui32 strata = static_cast<Ui32>(StratumBegin.size()) - 1;
+    double allocationSum = 0.0;
+    for (Ui32 s = 0; s < strata; ++s) {
+        double weight = 0.0;
+        double mean = 0.0;
+        for (Ui32 n = StratumBegin[s]; n < StratumBegin[s + 1]; ++n) {
+            weight += CountProbability[n];
+            mean += n * CountProbability[n];
+        }
+        mean = weight > 0 ? mean / weight : StratumBegin[s];
+        Weights.push_back(weight);
+        Allocation.push_back(weight * std::pow(mean + 1.0, order / 2.0));
+        allocationSum += Allocation.back();
+    }
+    double end = 0.0;
+    for (double& allocation : Allocation) {
+        allocation = (1.0 - kUniformAllocationShare) * allocation / allocationSum + kUniformAllocationShare / strata;
+        end += allocation;
+        AllocationEnd.push_back(end);
+    }
+    AllocationEnd.back() = 1.0;
+    return true;
+}
+
+Ui32 TFailureStrata::PickStratum(Ui64 simIndex) const {
+    // Дробные части simIndex * (золотое сечение) в фиксированной точке.
+    const double u = static_cast<double>((simIndex * 0x9e3779b97f4a7c15ull) >> 11) * 0x1.0p-53;
+    const auto it = std::upper_bound(AllocationEnd.begin(), AllocationEnd.end(), u);
+    return std::min(static_cast<Ui32>(it - AllocationEnd.begin()), GetStratumCount() - 1);
+}
+
+Ui32 TFailureStrata::DrawFailureCount(Ui32 stratum, TRandomStream& rng) const {
+    double u = rng.NextUniform() * Weights[stratum];
+    const Ui32 last = StratumBegin[stratum + 1] - 1;
+    for (Ui32 n = StratumBegin[stratum]; n < last; ++n) {
+        u -= CountProbability[n];
+        if (u < 0) {
+            return n;
+        }
+    }
+    return last;
+}
+
+} // namespace arctic
@@ -0,0 +1,51 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include "random_stream.h"
+#include <vector>
+#include "simulation_params.h"
+#include "simulation_stats.h"
+
+namespace arctic {
+
+// Стратификация прогонов по числу отказов за горизонт при постоянной интенсивности.
+// В час случается floor(r) отказов и ещё один с вероятностью frac(r), r = GFailureRate / 24,
+// так что число дополнительных отказов N за H часов распределено как Binomial(H, frac(r)),
+// а при заданном N их часы - равномерная выборка N часов из H. Страты - интервалы N
+// примерно равной вероятности; прогоны распределяются между ними не пропорционально,
+// а с перевесом в сторону больших N, где потери вероятнее.
+class TFailureStrata {
+public:
+    // Строит страты по params, если они менялись с прошлой сборки.
+    // false, если стратифицировать нечего: модель отказов не постоянная или frac(r) = 0.
+    bool Build(const TSimulationParams& params);
+
+    Ui32 GetStratumCount() const { return static_cast<Ui32>(Weights.size()); }
+    // Вероятность страты, с которой её оценка входит в общую.
+    double GetWeight(Ui32 stratum) const { return Weights[stratum]; }
+    // Доля прогонов, которая достаётся страте.
+    double GetAllocation(Ui32 stratum) const { return Allocation[stratum]; }
+    // Страта прогона simIndex. Доли выдерживаются последовательностью Вейля,
+    // поэтому любой отрезок номеров прогонов делится между стратами почти точно.
+    Ui32 PickStratum(Ui64 simIndex) const;
+    // Число дополнительных отказов за горизонт при условии попадания в страту.
+    Ui32 DrawFailureCount(Ui32 stratum, TRandomStream& rng) const;
+
+private:
+    bool BuildUncached(const TSimulationParams& params);
+
+    // Вероятности Binomial(H, frac(r)) и первое N каждой страты, последний элемент - H + 1.
+    std::vector<double> CountProbability;
+    std::vector<Ui32> StratumBegin;
+    std::vector<double> Weights;
+    std::vector<double> Allocation;
+    std::vector<double> AllocationEnd;
+
+    bool Built = false;
+    bool BuiltResult = false;
+    Ui32 BuiltHazardModel = 0;
+    Ui32 BuiltFailureRate = 0;
+    Ui32 BuiltHorizonHours = 0;
+    Ui32 BuiltErasureScheme = 0;
+};
+
+} // namespace arctic
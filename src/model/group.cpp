@@ -1,4 +1,5 @@
 #include "group.h"
+#include "group_loss.h"
 #include "vdisk.h"
 #include "../utils/logger.h"
 #include <vector>      
@@ -8,50 +9,50 @@
 
 namespace arctic {
 
-TGroup::TGroup(TGroupId id) {
-    Id = id;
+TGroup::TGroup(TGroupId id, const TErasureSchemeInfo& scheme)
+    : Id(id), Scheme(&scheme) {
 }
 
-void TGroup::AddVDisk(std::shared_ptr<TVDisk> vdisk, TDCId dcId) {
-    VDisksByDC[dcId].push_back(vdisk->GetId());
-    VDisks[vdisk->GetId()] = vdisk;
-    AllVDiskIds.insert(vdisk->GetId());
+void TGroup::AddVDisk(std::shared_ptr<TVDisk> vdisk, TDCId dcIndex) {
+    if (dcIndex >= Scheme->NumDCs) {
+        LOG_ERROR("Invalid DC index " + std::to_string(dcIndex) + " in group " + Id.ToString() +
+                  " for scheme " + Scheme->Name);
+        return;
+    }
+    VDisks.push_back(std::move(vdisk));
+    VDiskDCs.push_back(dcIndex);
 }
 
 bool TGroup::CheckDataLoss() const {
-    std::vector<int> failedVDiskPerDc(3, 0);
-    for (const auto& vdiskId : AllVDiskIds) {
-        auto vdiskIt = VDisks.find(vdiskId);
-        if (vdiskIt == VDisks.end() || !vdiskIt->second) {
-             LOG_ERROR("VDisk ID " + vdiskId.ToString() + " not found in group " + Id.ToString() + " during CheckDataLoss.");
-             continue;
-        }
-        const auto& vdisk = vdiskIt->second;
-
-        if (vdisk->GetState() == TVDisk::Faulty || vdisk->GetState() == TVDisk::Replicating) {
-            TDCId dcId = vdisk->GetDCId();
-            if (dcId < failedVDiskPerDc.size()) {
-                 failedVDiskPerDc[dcId]++;
-            } else {
-                 LOG_ERROR("Invalid DC ID " + std::to_string(dcId) + " encountered for VDisk " + vdiskId.ToString() + " in group " + Id.ToString());
-            }
-        }
+    std::array<Ui8, kMaxGroupDCs> failedVDiskPerDc = {};
+    for (size_t i = 0; i < VDisks.size(); ++i) {
+        failedVDiskPerDc[VDiskDCs[i]] += VDisks[i]->IsFailed();
     }
 
-    std::sort(failedVDiskPerDc.begin(), failedVDiskPerDc.end(), std::greater<int>());
+    return Scheme->IsDataLoss(failedVDiskPerDc.data());
+}
 
-    if (failedVDiskPerDc[2] > 0) {
-        return true;
-    }
-    if (failedVDiskPerDc[1] >= 2 && failedVDiskPerDc[0] >= 3) {
-        return true;
+TGroupLossCheck GetGroupLossCheck(Ui32 scheme) {
+    // Порядок совпадает с EErasureScheme.
+    static constexpr std::array<TGroupLossCheck, kErasureSchemeCount> kGroupLossChecks = {
+        &CheckDataLoss<TMirror3Dc>,
+        &CheckDataLoss<TBlock42>,
+        &CheckDataLoss<TMirror3Of4>,
+    };
+    if (scheme >= kErasureSchemeCount) {
+        LOG_ERROR("Unknown erasure scheme " + std::to_string(scheme) + ", using mirror-3-dc");
+        return kGroupLossChecks[kMirror3DcScheme];
     }
-
-    return false;
+    return kGroupLossChecks[scheme];
 }
 
 std::vector<TVDiskId> TGroup::GetAllVDiskIds() const {
-    return std::vector<TVDiskId>(AllVDiskIds.begin(), AllVDiskIds.end());
+    std::vector<TVDiskId> ids;
+    ids.reserve(VDisks.size());
+    for (const auto& vdisk : VDisks) {
+        ids.push_back(vdisk->GetId());
+    }
+    return ids;
 }
 
 } 
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 #include <arctic/engine/easy.h>
-#include <unordered_set>
+#include <array>
+#include <type_traits>
+#include <vector>
 #include "id_wrapper.h"
+#include "erasure_scheme.h"
 
 namespace arctic {
 
@@ -9,17 +12,44 @@ using TGroupId = TIdWrapper<Ui32, TGroupIdTag>;
 
 class TVDisk;
 
+// Компактная запись группы для симуляции: индексы VDisk'ов подряд по DC
+// группы, по VDisksPerDC на каждый, так что границы DC не хранятся.
+// Запись тривиально копируется, и массив групп можно клонировать memcpy.
+struct TGroupRecord {
+    std::array<Ui32, kMaxGroupVDisks> VDisks = {};
+    Ui8 Size = 0;
+    Ui8 VDisksPerDC = 1;
+    Ui8 Scheme = kMirror3DcScheme;
+
+    // Номер DC внутри группы для VDisk'а на позиции position.
+    Ui32 GetDCIndex(Ui32 position) const { return position / VDisksPerDC; }
+};
+
+static_assert(std::is_trivially_copyable_v<TGroupRecord>);
+
+// Проверка потери данных в группе; vdisks индексируются номерами VDisk'ов из
+// записи. Развёрнутые варианты для каждой схемы - CheckDataLoss<TScheme> из group_loss.h.
+using TGroupLossCheck = bool (*)(const TGroupRecord& group, const TVDisk* const* vdisks);
+
+// Вариант проверки для схемы с номером scheme; выбирается один раз на прогон,
+// а не на каждую проверку. Для неизвестного номера - mirror-3-dc.
+TGroupLossCheck GetGroupLossCheck(Ui32 scheme);
+
+// Группа со ссылками на сами VDisk'и, для работы с отдельными группами вне симуляции.
 class TGroup {
 public:
-    TGroup(TGroupId id);
-    void AddVDisk(std::shared_ptr<TVDisk> vdisk, TDCId dcId);
+    TGroup(TGroupId id, const TErasureSchemeInfo& scheme = GetErasureScheme(kMirror3DcScheme));
+    // dcIndex - номер DC внутри группы, от 0 до Scheme.NumDCs - 1.
+    void AddVDisk(std::shared_ptr<TVDisk> vdisk, TDCId dcIndex);
     bool MakeVDiskFaulty(TVDiskId vdiskId);
     bool CheckDataLoss() const;
     std::vector<TVDiskId> GetAllVDiskIds() const;
+    const std::vector<std::shared_ptr<TVDisk>>& GetVDisks() const { return VDisks; }
 private:
     TGroupId Id;
-    std::unordered_map<TDCId, std::vector<TVDiskId>> VDisksByDC;
-    std::unordered_map<TVDiskId, std::shared_ptr<TVDisk>> VDisks;
-    std::unordered_set<TVDiskId> AllVDiskIds;
+    const TErasureSchemeInfo* Scheme;
+    // В группе единицы VDisk'ов, поэтому они хранятся списком в порядке добавления.
+    std::vector<std::shared_ptr<TVDisk>> VDisks;
+    std::vector<TDCId> VDiskDCs;
 };
 }
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <array>
+#include <utility>
+#include "group.h"
+#include "vdisk.h"
+
+namespace arctic {
+
+// Проверка группы полного размера схемы TScheme: проход по группе
+// разворачивается, номер DC каждой позиции - константа, и счётчики отказов по
+// DC вместе с предикатом схемы остаются линейным кодом без ветвлений.
+template <typename TScheme>
+bool CheckDataLoss(const TGroupRecord& group, const TVDisk* const* vdisks) {
+    std::array<Ui8, TScheme::NumDCs> failedVDiskPerDc = {};
+    [&]<size_t... Positions>(std::index_sequence<Positions...>) {
+        ((failedVDiskPerDc[Positions / TScheme::VDisksPerDC] += vdisks[group.VDisks[Positions]]->IsFailed()), ...);
+    }(std::make_index_sequence<TScheme::NumDCs * TScheme::VDisksPerDC>{});
+    return TScheme::IsDataLoss(failedVDiskPerDc.data());
+}
+
+} // namespace arctic
@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <vector>
+#include "id_wrapper.h"
+
+namespace arctic {
+
+// Плотный массив, индексируемый типизированным id: элемент с id лежит по
+// индексу id.GetRawId(). Подходит для id, выдаваемых подряд с нуля, как у
+// PDisk'ов, VDisk'ов и групп симуляции. В отладочной сборке индекс проверяется.
+template <typename TId, typename T>
+class TIdVector {
+public:
+    using value_type = T;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    TIdVector() = default;
+    explicit TIdVector(size_t size, const T& value = T()) : Items(size, value) {}
+
+    T& operator[](TId id) { return Items[Index(id)]; }
+    const T& operator[](TId id) const { return Items[Index(id)]; }
+
+    bool Contains(TId id) const { return id.GetRawId() < Items.size(); }
+    T* FindPtr(TId id) { return Contains(id) ? &Items[id.GetRawId()] : nullptr; }
+    const T* FindPtr(TId id) const { return Contains(id) ? &Items[id.GetRawId()] : nullptr; }
+
+    // Добавляет элемент со следующим по порядку id и возвращает этот id.
+    TId PushBack(T value) {
+        Items.push_back(std::move(value));
+        return TId::FromValue(static_cast<typename TId::Type>(Items.size() - 1));
+    }
+
+    void Assign(size_t size, const T& value) { Items.assign(size, value); }
+    void Resize(size_t size) { Items.resize(size); }
+    void Reserve(size_t size) { Items.reserve(size); }
+    void Clear() { Items.clear(); }
+
+    size_t Size() const { return Items.size(); }
+    bool Empty() const { return Items.empty(); }
+    TId EndId() const { return TId::FromValue(static_cast<typename TId::Type>(Items.size())); }
+
+    iterator begin() { return Items.begin(); }
+    iterator end() { return Items.end(); }
+    const_iterator begin() const { return Items.begin(); }
+    const_iterator end() const { return Items.end(); }
+
+private:
+    size_t Index(TId id) const {
+        assert(id.GetRawId() < Items.size() && "TIdVector: id out of range");
+        return id.GetRawId();
+    }
+
+    std::vector<T> Items;
+};
+
+// Множество id в виде битовой маски по GetRawId().
+template <typename TId>
+class TIdBitset {
+public:
+    TIdBitset() = default;
+    explicit TIdBitset(size_t size) { Resize(size); }
+
+    // Меняет число id, все биты сбрасываются.
+    void Resize(size_t size) {
+        Bits = size;
+        Words.assign((size + 63) / 64, 0);
+    }
+    void Clear() { std::fill(Words.begin(), Words.end(), 0); }
+
+    bool Test(TId id) const { return (Words[Word(id)] >> (id.GetRawId() & 63)) & 1; }
+    void Set(TId id) { Words[Word(id)] |= Mask(id); }
+    void Reset(TId id) { Words[Word(id)] &= ~Mask(id); }
+    // Возвращает true, если бит был сброшен до вызова.
+    bool TestAndSet(TId id) {
+        Ui64& word = Words[Word(id)];
+        const Ui64 mask = Mask(id);
+        const bool wasSet = word & mask;
+        word |= mask;
+        return !wasSet;
+    }
+
+    size_t Size() const { return Bits; }
+    size_t Count() const {
+        size_t count = 0;
+        for (Ui64 word : Words) {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+
+private:
+    size_t Word(TId id) const {
+        assert(id.GetRawId() < Bits && "TIdBitset: id out of range");
+        return id.GetRawId() >> 6;
+    }
+    static Ui64 Mask(TId id) { return Ui64(1) << (id.GetRawId() & 63); }
+
+    std::vector<Ui64> Words;
+    size_t Bits = 0;
+};
+
+} // namespace arctic
@@ -40,13 +40,13 @@ public:
     static constexpr TIdWrapper Zero() noexcept { return TIdWrapper(); }
 
     TIdWrapper &operator+=(const T &other) {
-        Raw += other.Raw;
+        Raw += other;
         return *this;
     }
 
     friend TIdWrapper operator+(const TIdWrapper &first,
                                 const T &second) {
-        return TIdWrapper(first->Raw + second);
+        return FromValue(first.Raw + second);
     }
 
     TIdWrapper &operator++() {
@@ -70,7 +70,7 @@ public:
 
     constexpr auto operator<=>(const TIdWrapper &) const = default;
 
-    T GetRawId() const { return Raw; }
+    constexpr T GetRawId() const { return Raw; }
 
     friend std::hash<TIdWrapper<T, Tag>>;
 };
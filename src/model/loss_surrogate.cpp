@@ -0,0 +1,127 @@
+#include "loss_surrogate.h"
+#include "simulation.h"
+#include "erasure_scheme.h"
+#include <limits>
+
+namespace arctic {
+
+namespace {
+
+const Si64 kNeverFailed = std::numeric_limits<Si32>::min();
+
+} // namespace
+
+void TLossSurrogate::Reset(const Simulation& sim) {
+    const TSimulationConfig& config = sim.GetConfig();
+    VDisksPerPDisk = std::max(1u, config.Params.VDisksPerPDisk);
+    RecoveryHours = config.Params.PDiskRecoveryTimeHours;
+    BaseFailures = config.BaseFailuresPerHour;
+    ExtraProbability = config.ExtraFailureProbability;
+    IsDataLoss = GetErasureScheme(config.Params.ErasureScheme).IsDataLoss;
+    // Репликация, начатая в час отказа h, завершается в первом часе не раньше
+    // h + время копии, и до конца проверки групп этого часа VDisk ещё отказавший.
+    for (Ui32 window = 0; window < kControlWindows; ++window) {
+        WindowHours[window] = config.ReplicationHours * kSurrogateWindowFactors[window];
+    }
+
+    const Ui32 pdiskCount = sim.PDisks.Size();
+    Groups.assign(sim.Groups.begin(), sim.Groups.end());
+    GroupsBegin.assign(pdiskCount + 1, 0);
+    for (const TGroupRecord& group : Groups) {
+        for (Ui32 i = 0; i < group.Size; ++i) {
+            ++GroupsBegin[group.VDisks[i] / VDisksPerPDisk + 1];
+        }
+    }
+    for (Ui32 pdisk = 0; pdisk < pdiskCount; ++pdisk) {
+        GroupsBegin[pdisk + 1] += GroupsBegin[pdisk];
+    }
+    GroupsOfPDisk.resize(GroupsBegin[pdiskCount]);
+    FillPos.assign(GroupsBegin.begin(), GroupsBegin.end() - 1);
+    for (Ui32 group = 0; group < Groups.size(); ++group) {
+        // Дальше нужны только PDisk'и группы, так что номера VDisk'ов заменяются ими.
+        for (Ui32 i = 0; i < Groups[group].Size; ++i) {
+            Groups[group].VDisks[i] /= VDisksPerPDisk;
+            GroupsOfPDisk[FillPos[Groups[group].VDisks[i]]++] = group;
+        }
+    }
+    FailedAt.resize(pdiskCount);
+    Restart();
+}
+
+void TLossSurrogate::Restart() {
+    std::fill(FailedAt.begin(), FailedAt.end(), kNeverFailed);
+    LossHours.fill(-1);
+    PendingWindows = kControlWindows;
+}
+
+void TLossSurrogate::OnFailure(Ui32 pdiskIndex, Ui32 hour) {
+    FailedAt[pdiskIndex] = hour;
+    if (PendingWindows == 0) {
+        return;
+    }
+    for (Ui32 i = GroupsBegin[pdiskIndex]; i < GroupsBegin[pdiskIndex + 1]; ++i) {
+        const TGroupRecord& group = Groups[GroupsOfPDisk[i]];
+        // Отказавшие при меньшем окне отказавшие и при большем, а предикат потери
+        // монотонен, так что окна проверяются от большего, пока группа теряется.
+        for (Ui32 window = kControlWindows; window-- > 0;) {
+            std::array<Ui8, kMaxGroupDCs> failed = {};
+            const Si64 since = static_cast<Si64>(hour) - WindowHours[window];
+            for (Ui32 position = 0; position < group.Size; ++position) {
+                failed[group.GetDCIndex(position)] += FailedAt[group.VDisks[position]] >= since;
+            }
+            if (!IsDataLoss(failed.data())) {
+                break;
+            }
+            if (LossHours[window] < 0) {
+                LossHours[window] = hour;
+                --PendingWindows;
+            }
+        }
+    }
+}
+
+void TLossSurrogate::SimulateFailures(Ui32 fromHour, Ui32 toHour, TRandomStream& rng) {
+    const Si32 pdiskCount = FailedAt.size();
+    if (pdiskCount == 0) {
+        return;
+    }
+    // Закон Simulation::SimulateHour: каждый час floor(r) отказов и ещё один с
+    // вероятностью дробной части r. Часы с лишним отказом разыгрываются сразу
+    // геометрическими промежутками, а не броском на каждый час.
+    const Si32 baseFailures = BaseFailures;
+    const double extraProbability = ExtraProbability;
+    auto nextExtraHour = [&](Ui64 after) -> Ui64 {
+        if (extraProbability <= 0) {
+            return std::numeric_limits<Ui64>::max();
+        }
+        return after + rng.NextGeometric(extraProbability);
+    };
+
+    Ui64 extraHour = nextExtraHour(fromHour);
+    for (Ui32 hour = fromHour; hour < toHour; ++hour) {
+        Si32 failures = baseFailures;
+        if (hour == extraHour) {
+            ++failures;
+            extraHour = nextExtraHour(hour + 1);
+        }
+        if (baseFailures == 0 && failures == 0) {
+            hour = static_cast<Ui32>(std::min<Ui64>(extraHour, toHour)) - 1;
+            continue;
+        }
+        // Как в Simulation::ProcessFailures: равновероятный выбор среди несломанных, а
+        // PDisk, отказавший в час h, снова доступен с часа h + RecoveryHours + 1.
+        Si32 attempts = 0;
+        for (Si32 done = 0; done < failures && attempts < pdiskCount;) {
+            const Si32 pdisk = static_cast<Si32>(rng.NextBounded(pdiskCount));
+            if (FailedAt[pdisk] + RecoveryHours >= hour) {
+                ++attempts;
+                continue;
+            }
+            OnFailure(pdisk, hour);
+            ++done;
+            attempts = 0;
+        }
+    }
+}
+
+} // namespace arctic
@@ -0,0 +1,55 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include "group.h"
+#include "simulation_stats.h"
+#include <array>
+#include "random_stream.h"
+#include <vector>
+
+namespace arctic {
+
+class Simulation;
+
+// Окна отказа суррогатной модели в номинальных временах репликации. Делёж полосы
+// между репликациями растягивает их в Simulation в разы, и лучше всего с прогоном
+// коррелирует то окно, что ближе к фактической длительности; выбирает его статистика.
+constexpr std::array<Ui32, kControlWindows> kSurrogateWindowFactors = {1, 2, 3, 6};
+
+// Дешёвая модель потери для контрольной переменной. Отказы PDisk'ов те же, что
+// в Simulation, но VDisk считается отказавшим фиксированное окно после отказа
+// своего PDisk'а, без репликаций и запасных слотов. Закон отказов совпадает с
+// Simulation::SimulateHour при постоянной интенсивности, поэтому после потери в
+// настоящем прогоне модель досчитывает горизонт сама, а среднее её потерь
+// оценивается отдельными прогонами без Simulation.
+class TLossSurrogate {
+public:
+    // Берёт раскладку групп и параметры из sim после Reset. Память переиспользуется между вызовами.
+    void Reset(const Simulation& sim);
+    // Начинает новый прогон на той же раскладке.
+    void Restart();
+    void OnFailure(Ui32 pdiskIndex, Ui32 hour);
+    // Разыгрывает отказы часов [fromHour, toHour) тем же законом, что Simulation.
+    void SimulateFailures(Ui32 fromHour, Ui32 toHour, TRandomStream& rng);
+    // Час первой потери с окном window или -1.
+    Si64 GetLossHour(Ui32 window) const { return LossHours[window]; }
+
+private:
+    Ui32 VDisksPerPDisk = 1;
+    Ui32 RecoveryHours = 0;
+    Si32 BaseFailures = 0;
+    double ExtraProbability = 0;
+    std::array<Ui32, kControlWindows> WindowHours = {};
+    // Предикат схемы раскладки, выбирается в Reset.
+    TLossPredicate IsDataLoss = nullptr;
+    std::vector<TGroupRecord> Groups;
+    // Группы VDisk'ов каждого PDisk'а в CSR: GroupsOfPDisk[GroupsBegin[p]..GroupsBegin[p + 1]).
+    std::vector<Ui32> GroupsBegin;
+    std::vector<Ui32> GroupsOfPDisk;
+    std::vector<Ui32> FillPos;
+    // Час последнего отказа PDisk'а, до первого отказа - заведомо вне любого окна.
+    std::vector<Si64> FailedAt;
+    std::array<Si64, kControlWindows> LossHours = {};
+    Ui32 PendingWindows = 0;
+};
+
+} // namespace arctic
@@ -0,0 +1,269 @@
+#include "markov_estimator.h"
+#include "erasure_scheme.h"
+#include "failure_model.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace arctic {
+
+namespace {
+
+// Больший шаг uniformization упирается в underflow exp(-Lambda * dt).
+const double kMaxUniformizedRate = 32.0;
+const double kPoissonTailEpsilon = 1e-13;
+const Ui32 kMaxCurvePoints = 2000;
+
+struct TTransition {
+    Ui32 From;
+    Ui32 To;
+    double Rate;
+};
+
+// Разреженный генератор цепи; состояние потери - последнее и поглощающее.
+struct TChain {
+    std::vector<TTransition> Transitions;
+    std::vector<double> ExitRate;
+    double MaxExitRate = 0;
+};
+
+// Время репликации почти детерминировано, поэтому оно приближается распределением
+// Эрланга: отказавший VDisk проходит kRepairPhases экспоненциальных фаз.
+// Больше фаз - точнее, но состояний для mirror-3-dc уже (C(3 + k, k))^3.
+const Ui32 kRepairPhases = 2;
+
+class TGroupChain {
+public:
+    explicit TGroupChain(const TErasureSchemeInfo& scheme)
+        : Scheme(scheme)
+    {
+        // Состояние DC - число отказавших VDisk'ов в каждой фазе репликации.
+        std::array<Ui8, kRepairPhases> phases = {};
+        EnumerateDCStates(phases, 0, 0);
+
+        // Состояние группы - состояния её DC в смешанной системе счисления.
+        Ui32 states = 1;
+        for (Ui32 dc = 0; dc < Scheme.NumDCs; ++dc) {
+            states *= DCStates.size();
+        }
+        IndexByState.assign(states, 0);
+        std::array<Ui8, kMaxGroupDCs> failed = {};
+        for (Ui32 state = 0; state < states; ++state) {
+            Ui32 rest = state;
+            for (Ui32 dc = 0; dc < Scheme.NumDCs; ++dc) {
+                failed[dc] = DCStates[rest % DCStates.size()].Failed;
+                rest /= DCStates.size();
+            }
+            if (Scheme.IsDataLoss(failed.data())) {
+                IndexByState[state] = kLost;
+            } else {
+                IndexByState[state] = LiveStates.size();
+                LiveStates.push_back(state);
+            }
+        }
+    }
+
+    Ui32 GetStateCount() const { return LiveStates.size() + 1; }
+    Ui32 GetLossState() const { return LiveStates.size(); }
+
+    TChain Build(double failureRate, double phaseRate) const {
+        TChain chain;
+        chain.ExitRate.assign(GetStateCount(), 0.0);
+        for (Ui32 from = 0; from < LiveStates.size(); ++from) {
+            Ui32 rest = LiveStates[from];
+            Ui32 stride = 1;
+            for (Ui32 dc = 0; dc < Scheme.NumDCs; ++dc, stride *= DCStates.size()) {
+                const Ui32 local = rest % DCStates.size();
+                rest /= DCStates.size();
+                for (const TDCTransition& transition : DCTransitions[local]) {
+                    const double rate = transition.Multiplicity * (transition.IsFailure ? failureRate : phaseRate);
+                    if (rate > 0) {
+                        const Ui32 toState = LiveStates[from] + (transition.To - local) * stride;
+                        Add(chain, from, toState, rate);
+                    }
+                }
+            }
+        }
+        for (double rate : chain.ExitRate) {
+            chain.MaxExitRate = std::max(chain.MaxExitRate, rate);
+        }
+        return chain;
+    }
+
+private:
+    static constexpr Ui32 kLost = std::numeric_limits<Ui32>::max();
+
+    struct TDCState {
+        std::array<Ui8, kRepairPhases> Phases;
+        Ui8 Failed;
+    };
+
+    struct TDCTransition {
+        Ui32 To;
+        Ui32 Multiplicity;
+        bool IsFailure;
+    };
+
+    void EnumerateDCStates(std::array<Ui8, kRepairPhases>& phases, Ui32 phase, Ui32 failed) {
+        if (phase == kRepairPhases) {
+            DCStates.push_back({phases, static_cast<Ui8>(failed)});
+            return;
+        }
+        for (Ui32 count = 0; failed + count <= Scheme.VDisksPerDC; ++count) {
+            phases[phase] = count;
+            EnumerateDCStates(phases, phase + 1, failed + count);
+        }
+        phases[phase] = 0;
+        if (phase == 0) {
+            BuildDCTransitions();
+        }
+    }
+
+    Ui32 FindDCState(const std::array<Ui8, kRepairPhases>& phases) const {
+        for (Ui32 i = 0; i < DCStates.size(); ++i) {
+            if (DCStates[i].Phases == phases) {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    void BuildDCTransitions() {
+        DCTransitions.resize(DCStates.size());
+        for (Ui32 local = 0; local < DCStates.size(); ++local) {
+            const TDCState& state = DCStates[local];
+            if (state.Failed < Scheme.VDisksPerDC) {
+                std::array<Ui8, kRepairPhases> next = state.Phases;
+                ++next[0];
+                DCTransitions[local].push_back({FindDCState(next), Scheme.VDisksPerDC - state.Failed, true});
+            }
+            for (Ui32 phase = 0; phase < kRepairPhases; ++phase) {
+                if (state.Phases[phase] == 0) {
+                    continue;
+                }
+                std::array<Ui8, kRepairPhases> next = state.Phases;
+                --next[phase];
+                if (phase + 1 < kRepairPhases) {
+                    ++next[phase + 1];
+                }
+                DCTransitions[local].push_back({FindDCState(next), state.Phases[phase], false});
+            }
+        }
+    }
+
+    void Add(TChain& chain, Ui32 from, Ui32 toState, double rate) const {
+        const Ui32 to = IndexByState[toState] == kLost ? GetLossState() : IndexByState[toState];
+        chain.Transitions.push_back({from, to, rate});
+        chain.ExitRate[from] += rate;
+    }
+
+    const TErasureSchemeInfo& Scheme;
+    std::vector<TDCState> DCStates;
+    std::vector<std::vector<TDCTransition>> DCTransitions;
+    std::vector<Ui32> LiveStates;
+    std::vector<Ui32> IndexByState;
+};
+
+// distribution <- distribution * exp(Q * hours) через uniformization.
+void Advance(const TChain& chain, double hours, std::vector<double>& distribution,
+             std::vector<double>& term, std::vector<double>& next) {
+    if (hours <= 0 || chain.MaxExitRate <= 0) {
+        return;
+    }
+    const Ui32 substeps = std::max<Ui32>(1, std::ceil(chain.MaxExitRate * hours / kMaxUniformizedRate));
+    const double dt = hours / substeps;
+    const double lambda = chain.MaxExitRate;
+    const double mean = lambda * dt;
+
+    for (Ui32 substep = 0; substep < substeps; ++substep) {
+        term = distribution;
+        double weight = std::exp(-mean);
+        double accumulated = weight;
+        for (double& p : distribution) {
+            p *= weight;
+        }
+        for (Ui32 k = 1; 1.0 - accumulated > kPoissonTailEpsilon && weight > 0; ++k) {
+            // term <- term * P, P = I + Q / lambda.
+            for (size_t state = 0; state < term.size(); ++state) {
+                next[state] = term[state] * (1.0 - chain.ExitRate[state] / lambda);
+            }
+            for (const TTransition& transition : chain.Transitions) {
+                next[transition.To] += term[transition.From] * transition.Rate / lambda;
+            }
+            term.swap(next);
+            weight *= mean / k;
+            accumulated += weight;
+            for (size_t state = 0; state < term.size(); ++state) {
+                distribution[state] += weight * term[state];
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool EstimateLossMarkov(const TSimulationParams& params, TMarkovEstimate& estimate) {
+    if (params.HazardModel != kHazardConstant) {
+        LOG_WARNING("Markov estimate supports only the constant failure rate model");
+        return false;
+    }
+    if (params.NumDCs == 0 || params.VDisksPerPDisk == 0) {
+        return false;
+    }
+    const TErasureSchemeInfo& scheme = GetErasureScheme(params.ErasureScheme);
+    const Ui32 pdisksPerDc = params.DisksPerDc + params.SpareDisksPerDc;
+    const double pdisks = static_cast<double>(params.NumDCs) * pdisksPerDc;
+
+    // Все PDisk'и, включая запасные, несут VDisk'и групп и выбираются для отказа равновероятно.
+    const double failureRate = pdisks > 0 ? params.FailureRate / 24.0 / pdisks : 0.0;
+    const double replicationHours = params.WriteSpeed > 0
+        ? params.DiskSize * 1024.0 / params.WriteSpeed / 3600.0
+        : std::numeric_limits<double>::infinity();
+    const double phaseRate = std::isfinite(replicationHours) && replicationHours > 0 ? kRepairPhases / replicationHours : 0.0;
+
+    // Слоты запасных PDisk'ов DC расходуются на каждый отказавший VDisk и возвращаются
+    // восстановленными PDisk'ами через PDiskRecoveryTimeHours. Если запаса не хватает
+    // на время восстановления, с момента его исчерпания отказавшие VDisk'и не восстанавливаются.
+    const double spareSlots = static_cast<double>(params.SpareDisksPerDc) * params.VDisksPerPDisk;
+    const double slotUsePerHour = failureRate * pdisksPerDc * params.VDisksPerPDisk;
+    double sparesExhaustedAt = std::numeric_limits<double>::infinity();
+    if (slotUsePerHour > 0 && spareSlots < slotUsePerHour * params.PDiskRecoveryTimeHours) {
+        sparesExhaustedAt = spareSlots / slotUsePerHour;
+    }
+
+    const TGroupChain groupChain(scheme);
+    const TChain withRepair = groupChain.Build(failureRate, phaseRate);
+    const TChain withoutRepair = groupChain.Build(failureRate, 0.0);
+
+    estimate.StateCount = groupChain.GetStateCount();
+    estimate.GroupCount = static_cast<Ui32>(pdisks * params.VDisksPerPDisk / scheme.GetGroupSize());
+    // Simulation раскладывает VDisk'и одного PDisk'а по группам на одном и том же наборе
+    // PDisk'ов, и такие группы отказывают одновременно. Независимы только наборы.
+    estimate.IndependentSets = std::max<Ui32>(1, estimate.GroupCount / params.VDisksPerPDisk);
+    estimate.StepHours = std::max<Ui32>(1, (params.HorizonHours + kMaxCurvePoints - 1) / kMaxCurvePoints);
+    const Ui32 points = params.HorizonHours / estimate.StepHours + 1;
+    estimate.LossProbability.assign(points, 0.0);
+
+    std::vector<double> distribution(estimate.StateCount, 0.0);
+    std::vector<double> term(estimate.StateCount);
+    std::vector<double> next(estimate.StateCount);
+    distribution[0] = 1.0;
+    const Ui32 lossState = groupChain.GetLossState();
+
+    for (Ui32 point = 1; point < points; ++point) {
+        const double begin = (point - 1) * static_cast<double>(estimate.StepHours);
+        const double end = point * static_cast<double>(estimate.StepHours);
+        const double switchTime = std::clamp(sparesExhaustedAt, begin, end);
+        Advance(withRepair, switchTime - begin, distribution, term, next);
+        Advance(withoutRepair, end - switchTime, distribution, term, next);
+
+        // Потеря хотя бы в одном из независимых наборов групп.
+        const double groupLoss = std::clamp(distribution[lossState], 0.0, 1.0);
+        estimate.LossProbability[point] = -std::expm1(estimate.IndependentSets * std::log1p(-groupLoss));
+    }
+    return true;
+}
+
+} // namespace arctic
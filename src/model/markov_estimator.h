@@ -0,0 +1,30 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <vector>
+#include "simulation_params.h"
+
+namespace arctic {
+
+// Аналитическая оценка вероятности потери по марковской цепи с непрерывным
+// временем над числом отказавших VDisk'ов в каждом DC одной группы.
+// VDisk отказывает вместе со своим PDisk'ом с интенсивностью FailureRate / 24
+// на все PDisk'и кластера и восстанавливается репликацией за DiskSize / WriteSpeed.
+// Когда слоты на запасных PDisk'ах DC кончаются, репликации не начинаются.
+// Параллельные репликации на один PDisk в Simulation делят его полосу и идут
+// дольше, а цепь считает каждую идущей на полной скорости, поэтому оценка -
+// нижняя граница, точная, пока запасных PDisk'ов много. Аварии доменов и сеть DC
+// не учитываются.
+struct TMarkovEstimate {
+    // LossProbability[i] - вероятность потери хотя бы одной группы к часу i * StepHours.
+    std::vector<double> LossProbability;
+    Ui32 StepHours = 1;
+    Ui32 StateCount = 0;
+    Ui32 GroupCount = 0;
+    // Число наборов PDisk'ов, по которым разложены группы; группы одного набора отказывают вместе.
+    Ui32 IndependentSets = 0;
+};
+
+// Для модели отказов по возрасту цепь не строится, и возвращается false.
+bool EstimateLossMarkov(const TSimulationParams& params, TMarkovEstimate& estimate);
+
+} // namespace arctic
@@ -5,18 +5,13 @@
 
 namespace arctic {
 
-extern Ui32 GVDisksPerPDisk;
-
-TPDisk::TPDisk(TPDiskId id, TDCId dcId, DiskState initialState)
-    : Id(id), DCId(dcId), State(initialState) {
-    AvailableVDiskSlots = GVDisksPerPDisk;
+TPDisk::TPDisk(TPDiskId id, TDCId dcId, DiskState initialState, Ui32 vdiskSlots)
+    : Id(id), DCId(dcId), VDiskSlots(vdiskSlots), AvailableVDiskSlots(vdiskSlots), State(initialState) {
 }
 
 void TPDisk::AddVDisk(std::shared_ptr<TVDisk> vdisk) {
     if (vdisk) {
-        VDisks[vdisk->GetId()] = vdisk;
-    } else {
-
+        VDisks.push_back(std::move(vdisk));
     }
 }
 
@@ -52,14 +47,10 @@ void TPDisk::DecrementAvailableVDiskSlots() {
 }
 
 void TPDisk::Fail(double currentTime) {
-    if (State != Broken) {
-        // LOG_DEBUG("PDisk Failing: ID=" + Id.ToString() + ", Current State=" + std::to_string(State) + " at Time=" + std::to_string(currentTime));
-        State = Broken;
-        BrokenTime = currentTime;
-        AvailableVDiskSlots = 0;
-
-        for (auto& [vdiskId, vdiskPtr] : VDisks) {
-            if (vdiskPtr && vdiskPtr->GetState() != TVDisk::Faulty) {
+    if (MarkBroken(currentTime)) {
+        // LOG_DEBUG("PDisk Failing: ID=" + Id.ToString() + " at Time=" + std::to_string(currentTime));
+        for (auto& vdiskPtr : VDisks) {
+            if (vdiskPtr->GetState() != TVDisk::Faulty) {
                 vdiskPtr->SetState(TVDisk::Faulty);
                  // LOG_DEBUG("  VDisk marked Faulty: ID=" + vdiskId.ToString());
             }
@@ -69,6 +60,16 @@ void TPDisk::Fail(double currentTime) {
     }
 }
 
+bool TPDisk::MarkBroken(double currentTime) {
+    if (State == Broken) {
+        return false;
+    }
+    State = Broken;
+    BrokenTime = currentTime;
+    AvailableVDiskSlots = 0;
+    return true;
+}
+
 double TPDisk::GetBrokenTime() const {
     return BrokenTime;
 }
@@ -76,7 +77,7 @@ double TPDisk::GetBrokenTime() const {
 void TPDisk::Recover() {
     if (State == Broken) {
         State = Spare;
-        AvailableVDiskSlots = GVDisksPerPDisk;
+        AvailableVDiskSlots = VDiskSlots;
         BrokenTime = 0.0;
         // LOG_DEBUG("PDisk Recovered as Spare: ID=" + Id.ToString());
     } else {
@@ -84,4 +85,10 @@ void TPDisk::Recover() {
     }
 }
 
+void TPDisk::Reset(DiskState initialState) {
+    State = initialState;
+    AvailableVDiskSlots = VDiskSlots;
+    BrokenTime = 0.0;
+}
+
 } 
\ No newline at end of file
@@ -3,8 +3,8 @@
 #include "vdisk.h"
 #include "group.h"
 #include "id_wrapper.h"
-#include <unordered_map>
 #include <memory>
+#include <vector>
 
 namespace arctic {
 
@@ -20,7 +20,8 @@ public:
         Spare
     };
 
-    TPDisk(TPDiskId id, TDCId dcId, DiskState initialState = DiskState::Active);
+    // vdiskSlots - сколько VDisk'ов помещается на диск, когда он становится запасным.
+    TPDisk(TPDiskId id, TDCId dcId, DiskState initialState, Ui32 vdiskSlots);
     void AddVDisk(std::shared_ptr<TVDisk> vdisk);
     void SetState(DiskState state);
     DiskState GetState() const;
@@ -29,13 +30,18 @@ public:
     int GetAvailableVDiskSlots() const { return AvailableVDiskSlots; }
     void DecrementAvailableVDiskSlots();
     void Fail(double currentTime);
+    // Fail без пометки VDisk'ов, их помечает вызывающий. false, если диск уже сломан.
+    bool MarkBroken(double currentTime);
     double GetBrokenTime() const;
     void Recover();
+    // Возврат к начальному состоянию прогона без пересоздания диска и его VDisk'ов.
+    void Reset(DiskState initialState);
 
 private:
     TPDiskId Id;
     TDCId DCId;
-    std::unordered_map<TVDiskId, std::shared_ptr<TVDisk>> VDisks;
+    std::vector<std::shared_ptr<TVDisk>> VDisks;
+    int VDiskSlots = 9;
     int AvailableVDiskSlots = 9;
     DiskState State = Active;
     double BrokenTime = 0.0;
@@ -0,0 +1,153 @@
+#include "random_stream.h"
+#include <algorithm>
+#include <limits>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ARCTIC_RANDOM_AVX2 1
+#endif
+
+namespace arctic {
+
+namespace {
+
+constexpr size_t kLanes = 4;
+using TState = std::array<std::array<Ui64, kLanes>, 4>;
+
+inline Ui64 Rotl(Ui64 x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+Ui64 SplitMix64(Ui64& state) {
+    Ui64 z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Шаг xoshiro256** во всех дорожках; out[step * kLanes + lane].
+void RefillScalar(TState& s, Ui64* out, size_t steps) {
+    for (size_t step = 0; step < steps; ++step) {
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            out[step * kLanes + lane] = Rotl(s[1][lane] * 5, 7) * 9;
+            const Ui64 t = s[1][lane] << 17;
+            s[2][lane] ^= s[0][lane];
+            s[3][lane] ^= s[1][lane];
+            s[1][lane] ^= s[2][lane];
+            s[0][lane] ^= s[3][lane];
+            s[2][lane] ^= t;
+            s[3][lane] = Rotl(s[3][lane], 45);
+        }
+    }
+}
+
+#ifdef ARCTIC_RANDOM_AVX2
+
+template <int K>
+__attribute__((target("avx2"))) inline __m256i RotlAvx2(__m256i x) {
+    return _mm256_or_si256(_mm256_slli_epi64(x, K), _mm256_srli_epi64(x, 64 - K));
+}
+
+// То же, что RefillScalar: умножения на 5 и 9 - сдвиг и сложение, 64-битного умножения в AVX2 нет.
+__attribute__((target("avx2"))) void RefillAvx2(TState& state, Ui64* out, size_t steps) {
+    __m256i s0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[0].data()));
+    __m256i s1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[1].data()));
+    __m256i s2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[2].data()));
+    __m256i s3 = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[3].data()));
+    for (size_t step = 0; step < steps; ++step) {
+        const __m256i times5 = _mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2));
+        const __m256i rotated = RotlAvx2<7>(times5);
+        const __m256i result = _mm256_add_epi64(rotated, _mm256_slli_epi64(rotated, 3));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(out + step * kLanes), result);
+        const __m256i t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = RotlAvx2<45>(s3);
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(state[0].data()), s0);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(state[1].data()), s1);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(state[2].data()), s2);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(state[3].data()), s3);
+}
+
+#endif
+
+} // namespace
+
+bool TRandomStream::UsesAvx2() {
+#ifdef ARCTIC_RANDOM_AVX2
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+#else
+    return false;
+#endif
+}
+
+void TRandomStream::Seed(Ui64 seed) {
+    // Состояния дорожек - последовательные выходы splitmix64, как советуют авторы xoshiro.
+    Ui64 mix = seed;
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        for (size_t word = 0; word < 4; ++word) {
+            State[word][lane] = SplitMix64(mix);
+        }
+    }
+    Pos = kBufferWords;
+}
+
+void TRandomStream::Refill() {
+#ifdef ARCTIC_RANDOM_AVX2
+    if (UsesAvx2()) {
+        RefillAvx2(State, Buffer.data(), kBufferWords / kLanes);
+        Pos = 0;
+        return;
+    }
+#endif
+    RefillScalar(State, Buffer.data(), kBufferWords / kLanes);
+    Pos = 0;
+}
+
+Ui32 TRandomStream::NextBounded(Ui32 range) {
+    // Старшие 32 бита x * range - результат; младшие ниже порога 2^32 mod range
+    // отбрасываются, чтобы все значения были равновероятны.
+    Ui64 product = ((*this)() >> 32) * range;
+    Ui32 low = static_cast<Ui32>(product);
+    if (low < range) {
+        const Ui32 threshold = static_cast<Ui32>(-range) % range;
+        while (low < threshold) {
+            product = ((*this)() >> 32) * range;
+            low = static_cast<Ui32>(product);
+        }
+    }
+    return static_cast<Ui32>(product >> 32);
+}
+
+Ui64 TRandomStream::NextGeometric(double p) {
+    if (p >= 1.0) {
+        return 0;
+    }
+    // Обращение функции распределения: floor(ln U / ln(1 - p)), U из (0, 1].
+    const double failures = std::floor(std::log1p(-NextUniform()) / std::log1p(-p));
+    return failures < static_cast<double>(std::numeric_limits<Ui64>::max())
+        ? static_cast<Ui64>(failures)
+        : std::numeric_limits<Ui64>::max();
+}
+
+void TRandomStream::FillExponential(double* out, size_t count) {
+    while (count > 0) {
+        if (Pos == kBufferWords) {
+            Refill();
+        }
+        const size_t chunk = std::min(count, kBufferWords - Pos);
+        const Ui64* words = Buffer.data() + Pos;
+        for (size_t i = 0; i < chunk; ++i) {
+            out[i] = -std::log1p(-static_cast<double>(words[i] >> 11) * 0x1.0p-53);
+        }
+        Pos += chunk;
+        out += chunk;
+        count -= chunk;
+    }
+}
+
+} // namespace arctic
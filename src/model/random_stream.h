@@ -0,0 +1,56 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace arctic {
+
+// Случайные числа прогона. Четыре независимых генератора xoshiro256** идут в
+// дорожках AVX2 (или в скалярном цикле с тем же результатом, если AVX2 нет) и
+// пачкой заполняют буфер, из которого берутся равномерные, ограниченные целые
+// (метод Лемира) и экспоненциальные величины. Последовательность зависит только
+// от seed'а: ни от процессора, ни от реализации стандартной библиотеки.
+// Удовлетворяет UniformRandomBitGenerator.
+class TRandomStream {
+public:
+    using result_type = Ui64;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~Ui64(0); }
+
+    explicit TRandomStream(Ui64 seed = 0) { Seed(seed); }
+    // Новая последовательность без выделений памяти, буфер переиспользуется.
+    void Seed(Ui64 seed);
+
+    Ui64 operator()() {
+        if (Pos == kBufferWords) {
+            Refill();
+        }
+        return Buffer[Pos++];
+    }
+    // [0, 1) с шагом 2^-53.
+    double NextUniform() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+    // Равномерно на [0, range), range > 0, без смещения.
+    Ui32 NextBounded(Ui32 range);
+    double NextExponential() { return -std::log1p(-NextUniform()); }
+    // Число неудач до первого успеха при вероятности успеха p из (0, 1].
+    Ui64 NextGeometric(double p);
+    // Те же значения, что count вызовов NextExponential, но циклом по буферу.
+    void FillExponential(double* out, size_t count);
+
+    // Идёт ли пополнение буфера через AVX2 на этом процессоре.
+    static bool UsesAvx2();
+
+private:
+    static constexpr size_t kLanes = 4;
+    static constexpr size_t kBufferWords = 256;
+
+    void Refill();
+
+    // State[k][lane] - k-е слово состояния генератора дорожки lane.
+    alignas(32) std::array<std::array<Ui64, kLanes>, 4> State = {};
+    alignas(32) std::array<Ui64, kBufferWords> Buffer = {};
+    size_t Pos = kBufferWords;
+};
+
+} // namespace arctic
@@ -0,0 +1,85 @@
+#include "rate_reweighting.h"
+#include "failure_model.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace arctic {
+
+double TReweightedLoss::GetLossProbability(Ui64 hours) const {
+    auto it = std::upper_bound(Points.begin(), Points.end(), hours,
+                               [](Ui64 value, const TPoint& point) { return value < point.Hour; });
+    return it == Points.begin() ? 0.0 : std::prev(it)->Probability;
+}
+
+bool ReweightFailureRate(const TSimulationStats& stats, const TSimulationParams& base, Ui32 failureRate,
+                         TReweightedLoss& out) {
+    out.Points.clear();
+    out.FailureRate = failureRate;
+    out.Runs = stats.RunSummaries.Size();
+    out.EffectiveSampleSize = 0.0;
+    if (base.HazardModel != kHazardConstant || stats.RunSummaries.Empty()) {
+        return false;
+    }
+    const double rate = base.FailureRate / 24.0;
+    const double newRate = failureRate / 24.0;
+    if (std::floor(rate) != std::floor(newRate)) {
+        return false;
+    }
+    const double p = rate - std::floor(rate);
+    const double newP = newRate - std::floor(newRate);
+    if ((p == 0.0) != (newP == 0.0)) {
+        return false;
+    }
+    const double logFailure = p > 0 ? std::log(newP / p) : 0.0;
+    const double logNoFailure = std::log1p(-newP) - std::log1p(-p);
+
+    // Веса считаются от наибольшего логарифма, чтобы exp не переполнялся.
+    std::vector<double> logWeights;
+    logWeights.reserve(stats.RunSummaries.Size());
+    double maxLogWeight = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < stats.RunSummaries.Size(); ++i) {
+        const TRunSummary& summary = stats.RunSummaries[i];
+        const double failures = summary.ExtraFailureHours;
+        const double quietHours = static_cast<double>(summary.HoursSimulated) - failures;
+        logWeights.push_back(failures * logFailure + quietHours * logNoFailure);
+        maxLogWeight = std::max(maxLogWeight, logWeights.back());
+    }
+
+    double weightSum = 0.0;
+    double squareSum = 0.0;
+    std::vector<std::pair<Si64, double>> losses;
+    for (size_t i = 0; i < logWeights.size(); ++i) {
+        const double weight = std::exp(logWeights[i] - maxLogWeight);
+        weightSum += weight;
+        squareSum += weight * weight;
+        if (stats.RunSummaries[i].LossHour >= 0) {
+            losses.emplace_back(stats.RunSummaries[i].LossHour, weight);
+        }
+    }
+    out.EffectiveSampleSize = weightSum * weightSum / squareSum;
+    std::sort(losses.begin(), losses.end());
+
+    // Самонормированная оценка sum_{L <= t} w / sum w и её дисперсия
+    // sum w^2 (1[L <= t] - P)^2 / (sum w)^2, разложенная по прогонам с потерей и без.
+    double lossWeight = 0.0;
+    double lossSquares = 0.0;
+    for (size_t i = 0; i < losses.size(); ++i) {
+        lossWeight += losses[i].second;
+        lossSquares += losses[i].second * losses[i].second;
+        if (i + 1 < losses.size() && losses[i + 1].first == losses[i].first) {
+            continue;
+        }
+        TReweightedLoss::TPoint point;
+        point.Hour = static_cast<Ui64>(losses[i].first);
+        point.Probability = lossWeight / weightSum;
+        const double q = point.Probability;
+        const double variance = (lossSquares * (1.0 - q) * (1.0 - q) + (squareSum - lossSquares) * q * q) /
+                                (weightSum * weightSum);
+        point.StdError = std::sqrt(std::max(variance, 0.0));
+        out.Points.push_back(point);
+    }
+    return true;
+}
+
+} // namespace arctic
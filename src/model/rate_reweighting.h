@@ -0,0 +1,37 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <vector>
+#include "simulation_params.h"
+#include "simulation_stats.h"
+
+namespace arctic {
+
+// Оценка для другой постоянной интенсивности отказов по уже посчитанным прогонам.
+// Интенсивность влияет только на то, в какие часы разыгран отказ сверх floor(r):
+// выбор PDisk'а, аварии доменов и всё остальное от неё не зависят. Поэтому
+// отношение правдоподобий прогона - (p' / p)^K ((1 - p') / (1 - p))^(T - K),
+// где p, p' - дробные части r / 24, K - часы с таким отказом из T просчитанных.
+// Прогон останавливается на потере, и событие "потеря не позже t" определено
+// к этому моменту, так что веса по просчитанной части прогона достаточно.
+struct TReweightedLoss {
+    struct TPoint {
+        Ui64 Hour = 0;
+        double Probability = 0.0;
+        double StdError = 0.0;
+    };
+    // P(потеря не позже Hour) в часы потерь прогонов, по возрастанию.
+    std::vector<TPoint> Points;
+    Ui32 FailureRate = 0;
+    Ui64 Runs = 0;
+    // (sum w)^2 / sum w^2: сколько независимых прогонов стоит взвешенная выборка.
+    double EffectiveSampleSize = 0.0;
+
+    double GetLossProbability(Ui64 hours) const;
+};
+
+// false, если пересчёт невозможен: модель отказов не постоянная, нет сводок или
+// floor(r) у интенсивностей разный, и носители распределений не пересекаются.
+bool ReweightFailureRate(const TSimulationStats& stats, const TSimulationParams& base, Ui32 failureRate,
+                         TReweightedLoss& out);
+
+} // namespace arctic
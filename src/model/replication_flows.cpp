@@ -0,0 +1,144 @@
+#include "replication_flows.h"
+#include <algorithm>
+#include <limits>
+
+namespace arctic {
+
+namespace {
+
+const double kSecondsPerHour = 3600.0;
+const Ui64 kFreeFlowVersion = 0;
+const Ui32 kNoFlow = std::numeric_limits<Ui32>::max();
+
+} // namespace
+
+void TReplicationScheduler::Reset(Ui32 pdiskCount, Ui32 dcCount, double pdiskSpeed, double dcSpeed, Ui32 flowsPerPDisk) {
+    PDiskSpeed = pdiskSpeed;
+    DcSpeed = dcSpeed;
+    const size_t maxFlows = static_cast<size_t>(pdiskCount) * flowsPerPDisk;
+    Flows.clear();
+    Flows.reserve(maxFlows);
+    FreeFlows.clear();
+    FreeFlows.reserve(maxFlows);
+    std::fill(FlowByVDisk.begin(), FlowByVDisk.end(), kNoFlow);
+    FlowsByPDisk.resize(pdiskCount);
+    for (auto& flows : FlowsByPDisk) {
+        flows.clear();
+        // Восстановленный посреди репликаций PDisk снова получает все слоты, пока старые потоки ещё идут.
+        flows.reserve(2 * flowsPerPDisk);
+    }
+    FlowsByDC.resize(dcCount);
+    for (auto& flows : FlowsByDC) {
+        flows.clear();
+        flows.reserve(dcCount ? maxFlows / dcCount : 0);
+    }
+    Completions.Clear();
+    Completions.Reserve(maxFlows);
+    LastVersion = 0;
+}
+
+double TReplicationScheduler::GetRate(const TFlow& flow) const {
+    double rate = PDiskSpeed / FlowsByPDisk[flow.PDisk].size();
+    if (DcSpeed > 0) {
+        rate = std::min(rate, DcSpeed / FlowsByDC[flow.DC].size());
+    }
+    return rate * kSecondsPerHour;
+}
+
+void TReplicationScheduler::UpdateRates(const std::vector<Ui32>& flows, double now) {
+    for (Ui32 flowIndex : flows) {
+        TFlow& flow = Flows[flowIndex];
+        const double rate = GetRate(flow);
+        if (rate == flow.RateMBPerHour) {
+            continue;
+        }
+        flow.RemainingMB = std::max(0.0, flow.RemainingMB - flow.RateMBPerHour * (now - flow.LastUpdate));
+        flow.LastUpdate = now;
+        flow.RateMBPerHour = rate;
+        flow.Version = ++LastVersion;
+        flow.CompleteTime = rate > 0 ? now + flow.RemainingMB / rate : std::numeric_limits<double>::infinity();
+        if (rate > 0) {
+            Completions.push({flow.CompleteTime, flowIndex, flow.Version});
+        }
+    }
+}
+
+double TReplicationScheduler::StartFlow(Ui32 vdiskIndex, Ui32 targetPDisk, Ui32 dc, double sizeMB, double now) {
+    Ui32 flowIndex;
+    if (!FreeFlows.empty()) {
+        flowIndex = FreeFlows.back();
+        FreeFlows.pop_back();
+    } else {
+        flowIndex = Flows.size();
+        Flows.emplace_back();
+    }
+    TFlow& flow = Flows[flowIndex];
+    flow = TFlow();
+    flow.VDisk = vdiskIndex;
+    flow.PDisk = targetPDisk;
+    flow.DC = dc;
+    flow.RemainingMB = sizeMB;
+    flow.LastUpdate = now;
+    flow.PosInPDisk = FlowsByPDisk[targetPDisk].size();
+    FlowsByPDisk[targetPDisk].push_back(flowIndex);
+    flow.PosInDC = FlowsByDC[dc].size();
+    FlowsByDC[dc].push_back(flowIndex);
+    if (vdiskIndex >= FlowByVDisk.size()) {
+        FlowByVDisk.resize(vdiskIndex + 1, kNoFlow);
+    }
+    FlowByVDisk[vdiskIndex] = flowIndex;
+
+    // Все потоки на целевом PDisk'е лежат в его DC, так что при ограниченной
+    // сети достаточно пересчитать DC, иначе - только PDisk.
+    UpdateRates(DcSpeed > 0 ? FlowsByDC[dc] : FlowsByPDisk[targetPDisk], now);
+    return Flows[flowIndex].CompleteTime;
+}
+
+void TReplicationScheduler::RemoveFlow(Ui32 flowIndex) {
+    TFlow& flow = Flows[flowIndex];
+    auto removeFrom = [&](std::vector<Ui32>& list, Ui32 pos, Ui32 TFlow::*posField) {
+        const Ui32 moved = list.back();
+        list[pos] = moved;
+        Flows[moved].*posField = pos;
+        list.pop_back();
+    };
+    removeFrom(FlowsByPDisk[flow.PDisk], flow.PosInPDisk, &TFlow::PosInPDisk);
+    removeFrom(FlowsByDC[flow.DC], flow.PosInDC, &TFlow::PosInDC);
+    FlowByVDisk[flow.VDisk] = kNoFlow;
+    flow.Version = kFreeFlowVersion;
+    FreeFlows.push_back(flowIndex);
+}
+
+bool TReplicationScheduler::PopCompleted(double until, Ui32& vdiskIndex, double& completeTime) {
+    while (!Completions.empty() && Completions.top().Time <= until) {
+        const TCompletion completion = Completions.top();
+        Completions.pop();
+        const TFlow& flow = Flows[completion.Flow];
+        if (flow.Version != completion.Version) {
+            continue;
+        }
+        vdiskIndex = flow.VDisk;
+        completeTime = completion.Time;
+        const Ui32 pdisk = flow.PDisk;
+        const Ui32 dc = flow.DC;
+        RemoveFlow(completion.Flow);
+        UpdateRates(DcSpeed > 0 ? FlowsByDC[dc] : FlowsByPDisk[pdisk], completeTime);
+        return true;
+    }
+    return false;
+}
+
+bool TReplicationScheduler::CancelFlow(Ui32 vdiskIndex, double now) {
+    if (vdiskIndex >= FlowByVDisk.size() || FlowByVDisk[vdiskIndex] == kNoFlow) {
+        return false;
+    }
+    const Ui32 flowIndex = FlowByVDisk[vdiskIndex];
+    const Ui32 pdisk = Flows[flowIndex].PDisk;
+    const Ui32 dc = Flows[flowIndex].DC;
+    // Запись в куче остаётся и отбрасывается по версии.
+    RemoveFlow(flowIndex);
+    UpdateRates(DcSpeed > 0 ? FlowsByDC[dc] : FlowsByPDisk[pdisk], now);
+    return true;
+}
+
+} // namespace arctic
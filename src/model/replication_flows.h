@@ -0,0 +1,66 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <functional>
+#include <vector>
+#include "../utils/reusable_heap.h"
+
+namespace arctic {
+
+// Репликации как потоки, делящие полосу записи целевого PDisk'а и, если
+// задано, сетевую полосу DC. Скорость потока - минимум из равных долей на
+// его ресурсах. При старте и завершении потока пересчитываются только потоки
+// на тех же ресурсах, а время завершения каждого лежит в куче с ленивым удалением.
+class TReplicationScheduler {
+public:
+    // Скорости в MB/s, dcSpeed = 0 - сеть DC не ограничена. Память прошлого прогона
+    // переиспользуется, а flowsPerPDisk (обычно число слотов PDisk'а) задаёт, сколько
+    // потоков зарезервировать на каждый PDisk, чтобы прогоны не выделяли память.
+    void Reset(Ui32 pdiskCount, Ui32 dcCount, double pdiskSpeed, double dcSpeed, Ui32 flowsPerPDisk = 0);
+    // Время - в часах симуляции. Возвращает оценку завершения при текущих скоростях.
+    double StartFlow(Ui32 vdiskIndex, Ui32 targetPDisk, Ui32 dc, double sizeMB, double now);
+    // Достаёт очередной поток, завершившийся не позже until, в порядке времени завершения.
+    bool PopCompleted(double until, Ui32& vdiskIndex, double& completeTime);
+    // Снимает незавершённый поток VDisk'а (его источник снова отказал), полоса отходит
+    // остальным потокам. false, если потока нет.
+    bool CancelFlow(Ui32 vdiskIndex, double now);
+    size_t GetActiveFlowCount() const { return Flows.size() - FreeFlows.size(); }
+
+private:
+    struct TFlow {
+        Ui32 VDisk = 0;
+        Ui32 PDisk = 0;
+        Ui32 DC = 0;
+        Ui32 PosInPDisk = 0;
+        Ui32 PosInDC = 0;
+        Ui64 Version = 0;
+        double RemainingMB = 0;
+        double RateMBPerHour = 0;
+        double LastUpdate = 0;
+        double CompleteTime = 0;
+    };
+
+    struct TCompletion {
+        double Time;
+        Ui32 Flow;
+        Ui64 Version;
+        bool operator>(const TCompletion& other) const { return Time > other.Time; }
+    };
+
+    double GetRate(const TFlow& flow) const;
+    void UpdateRates(const std::vector<Ui32>& flows, double now);
+    void RemoveFlow(Ui32 flowIndex);
+
+    // Версии сквозные, чтобы устаревшие записи кучи не совпали с переиспользованным потоком.
+    Ui64 LastVersion = 0;
+    double PDiskSpeed = 0;
+    double DcSpeed = 0;
+    std::vector<TFlow> Flows;
+    std::vector<Ui32> FreeFlows;
+    // Поток каждого VDisk'а или kNoFlow; растёт по мере надобности и переживает Reset.
+    std::vector<Ui32> FlowByVDisk;
+    std::vector<std::vector<Ui32>> FlowsByPDisk;
+    std::vector<std::vector<Ui32>> FlowsByDC;
+    TReusableHeap<TCompletion, std::greater<TCompletion>> Completions;
+};
+
+} // namespace arctic
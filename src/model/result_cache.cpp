@@ -0,0 +1,98 @@
+#include "result_cache.h"
+#include "varint.h"
+#include <cstdio>
+
+namespace arctic {
+
+Ui64 MakeResultCacheKey(const TCheckpoint& estimate) {
+    std::vector<Ui8> bytes;
+    estimate.Params.Serialize(bytes);
+    WriteVarint(bytes, estimate.ControlCalibrationRuns);
+    WriteVarint(bytes, estimate.StratifiedSampling ? 1 : 0);
+    return Fnv1a(bytes.data(), bytes.size());
+}
+
+TResultCache& TResultCache::Instance() {
+    static TResultCache cache;
+    return cache;
+}
+
+bool TResultCache::Get(const TSimulationConfig& config, TCheckpoint& entry) {
+    return Find(TCheckpoint::ForConfig(config), entry);
+}
+
+bool TResultCache::Find(const TCheckpoint& estimate, TCheckpoint& entry) {
+    const Ui64 key = MakeResultCacheKey(estimate);
+    std::lock_guard<std::mutex> lock(Mutex);
+    auto it = ByKey.find(key);
+    if (it != ByKey.end() && it->second->Checkpoint.IsSameEstimate(estimate)) {
+        Entries.splice(Entries.begin(), Entries, it->second);
+        entry = Entries.front().Checkpoint;
+        return true;
+    }
+    if (GResultCacheDir.empty()) {
+        return false;
+    }
+    TCheckpoint loaded;
+    if (!LoadCheckpoint(GetPath(key), loaded) || !loaded.IsSameEstimate(estimate)) {
+        return false;
+    }
+    InsertLocked(key, loaded);
+    entry = std::move(loaded);
+    return true;
+}
+
+void TResultCache::Put(const TCheckpoint& entry) {
+    if (entry.NextSimIndex == 0) {
+        return;
+    }
+    // Запись на диске может быть полнее вытесненной из памяти, поэтому сравниваем и с ней.
+    TCheckpoint existing;
+    if (Find(entry, existing) && existing.NextSimIndex >= entry.NextSimIndex) {
+        return;
+    }
+    const Ui64 key = MakeResultCacheKey(entry);
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        InsertLocked(key, entry);
+    }
+    if (!GResultCacheDir.empty()) {
+        SaveCheckpoint(GetPath(key), entry);
+    }
+}
+
+void TResultCache::Clear() {
+    std::lock_guard<std::mutex> lock(Mutex);
+    Entries.clear();
+    ByKey.clear();
+}
+
+size_t TResultCache::Size() {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Entries.size();
+}
+
+std::string TResultCache::GetPath(Ui64 key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.dfck", static_cast<unsigned long long>(key));
+    return GResultCacheDir + "/" + name;
+}
+
+void TResultCache::InsertLocked(Ui64 key, const TCheckpoint& checkpoint) {
+    auto it = ByKey.find(key);
+    if (it != ByKey.end()) {
+        Entries.erase(it->second);
+        ByKey.erase(it);
+    }
+    if (GResultCacheEntries == 0) {
+        return;
+    }
+    Entries.push_front({key, checkpoint});
+    ByKey[key] = Entries.begin();
+    while (Entries.size() > GResultCacheEntries) {
+        ByKey.erase(Entries.back().Key);
+        Entries.pop_back();
+    }
+}
+
+} // namespace arctic
@@ -0,0 +1,47 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "checkpoint.h"
+
+namespace arctic {
+
+// Ключ кэша: FNV-1a от канонической сериализации параметров и настроек оценки
+// (контрольная переменная, стратификация) записи, от которых зависит содержимое статистики.
+Ui64 MakeResultCacheKey(const TCheckpoint& estimate);
+
+// Накопленные оценки по наборам параметров, общие для интерфейса и пакетных оценок.
+// В памяти держится GResultCacheEntries последних по использованию записей; если
+// задан GResultCacheDir, записи дублируются туда файлами чекпоинтов по ключу и
+// переживают перезапуск. Запись продолжается с NextSimIndex в потоке BaseSeed.
+class TResultCache {
+public:
+    static TResultCache& Instance();
+
+    // Копия записи для параметров и настроек оценки config: из памяти, а если её там нет - с диска.
+    bool Get(const TSimulationConfig& config, TCheckpoint& entry);
+    // Запоминает entry, если в кэше нет записи той же оценки с большим числом прогонов.
+    void Put(const TCheckpoint& entry);
+    // Очищает память, файлы на диске остаются.
+    void Clear();
+    size_t Size();
+
+private:
+    struct TEntry {
+        Ui64 Key = 0;
+        TCheckpoint Checkpoint;
+    };
+
+    bool Find(const TCheckpoint& estimate, TCheckpoint& entry);
+    std::string GetPath(Ui64 key) const;
+    void InsertLocked(Ui64 key, const TCheckpoint& checkpoint);
+
+    std::mutex Mutex;
+    // От недавно использованных к давно использованным.
+    std::list<TEntry> Entries;
+    std::unordered_map<Ui64, std::list<TEntry>::iterator> ByKey;
+};
+
+} // namespace arctic
@@ -4,150 +4,370 @@
 #include <vector>
 #include <unordered_set>
 #include <algorithm>
+#include <numeric>
 #include "../utils/logger.h"
 #include "group.h"
 #include "vdisk.h"
 #include "pdisk.h"
-#include <random>
+#include "group_loss.h"
+#include <limits>
+#include <type_traits>
 
 namespace arctic {
 
-extern Ui32 GDisksPerDc;
-extern Ui32 GVDisksPerPDisk;
+namespace {
 
-void Simulation::Reset() {
+const Ui32 kNoGroup = std::numeric_limits<Ui32>::max();
+
+} // namespace
+
+Ui64 MakeRunSeed(Ui64 baseSeed, Ui64 simIndex) {
+    // splitmix64: соседние индексы дают несвязанные seed'ы.
+    Ui64 z = baseSeed + (simIndex + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+Simulation::TLayout Simulation::LayoutFromParams(const TSimulationParams& params) {
+    TLayout layout;
+    layout.NumDCs = params.NumDCs;
+    layout.DisksPerDc = params.DisksPerDc;
+    layout.SpareDisksPerDc = params.SpareDisksPerDc;
+    layout.VDisksPerPDisk = params.VDisksPerPDisk;
+    layout.ErasureScheme = params.ErasureScheme;
+    layout.RacksPerDc = params.RacksPerDc;
+    layout.DisksPerHost = params.DisksPerHost;
+    return layout;
+}
+
+void Simulation::Reset(const TSimulationConfig& config) {
+    // Присваивание переиспользует память вектора кусочной модели, так что копия не выделяет.
+    Config = config;
     CurrentTime = 0;
+    ExtraFailureHours = 0;
 
     LostGroupInfo.clear();
+    ActiveOutages.clear();
+    DirtyGroups.clear();
+
+    const TLayout layout = LayoutFromParams(Config.Params);
+    if (HasLayout && layout == Layout) {
+        ResetLayoutInPlace();
+    } else {
+        Layout = layout;
+        HasLayout = true;
+        BuildLayout();
+    }
+    GroupLossCheck = GetGroupLossCheck(Layout.ErasureScheme);
+    SelectKernels();
+
+    PDiskOfflineCount.assign(PDisks.Size(), 0);
+    Replications.Reset(PDisks.Size(), Config.Params.NumDCs, Config.Params.WriteSpeed, Config.Params.DcReplicationSpeed,
+                       Config.Params.VDisksPerPDisk);
+    InitializeFailureSchedule();
+    GroupDirty.Resize(Groups.Size());
+    LostGroups.Resize(Groups.Size());
+}
 
-    PDiskMap.clear();
-    VDiskMap.clear();
-    GroupMap.clear();
+void Simulation::BuildLayout() {
+    PDisks.Clear();
+    VDisks.Clear();
+    Groups.Clear();
 
-    for (int dc = 0; dc < 3; ++dc) {
-        sparePDiskIdsByDC[dc].clear();
-    }
+    PDiskIdsByDC.assign(Layout.NumDCs, {});
+    sparePDiskIdsByDC.assign(Layout.NumDCs, {});
+    Topology.Build(Layout.NumDCs, Config.PDisksPerDc, Layout.RacksPerDc, Layout.DisksPerHost);
 
     InitializePDisks();
     InitializeGroups();
+
+    // В этих списках не бывает больше элементов, чем групп.
+    DirtyGroups.reserve(Groups.Size());
+    LostGroupInfo.reserve(Groups.Size());
 }
 
-void Simulation::InitializePDisks() {
-    Ui32 pdiskIdCounter = 0;
-    Ui32 vdiskIdCounter = 0;
-
-    for (int dcId = 0; dcId < 3; ++dcId) {
-        for (int pdiskIndex = 0; pdiskIndex < GDisksPerDc; ++pdiskIndex) {
-            TPDiskId pdiskId = TPDiskId::FromValue(pdiskIdCounter);
-            PDiskMap[pdiskId] = std::make_shared<TPDisk>(pdiskId, TDCId(dcId), TPDisk::Active);
-            for (int vdiskIndex = 0; vdiskIndex < GVDisksPerPDisk; ++vdiskIndex) {
-                TVDiskId vdiskId = TVDiskId::FromValue(vdiskIdCounter);
-                const auto vdisk = std::make_shared<TVDisk>(vdiskId, pdiskId, TDCId(dcId));
-                VDiskMap[vdiskId] = vdisk;
-                PDiskMap[pdiskId]->AddVDisk(vdisk);
-                vdiskIdCounter++;
-            }
-            pdiskIdCounter++;
-        }
+void Simulation::SelectKernels() {
+    ProcessGroupsKernel = &Simulation::ProcessGroupsImpl<void>;
+    FailVDisksKernel = &Simulation::FailVDisksImpl<0>;
+    if (!Config.SpecializedKernels) {
+        return;
+    }
+    switch (Layout.ErasureScheme) {
+        case kMirror3DcScheme:
+            ProcessGroupsKernel = &Simulation::ProcessGroupsImpl<TMirror3Dc>;
+            break;
+        case kBlock42Scheme:
+            ProcessGroupsKernel = &Simulation::ProcessGroupsImpl<TBlock42>;
+            break;
+        case kMirror3Of4Scheme:
+            ProcessGroupsKernel = &Simulation::ProcessGroupsImpl<TMirror3Of4>;
+            break;
     }
+    switch (Layout.VDisksPerPDisk) {
+        case 8:
+            FailVDisksKernel = &Simulation::FailVDisksImpl<8>;
+            break;
+        case 9:
+            FailVDisksKernel = &Simulation::FailVDisksImpl<9>;
+            break;
+    }
+}
 
-    for (int dcId = 0; dcId < 3; ++dcId) {
-        for (int spareIndex = 0; spareIndex < GSpareDisksPerDc; ++spareIndex) {
-            TPDiskId pdiskId = TPDiskId::FromValue(pdiskIdCounter);
-            PDiskMap[pdiskId] = std::make_shared<TPDisk>(pdiskId, TDCId(dcId), TPDisk::Spare);
-            for (int vdiskIndex = 0; vdiskIndex < GVDisksPerPDisk; ++vdiskIndex) {
-                TVDiskId vdiskId = TVDiskId::FromValue(vdiskIdCounter);
-                const auto vdisk = std::make_shared<TVDisk>(vdiskId, pdiskId, TDCId(dcId));
-                VDiskMap[vdiskId] = vdisk;
-                PDiskMap[pdiskId]->AddVDisk(vdisk);
-                vdiskIdCounter++;
+void Simulation::ResetLayoutInPlace() {
+    const Ui32 pdisksPerDc = Config.PDisksPerDc;
+    for (const auto& pdisk : PDisks) {
+        const bool isSpare = pdisk->GetId().GetRawId() % pdisksPerDc >= Layout.DisksPerDc;
+        pdisk->Reset(isSpare ? TPDisk::Spare : TPDisk::Active);
+    }
+    for (const auto& vdisk : VDisks) {
+        vdisk->Reset();
+    }
+}
+
+void Simulation::InitializePDisks() {
+    VDiskByIndex.clear();
+    const Ui32 pdisksPerDc = Config.PDisksPerDc;
+    PDisks.Reserve(Layout.NumDCs * pdisksPerDc);
+    VDisks.Reserve(Layout.NumDCs * pdisksPerDc * Layout.VDisksPerPDisk);
+
+    // PDisk'и одного DC идут подряд (сначала активные, затем запасные), как того требует TTopology.
+    for (Ui32 dcId = 0; dcId < Layout.NumDCs; ++dcId) {
+        for (Ui32 pdiskIndex = 0; pdiskIndex < pdisksPerDc; ++pdiskIndex) {
+            const bool isSpare = pdiskIndex >= Layout.DisksPerDc;
+            const TPDiskId pdiskId = PDisks.EndId();
+            const auto pdisk = std::make_shared<TPDisk>(pdiskId, TDCId(dcId), isSpare ? TPDisk::Spare : TPDisk::Active,
+                                                       Layout.VDisksPerPDisk);
+            PDisks.PushBack(pdisk);
+            (isSpare ? sparePDiskIdsByDC : PDiskIdsByDC)[dcId].push_back(pdiskId);
+            for (Ui32 vdiskIndex = 0; vdiskIndex < Layout.VDisksPerPDisk; ++vdiskIndex) {
+                const auto vdisk = std::make_shared<TVDisk>(VDisks.EndId(), pdiskId, TDCId(dcId));
+                VDisks.PushBack(vdisk);
+                VDiskByIndex.push_back(vdisk.get());
+                pdisk->AddVDisk(vdisk);
             }
-            pdiskIdCounter++;
         }
     }
 
-    LOG_DEBUG("Initialized " + std::to_string(PDiskMap.size()) + " PDisks (" +
-             std::to_string(GDisksPerDc * 3) + " Active, " +
-             std::to_string(GSpareDisksPerDc * 3) + " Spare) and " +
-             std::to_string(VDiskMap.size()) + " VDisks.");
+    LOG_DEBUG("Initialized " + std::to_string(PDisks.Size()) + " PDisks in " + std::to_string(Layout.NumDCs) + " DCs (" +
+             std::to_string(Layout.DisksPerDc * Layout.NumDCs) + " Active, " +
+             std::to_string(Layout.SpareDisksPerDc * Layout.NumDCs) + " Spare) and " +
+             std::to_string(VDisks.Size()) + " VDisks.");
 }
 
 void Simulation::InitializeGroups() {
-    const int kNumDCs = 3;
-    const int kVDisksPerDCInGroup = 3;
+    const Ui32 numDCs = Layout.NumDCs;
+    const TErasureSchemeInfo& scheme = GetErasureScheme(Layout.ErasureScheme);
+    const Ui32 vdisksPerDCInGroup = scheme.VDisksPerDC;
     TGroupId currentGroupId = TGroupId::FromValue(0);
-    std::vector<std::vector<TVDiskId>> availableVDisksByDC(kNumDCs);
-    for (const auto& [vdiskId, vdiskPtr] : VDiskMap) {
-        if (vdiskPtr) {
-            availableVDisksByDC[vdiskPtr->GetDCId()].push_back(vdiskId);
-        } else {
-             LOG_WARNING("Found nullptr TVDisk in VDiskMap with ID " + std::to_string(vdiskId.GetRawId()));
+    if (numDCs < scheme.NumDCs) {
+        LOG_WARNING(std::string("Scheme ") + scheme.Name + " needs " + std::to_string(scheme.NumDCs) + " DCs, cluster has " +
+                    std::to_string(numDCs) + ": no groups are built.");
+    }
+
+    // VDisk'и группы внутри DC разносятся по самому крупному уровню доменов,
+    // которых в DC хватает: по стойкам, иначе по хостам, иначе по PDisk'ам.
+    // Разнесение по стойкам влечёт и разнесение по хостам и PDisk'ам.
+    const Ui32 kPDiskLevel = kDomainLevelCount;
+    std::vector<Ui32> placementLevel(numDCs, kPDiskLevel);
+    for (Ui32 dc = 0; dc < numDCs; ++dc) {
+        for (EFailDomainLevel level : {kDomainRack, kDomainHost}) {
+            if (Topology.GetDomainsInDC(level, dc) >= vdisksPerDCInGroup) {
+                placementLevel[dc] = level;
+                break;
+            }
         }
     }
-    while (true) {
-        std::vector<std::vector<TVDiskId>> selectedVDisksPerDC(kNumDCs);
-        bool possibleToCreateGroup = true;
-
-        for (int dc = 0; dc < kNumDCs; ++dc) {
-            std::unordered_set<TPDiskId> pdisks_in_group_for_dc;
-            for (const TVDiskId& vdiskId : availableVDisksByDC[dc]) {
-                auto vdiskIt = VDiskMap.find(vdiskId);
-                if (vdiskIt == VDiskMap.end() || !vdiskIt->second) continue;
-
-                TPDiskId pdiskId = vdiskIt->second->GetPDiskId();
-
-                if (pdisks_in_group_for_dc.find(pdiskId) == pdisks_in_group_for_dc.end()) {
-                    selectedVDisksPerDC[dc].push_back(vdiskId);
-                    pdisks_in_group_for_dc.insert(pdiskId);
-                    if (selectedVDisksPerDC[dc].size() == kVDisksPerDCInGroup) {
-                        break;
-                    }
+
+    std::vector<std::vector<TVDiskId>> availableVDisksByDC(numDCs);
+    for (const auto& vdisk : VDisks) {
+        availableVDisksByDC[vdisk->GetDCId()].push_back(vdisk->GetId());
+    }
+
+    auto selectInDC = [&](Ui32 dc, std::vector<TVDiskId>& selected) {
+        selected.clear();
+        std::unordered_set<Ui32> usedDomains;
+        for (const TVDiskId& vdiskId : availableVDisksByDC[dc]) {
+            const Ui32 pdiskIndex = VDisks[vdiskId]->GetPDiskId().GetRawId();
+            const Ui32 domain = placementLevel[dc] == kPDiskLevel
+                ? pdiskIndex
+                : Topology.GetDomain(static_cast<EFailDomainLevel>(placementLevel[dc]), pdiskIndex);
+            if (usedDomains.insert(domain).second) {
+                selected.push_back(vdiskId);
+                if (selected.size() == vdisksPerDCInGroup) {
+                    return true;
                 }
             }
-            if (selectedVDisksPerDC[dc].size() < kVDisksPerDCInGroup) {
-                possibleToCreateGroup = false;
-                break;
+        }
+        return false;
+    };
+
+    GroupByVDisk.assign(VDiskByIndex.size(), kNoGroup);
+
+    std::vector<Ui32> dcOrder(numDCs);
+    std::vector<std::vector<TVDiskId>> selectedVDisksPerDC(numDCs);
+    while (true) {
+        // Группа берёт DC с наибольшим запасом свободных VDisk'ов, так что и
+        // однодатацентровые схемы, и mirror-3-dc на 4-5 площадках заполняют все DC.
+        std::iota(dcOrder.begin(), dcOrder.end(), 0);
+        std::stable_sort(dcOrder.begin(), dcOrder.end(), [&](Ui32 a, Ui32 b) {
+            return availableVDisksByDC[a].size() > availableVDisksByDC[b].size();
+        });
+        std::vector<Ui32> groupDCs;
+        for (Ui32 dc : dcOrder) {
+            if (selectInDC(dc, selectedVDisksPerDC[dc])) {
+                groupDCs.push_back(dc);
+                if (groupDCs.size() == scheme.NumDCs) {
+                    break;
+                }
             }
         }
-        if (!possibleToCreateGroup) {
+        if (groupDCs.size() < scheme.NumDCs) {
             break;
         }
+        std::sort(groupDCs.begin(), groupDCs.end());
 
-        auto group = std::make_shared<TGroup>(currentGroupId);
-        GroupMap[currentGroupId] = group;
-        for (int dc = 0; dc < kNumDCs; ++dc) {
+        TGroupRecord group;
+        group.VDisksPerDC = vdisksPerDCInGroup;
+        group.Scheme = Layout.ErasureScheme;
+        for (Ui32 groupDc = 0; groupDc < groupDCs.size(); ++groupDc) {
+            const Ui32 dc = groupDCs[groupDc];
             for (const TVDiskId& vdiskId : selectedVDisksPerDC[dc]) {
-                auto vdisk = VDiskMap[vdiskId];
-                vdisk->AssignToGroup(currentGroupId);
-                group->AddVDisk(vdisk, TDCId(dc));
+                VDisks[vdiskId]->AssignToGroup(currentGroupId);
+                group.VDisks[group.Size++] = vdiskId.GetRawId();
+                GroupByVDisk[vdiskId.GetRawId()] = currentGroupId.GetRawId();
             }
-        }
 
-        for (int dc = 0; dc < kNumDCs; ++dc) {
-            std::unordered_set<TVDiskId> ids_to_remove(selectedVDisksPerDC[dc].begin(), selectedVDisksPerDC[dc].end());
             availableVDisksByDC[dc].erase(
                 std::remove_if(availableVDisksByDC[dc].begin(), availableVDisksByDC[dc].end(),
-                               [&](const TVDiskId& id){ return ids_to_remove.count(id); }),
+                               [&](const TVDiskId& id){ return GroupByVDisk[id.GetRawId()] != kNoGroup; }),
                 availableVDisksByDC[dc].end()
             );
         }
+        Groups.PushBack(group);
 
         currentGroupId = TGroupId::FromValue(currentGroupId.GetRawId() + 1);
     }
 
-    LOG_DEBUG("Initialized " + std::to_string(currentGroupId.GetRawId()) + " groups with unique PDisks per DC.");
+    LOG_DEBUG("Initialized " + std::to_string(currentGroupId.GetRawId()) + " " + scheme.Name +
+              " groups spread over fail domains in " + std::to_string(numDCs) + " DCs.");
 }
 
-void Simulation::SimulateHour(std::mt19937& rng) {
-    double failuresThisHour = GFailureRate / 24.0;
-    Si32 failures = static_cast<Si32>(failuresThisHour);
+void Simulation::SimulateHour(TRandomStream& rng) {
+    if (UseReplay) {
+        ProcessReplayedFailures();
+    } else if (UseHazardModel) {
+        ProcessScheduledFailures(rng);
+    } else {
+        Si32 failures = Config.BaseFailuresPerHour;
+
+        if (rng.NextUniform() < Config.ExtraFailureProbability) {
+            failures++;
+            ExtraFailureHours++;
+        }
 
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-    if (dist(rng) < (failuresThisHour - failures)) {
-        failures++;
+        ProcessFailures(failures, rng);
     }
+    ProcessOutages(rng);
+    AdvanceHour();
+}
 
+void Simulation::SimulateHour(Si32 failures, TRandomStream& rng) {
     ProcessFailures(failures, rng);
+    ProcessOutages(rng);
+    AdvanceHour();
+}
+
+void Simulation::InitializeFailureSchedule() {
+    FailureQueue.Clear();
+    PDisksToSchedule.clear();
+    PDiskInstallTime.clear();
+    NextFailureTime.assign(PDisks.Size(), std::numeric_limits<double>::infinity());
+
+    UseReplay = Config.Params.HazardModel == kHazardReplay;
+    ReplayOffset = 0;
+    ReplayDcOrder.resize(Layout.NumDCs);
+    std::iota(ReplayDcOrder.begin(), ReplayDcOrder.end(), 0);
+
+    UseHazardModel = !UseReplay && Config.Params.HazardModel != kHazardConstant &&
+                     Hazard.BuildFromParams(Config.Params, Config.FleetAgeHours + Config.Params.HorizonHours);
+    if (!UseHazardModel) {
+        return;
+    }
+
+    // Новая партия занимает первые PDisk'и каждого DC, то есть целые хосты и стойки.
+    for (Ui32 pdisk = 0; pdisk < PDisks.Size(); ++pdisk) {
+        const bool isNew = pdisk % Config.PDisksPerDc < Config.NewPDisksPerDc;
+        PDiskInstallTime.push_back(isNew ? 0.0 : -Config.FleetAgeHours);
+        PDisksToSchedule.push_back(pdisk);
+    }
+}
+
+void Simulation::StartReplay(TRandomStream& rng) {
+    if (!UseReplay || !Config.FailureLog) {
+        return;
+    }
+    // Бутстрэп по одной истории: журнал считается циклическим, прогон начинается
+    // со случайного часа, а DC журнала раскладываются по DC модели в случайном порядке.
+    ReplayOffset = rng.NextBounded(Config.FailureLog->GetHourCount());
+    for (Ui32 i = static_cast<Ui32>(ReplayDcOrder.size()); i > 1; --i) {
+        std::swap(ReplayDcOrder[i - 1], ReplayDcOrder[rng.NextBounded(i)]);
+    }
+}
+
+void Simulation::ProcessReplayedFailures() {
+    const TFailureLog* log = Config.FailureLog.get();
+    if (!log || ReplayDcOrder.empty()) {
+        return;
+    }
+    const Ui32 pdisksPerDc = Config.PDisksPerDc;
+    const Ui32 hour = static_cast<Ui32>((ReplayOffset + static_cast<Ui64>(CurrentTime)) % log->GetHourCount());
+    for (const TFailureRecord& record : log->GetHour(hour)) {
+        const Ui32 dc = ReplayDcOrder[log->GetDcIndex(record.Dc) % ReplayDcOrder.size()];
+        // Диск журнала уже сломан в модели, если кластер меньше реального: тогда
+        // отказывает следующий живой PDisk того же DC, чтобы число отказов сохранилось.
+        for (Ui32 probe = 0; probe < pdisksPerDc; ++probe) {
+            const TPDiskId pdiskId = TPDiskId::FromValue(dc * pdisksPerDc + (record.Disk % pdisksPerDc + probe) % pdisksPerDc);
+            if (PDisks[pdiskId]->GetState() != TPDisk::Broken) {
+                FailPDisk(pdiskId);
+                break;
+            }
+        }
+    }
+}
+
+void Simulation::ScheduleFailure(Ui32 pdiskIndex, double exponential) {
+    const double age = CurrentTime - PDiskInstallTime[pdiskIndex];
+    const double time = CurrentTime + Hazard.GetTimeToFailure(age, exponential);
+    NextFailureTime[pdiskIndex] = time;
+    if (time < std::numeric_limits<double>::infinity()) {
+        FailureQueue.push({time, pdiskIndex});
+    }
+}
+
+void Simulation::ProcessScheduledFailures(TRandomStream& rng) {
+    // Экспоненциальные величины для всех ждущих PDisk'ов берутся одним проходом по буферу rng.
+    ScheduleExponentials.resize(PDisksToSchedule.size());
+    rng.FillExponential(ScheduleExponentials.data(), ScheduleExponentials.size());
+    for (size_t i = 0; i < PDisksToSchedule.size(); ++i) {
+        ScheduleFailure(PDisksToSchedule[i], ScheduleExponentials[i]);
+    }
+    PDisksToSchedule.clear();
+
+    // Отказы внутри часа приходятся на его начало, как и в постоянной модели.
+    while (!FailureQueue.empty() && FailureQueue.top().first < CurrentTime + 1.0) {
+        const auto [time, pdiskIndex] = FailureQueue.top();
+        FailureQueue.pop();
+        if (time != NextFailureTime[pdiskIndex]) {
+            continue;
+        }
+        NextFailureTime[pdiskIndex] = std::numeric_limits<double>::infinity();
+        FailPDisk(TPDiskId::FromValue(pdiskIndex));
+    }
+}
+
+void Simulation::AdvanceHour() {
+    EndOutages();
     ProcessGroups();
     CompleteReplications();
     ProcessRecoveries();
@@ -155,18 +375,138 @@ void Simulation::SimulateHour(std::mt19937& rng) {
     CurrentTime += 1.0;
 }
 
-void Simulation::ProcessFailures(Si32 failures, std::mt19937& rng) {
-    Si32 successful_failures = 0;
-    const int max_attempts_for_one_failure = PDiskMap.size() > 0 ? PDiskMap.size() : 1;
-    int attempts_since_last_success = 0;
+bool Simulation::FailPDisk(TPDiskId pdiskId) {
+    if (!PDisks.Contains(pdiskId)) {
+        LOG_WARNING("FailPDisk: PDisk ID " + pdiskId.ToString() + " not found.");
+        return false;
+    }
+    TPDisk& pdisk = *PDisks[pdiskId];
+    if (pdisk.GetState() == TPDisk::Broken) {
+        return false;
+    }
+    (this->*FailVDisksKernel)(pdisk, pdiskId.GetRawId());
+    if (Surrogate) {
+        Surrogate->OnFailure(pdiskId.GetRawId(), static_cast<Ui32>(CurrentTime));
+    }
+    if (Recorder) {
+        Recorder->Record(ETraceEvent::Failure, CurrentTime, pdiskId.GetRawId());
+    }
+    return true;
+}
+
+template <Ui32 FixedVDisksPerPDisk>
+void Simulation::FailVDisksImpl(TPDisk& pdisk, Ui32 pdiskIndex) {
+    if constexpr (FixedVDisksPerPDisk == 0) {
+        pdisk.Fail(CurrentTime);
+        const Ui32 firstVDisk = pdiskIndex * Layout.VDisksPerPDisk;
+        for (Ui32 vdiskIndex = firstVDisk; vdiskIndex < firstVDisk + Layout.VDisksPerPDisk; ++vdiskIndex) {
+            // Репликация после прежнего отказа ещё шла: её завершение не должно закрыть новый отказ.
+            Replications.CancelFlow(vdiskIndex, CurrentTime);
+            MarkGroupDirty(vdiskIndex);
+        }
+    } else {
+        // VDisk'и PDisk'а - те же, что у него в списке, но лежат подряд в VDiskByIndex,
+        // так что цикл с постоянным числом шагов разворачивается без обхода shared_ptr.
+        pdisk.MarkBroken(CurrentTime);
+        const Ui32 firstVDisk = pdiskIndex * FixedVDisksPerPDisk;
+        for (Ui32 i = 0; i < FixedVDisksPerPDisk; ++i) {
+            VDiskByIndex[firstVDisk + i]->SetState(TVDisk::Faulty);
+            Replications.CancelFlow(firstVDisk + i, CurrentTime);
+            MarkGroupDirty(firstVDisk + i);
+        }
+    }
+}
+
+void Simulation::StartOutage(EFailDomainLevel level, Ui32 domain, Ui32 durationHours) {
+    if (domain >= Topology.GetDomainCount(level)) {
+        LOG_WARNING("StartOutage: domain " + std::to_string(domain) + " of level " + std::to_string(level) + " not found.");
+        return;
+    }
+    durationHours = std::max<Ui32>(1, durationHours);
+    if (Recorder) {
+        Recorder->Record(ETraceEvent::OutageStart, CurrentTime, domain, MakeOutageExtra(level, durationHours));
+    }
+    SetDomainOffline(level, domain, true);
+    ActiveOutages.push_back({level, domain, CurrentTime + durationHours});
+    LOG_DEBUG("Outage started: level=" + std::to_string(level) + ", domain=" + std::to_string(domain) +
+              ", duration=" + std::to_string(durationHours) + " hours");
+}
+
+void Simulation::SetDomainOffline(EFailDomainLevel level, Ui32 domain, bool offline) {
+    // Домен - непрерывный диапазон PDisk'ов, а значит и VDisk'ов, поэтому авария
+    // размечается одним линейным проходом без обращений к хеш-таблицам.
+    const TFailDomain& range = Topology.GetDomainRange(level, domain);
+    for (Ui32 pdisk = range.Begin; pdisk < range.End; ++pdisk) {
+        offline ? ++PDiskOfflineCount[pdisk] : --PDiskOfflineCount[pdisk];
+    }
+    const Ui32 vdiskEnd = range.End * Layout.VDisksPerPDisk;
+    for (Ui32 vdiskIndex = range.Begin * Layout.VDisksPerPDisk; vdiskIndex < vdiskEnd; ++vdiskIndex) {
+        VDiskByIndex[vdiskIndex]->SetOffline(offline);
+        if (offline) {
+            MarkGroupDirty(vdiskIndex);
+        }
+    }
+    if (offline) {
+        return;
+    }
+    // Вернувшиеся спары могут принять VDisk'и своего DC, отложенные в ProcessGroups.
+    const TFailDomain& dc = Topology.GetDomainRange(kDomainDC, Topology.GetDomain(kDomainDC, range.Begin));
+    for (Ui32 vdiskIndex = dc.Begin * Layout.VDisksPerPDisk; vdiskIndex < dc.End * Layout.VDisksPerPDisk; ++vdiskIndex) {
+        const TVDisk* vdisk = VDiskByIndex[vdiskIndex];
+        if (vdisk->GetState() == TVDisk::Faulty && !vdisk->IsReplicationTriggered()) {
+            MarkGroupDirty(vdiskIndex);
+        }
+    }
+}
 
-    std::vector<TPDiskId> pdiskIds;
-    pdiskIds.reserve(PDiskMap.size());
-    for(const auto& pair : PDiskMap) {
-        pdiskIds.push_back(pair.first);
+void Simulation::MarkGroupDirty(Ui32 vdiskIndex) {
+    const Ui32 group = GroupByVDisk[vdiskIndex];
+    if (group != kNoGroup && GroupDirty.TestAndSet(TGroupId::FromValue(group))) {
+        DirtyGroups.push_back(TGroupId::FromValue(group));
     }
+}
+
+void Simulation::ProcessOutages(TRandomStream& rng) {
+    const struct {
+        EFailDomainLevel Level;
+        double Probability;
+        Ui32 Hours;
+    } outageClasses[] = {
+        {kDomainHost, Config.HostOutageProbability, Config.Params.HostOutageHours},
+        {kDomainRack, Config.RackOutageProbability, Config.Params.RackOutageHours},
+        {kDomainDC, Config.DcOutageProbability, Config.Params.DcOutageHours},
+    };
+    for (const auto& outageClass : outageClasses) {
+        // При нулевой частоте rng не трогаем, чтобы не сдвигать поток случайных чисел.
+        if (outageClass.Probability == 0) {
+            continue;
+        }
+        if (rng.NextUniform() < outageClass.Probability) {
+            StartOutage(outageClass.Level, rng.NextBounded(Topology.GetDomainCount(outageClass.Level)), outageClass.Hours);
+        }
+    }
+}
+
+void Simulation::EndOutages() {
+    for (size_t i = 0; i < ActiveOutages.size();) {
+        if (CurrentTime >= ActiveOutages[i].EndTime) {
+            SetDomainOffline(ActiveOutages[i].Level, ActiveOutages[i].Domain, false);
+            LOG_DEBUG("Outage ended: level=" + std::to_string(ActiveOutages[i].Level) +
+                      ", domain=" + std::to_string(ActiveOutages[i].Domain));
+            ActiveOutages[i] = ActiveOutages.back();
+            ActiveOutages.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void Simulation::ProcessFailures(Si32 failures, TRandomStream& rng) {
+    Si32 successful_failures = 0;
+    const int max_attempts_for_one_failure = PDisks.Size() > 0 ? PDisks.Size() : 1;
+    int attempts_since_last_success = 0;
 
-    if (pdiskIds.empty()) {
+    if (PDisks.Empty()) {
         LOG_WARNING("ProcessFailures: No PDisks available to fail.");
         return;
     }
@@ -180,21 +520,11 @@ void Simulation::ProcessFailures(Si32 failures, std::mt19937& rng) {
             break;
         }
 
-        std::uniform_int_distribution<Si32> pdisk_dist(0, pdiskIds.size() - 1);
-        Si32 randomIndex = pdisk_dist(rng);
-        TPDiskId randomPDiskId = pdiskIds[randomIndex];
-        auto pdiskIt = PDiskMap.find(randomPDiskId);
-
-        if (pdiskIt == PDiskMap.end() || !pdiskIt->second) {
-             LOG_WARNING("ProcessFailures: Randomly selected PDisk ID " + randomPDiskId.ToString() + " not found or is null.");
-             attempts_since_last_success++;
-             continue;
-        }
-
-        auto& pdisk = pdiskIt->second;
+        const TPDiskId randomPDiskId = TPDiskId::FromValue(rng.NextBounded(PDisks.Size()));
+        const auto& pdisk = PDisks[randomPDiskId];
 
         if (pdisk->GetState() != TPDisk::Broken) {
-            pdisk->Fail(CurrentTime);
+            FailPDisk(randomPDiskId);
             successful_failures++;
             attempts_since_last_success = 0;
             LOG_DEBUG("PDisk failed: ID=" + randomPDiskId.ToString() + ", DC=" + std::to_string(pdisk->GetDCId()));
@@ -205,44 +535,55 @@ void Simulation::ProcessFailures(Si32 failures, std::mt19937& rng) {
     }
 }
 
-void Simulation::ProcessGroups() {
-    for (auto const& [groupId, groupPtr] : GroupMap) {
-        if (!groupPtr) continue;
+template <typename TScheme>
+void Simulation::ProcessGroupsImpl() {
+    // Проверяются только группы, в которых с прошлого часа что-то отказало:
+    // у остальных проверка дала бы тот же результат.
+    for (const TGroupId& groupId : DirtyGroups) {
+        GroupDirty.Reset(groupId);
+        const TGroupRecord& group = Groups[groupId];
 
-        if (LostGroupInfo.count(groupId)) {
+        if (LostGroups.Test(groupId)) {
             continue;
         }
 
-        if (groupPtr->CheckDataLoss()) {
-            LostGroupInfo[groupId] = CurrentTime;
+        bool dataLoss = false;
+        if constexpr (std::is_void_v<TScheme>) {
+            dataLoss = GroupLossCheck(group, VDiskByIndex.data());
+        } else {
+            dataLoss = CheckDataLoss<TScheme>(group, VDiskByIndex.data());
+        }
+        if (dataLoss) {
+            LostGroups.Set(groupId);
+            LostGroupInfo.emplace_back(groupId, CurrentTime);
+            if (Recorder) {
+                Recorder->Record(ETraceEvent::DataLoss, CurrentTime, groupId.GetRawId());
+            }
             LOG_DEBUG("Data loss detected in group " + std::to_string(groupId.GetRawId()) + " at time " + std::to_string(CurrentTime));
             continue;
         }
 
-        std::vector<TVDiskId> faultyVDisksToReplicate;
-        for (const auto& vdiskId : groupPtr->GetAllVDiskIds()) {
-            auto vdiskIt = VDiskMap.find(vdiskId);
-            if (vdiskIt != VDiskMap.end() && vdiskIt->second) {
-                const auto& vdisk = vdiskIt->second;
-                if (vdisk->GetState() == TVDisk::Faulty && !vdisk->IsReplicationTriggered()) {
-                    faultyVDisksToReplicate.push_back(vdiskId);
-                }
+        for (Ui32 position = 0; position < group.Size; ++position) {
+            TVDisk* faultyVDisk = VDiskByIndex[group.VDisks[position]];
+            if (faultyVDisk->GetState() != TVDisk::Faulty || faultyVDisk->IsReplicationTriggered()) {
+                continue;
             }
-        }
-
-        for (const auto& faultyVDiskId : faultyVDisksToReplicate) {
-            auto faultyVDiskIt = VDiskMap.find(faultyVDiskId);
-            if (faultyVDiskIt == VDiskMap.end() || !faultyVDiskIt->second) continue;
-            auto faultyVDisk = faultyVDiskIt->second;
+            const TVDiskId faultyVDiskId = faultyVDisk->GetId();
             TDCId dcId = faultyVDisk->GetDCId();
 
             std::shared_ptr<TPDisk> bestSparePDisk = nullptr;
             int maxSlots = -1;
-
-            for (const auto& [pdiskId, pdiskPtr] : PDiskMap) {
-                if (pdiskPtr && pdiskPtr->GetDCId() == dcId && pdiskPtr->GetState() == TPDisk::Spare) {
+            bool offlineSpare = false;
+
+            for (const auto& pdiskPtr : PDisks) {
+                if (pdiskPtr->GetDCId() == dcId && pdiskPtr->GetState() == TPDisk::Spare &&
+                    pdiskPtr->GetAvailableVDiskSlots() > 0) {
+                    if (PDiskOfflineCount[pdiskPtr->GetId().GetRawId()] != 0) {
+                        offlineSpare = true;
+                        continue;
+                    }
                     int currentSlots = pdiskPtr->GetAvailableVDiskSlots();
-                    if (currentSlots > 0 && currentSlots > maxSlots) {
+                    if (currentSlots > maxSlots) {
                         maxSlots = currentSlots;
                         bestSparePDisk = pdiskPtr;
                     }
@@ -252,10 +593,17 @@ void Simulation::ProcessGroups() {
             if (bestSparePDisk) {
                 bestSparePDisk->DecrementAvailableVDiskSlots();
 
-                double replicationDurationHours = (GWriteSpeed > 0) ? (static_cast<double>(GDiskSize) * 1024.0 / GWriteSpeed) / 3600.0 : std::numeric_limits<double>::infinity();
-                double completeTime = CurrentTime + replicationDurationHours;
+                // Объём копии как прежде - весь диск, так что одиночная репликация длится столько же,
+                // а параллельные делят полосу записи спаре и сеть DC.
+                const double completeTime = Replications.StartFlow(faultyVDiskId.GetRawId(), bestSparePDisk->GetId().GetRawId(),
+                                                                   dcId, Config.CopySizeMb, CurrentTime);
+                const double replicationDurationHours = completeTime - CurrentTime;
 
                 faultyVDisk->MarkReplicationTriggered(completeTime);
+                if (Recorder) {
+                    Recorder->Record(ETraceEvent::ReplicationStart, CurrentTime, faultyVDiskId.GetRawId(),
+                                     bestSparePDisk->GetId().GetRawId());
+                }
 
                 LOG_DEBUG("Started replication for VDisk " + std::to_string(faultyVDiskId.GetRawId()) +
                           " (Group " + std::to_string(groupId.GetRawId()) +
@@ -263,6 +611,10 @@ void Simulation::ProcessGroups() {
                           " (DC " + std::to_string(dcId) +
                           "). Slots left: " + std::to_string(bestSparePDisk->GetAvailableVDiskSlots()) +
                           ". Completion at T+" + std::to_string(replicationDurationHours));
+            } else if (offlineSpare) {
+                // Спара только за аварией домена: репликация повторится, когда авария закончится.
+                LOG_DEBUG("Spare PDisks in DC " + std::to_string(dcId) + " are offline, replication of VDisk " +
+                          std::to_string(faultyVDiskId.GetRawId()) + " is postponed.");
             } else {
                  faultyVDisk->MarkReplicationTriggered(0);
                  faultyVDisk->SetState(TVDisk::Faulty);
@@ -273,29 +625,42 @@ void Simulation::ProcessGroups() {
             }
         }
     }
+    DirtyGroups.clear();
 }
 
 void Simulation::CompleteReplications() {
-    for (auto& [vdiskId, vdiskPtr] : VDiskMap) {
-        if (vdiskPtr && vdiskPtr->GetState() == TVDisk::Replicating) {
-             if (CurrentTime >= vdiskPtr->GetReplicationCompleteTime()) {
-                 vdiskPtr->SetState(TVDisk::Replicated);
-                 LOG_DEBUG("Replication complete for VDisk " + std::to_string(vdiskId.GetRawId()) +
-                           " (Group " + std::to_string(vdiskPtr->GetGroupId().GetRawId()) +
-                           ") at time " + std::to_string(CurrentTime));
-             }
+    Ui32 vdiskIndex = 0;
+    double completeTime = 0;
+    while (Replications.PopCompleted(CurrentTime, vdiskIndex, completeTime)) {
+        TVDisk* vdisk = VDiskByIndex[vdiskIndex];
+        if (vdisk->GetState() != TVDisk::Replicating) {
+            continue;
         }
+        vdisk->SetState(TVDisk::Replicated);
+        if (Recorder) {
+            Recorder->Record(ETraceEvent::ReplicationComplete, CurrentTime, vdiskIndex);
+        }
+        LOG_DEBUG("Replication complete for VDisk " + std::to_string(vdiskIndex) +
+                  " (Group " + std::to_string(vdisk->GetGroupId().GetRawId()) +
+                  ") at time " + std::to_string(completeTime));
     }
 }
 
 void Simulation::ProcessRecoveries() {
-    extern Ui32 GPDiskRecoveryTimeHours;
-
-    for (auto& [pdiskId, pdiskPtr] : PDiskMap) {
-        if (pdiskPtr && pdiskPtr->GetState() == TPDisk::Broken) {
+    for (auto& pdiskPtr : PDisks) {
+        const TPDiskId pdiskId = pdiskPtr->GetId();
+        if (pdiskPtr->GetState() == TPDisk::Broken) {
             double brokenDuration = CurrentTime - pdiskPtr->GetBrokenTime();
-            if (brokenDuration >= static_cast<double>(GPDiskRecoveryTimeHours)) {
+            if (brokenDuration >= static_cast<double>(Config.Params.PDiskRecoveryTimeHours)) {
                 pdiskPtr->Recover();
+                // Взамен сломанного ставится новый диск: возраст с нуля, следующий отказ разыгрывается заново.
+                if (UseHazardModel) {
+                    PDiskInstallTime[pdiskId.GetRawId()] = CurrentTime;
+                    PDisksToSchedule.push_back(pdiskId.GetRawId());
+                }
+                if (Recorder) {
+                    Recorder->Record(ETraceEvent::Recovery, CurrentTime, pdiskId.GetRawId());
+                }
                 LOG_DEBUG("PDisk Recovered: ID=" + pdiskId.ToString() +
                           " after being broken for " + std::to_string(brokenDuration) + " hours.");
             }
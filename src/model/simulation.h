@@ -3,42 +3,148 @@
 #include "vdisk.h"
 #include "group.h"
 #include "simulation_params.h"
+#include "event_trace.h"
+#include "topology.h"
+#include "replication_flows.h"
+#include "failure_log.h"
+#include "failure_model.h"
+#include "id_vector.h"
+#include "loss_surrogate.h"
+#include "random_stream.h"
+#include "../utils/reusable_heap.h"
 #include <map>
 #include <vector>
-#include <random>
 #include <memory>
-#include <unordered_map>
+#include <functional>
 
 namespace arctic {
 
 class Simulation {
 public:
-    void Reset();
-    void SimulateHour(std::mt19937& rng);
+    // Запоминает копию config: дальше модель читает параметры только из неё.
+    // Если раскладка кластера не менялась с прошлого вызова, модель сбрасывается
+    // на месте: объекты, группы и контейнеры переиспользуются без выделений памяти.
+    void Reset(const TSimulationConfig& config);
+    const TSimulationConfig& GetConfig() const { return Config; }
+    void SimulateHour(TRandomStream& rng);
+    // При kHazardReplay разыгрывает начальный час журнала и соответствие DC для
+    // этого прогона; без вызова журнал идёт с начала, DC журнала i - DC i модели.
+    // Лишние DC журнала складываются на DC модели по модулю, диск - номер PDisk'а в DC по модулю.
+    void StartReplay(TRandomStream& rng);
+    // Шаг часа с заданным числом отказов при постоянной интенсивности; аварии доменов разыгрываются как обычно.
+    void SimulateHour(Si32 failures, TRandomStream& rng);
+    // Шаг часа без розыгрыша отказов: отказы заранее подаются через FailPDisk.
+    void AdvanceHour();
+    bool FailPDisk(TPDiskId pdiskId);
+    // Авария целого домена: его PDisk'и недоступны durationHours часов и
+    // затем возвращаются вместе с данными.
+    void StartOutage(EFailDomainLevel level, Ui32 domain, Ui32 durationHours);
 
-    std::unordered_map<TPDiskId, std::shared_ptr<TPDisk>> PDiskMap;
-    std::unordered_map<TVDiskId, std::shared_ptr<TVDisk>> VDiskMap;
-    std::unordered_map<TGroupId, std::shared_ptr<TGroup>> GroupMap;
-    std::vector<TPDiskId> PDiskIdsByDC[3];
+    // Id выдаются подряд с нуля, поэтому объекты лежат в плотных массивах по id.
+    TIdVector<TPDiskId, std::shared_ptr<TPDisk>> PDisks;
+    TIdVector<TVDiskId, std::shared_ptr<TVDisk>> VDisks;
+    TIdVector<TGroupId, TGroupRecord> Groups;
+    std::vector<std::vector<TPDiskId>> PDiskIdsByDC;
     double CurrentTime = 0;
-    std::map<TGroupId, double> LostGroupInfo;
+    // Часы, в которые SimulateHour разыграл отказ сверх floor(FailureRate / 24).
+    Ui32 ExtraFailureHours = 0;
+    // Группы с потерей данных и время потери, в порядке обнаружения.
+    std::vector<std::pair<TGroupId, double>> LostGroupInfo;
 
-    std::vector<TPDiskId> sparePDiskIdsByDC[3];
+    std::vector<std::vector<TPDiskId>> sparePDiskIdsByDC;
+    TTopology Topology;
+
+    TTraceRecorder* Recorder = nullptr;
+    // Если задан, получает каждый отказ PDisk'а для контрольной переменной.
+    TLossSurrogate* Surrogate = nullptr;
 
 private:
+    struct TOutage {
+        EFailDomainLevel Level;
+        Ui32 Domain;
+        double EndTime;
+    };
+
+    // Параметры, от которых зависят PDisk'и, VDisk'и и группы.
+    struct TLayout {
+        Ui32 NumDCs = 0;
+        Ui32 DisksPerDc = 0;
+        Ui32 SpareDisksPerDc = 0;
+        Ui32 VDisksPerPDisk = 0;
+        Ui32 ErasureScheme = 0;
+        Ui32 RacksPerDc = 0;
+        Ui32 DisksPerHost = 0;
+
+        bool operator==(const TLayout&) const = default;
+    };
+    static TLayout LayoutFromParams(const TSimulationParams& params);
+
+    void BuildLayout();
+    void ResetLayoutInPlace();
     void InitializePDisks();
     void InitializeGroups();
-    void ProcessFailures(Si32 failures, std::mt19937& rng);
-    void ProcessGroups();
+    void ProcessFailures(Si32 failures, TRandomStream& rng);
+    void ProcessGroups() { (this->*ProcessGroupsKernel)(); }
+    // Выбирает варианты горячих циклов под Layout: проверку групп для каждой схемы
+    // и отказ PDisk'а с 8 или 9 VDisk'ами. Для остальных раскладок и при выключенном
+    // SpecializedKernels остаются общие варианты с размерами из Layout.
+    void SelectKernels();
+    // TScheme = void и FixedVDisksPerPDisk = 0 - общие варианты.
+    template <typename TScheme>
+    void ProcessGroupsImpl();
+    template <Ui32 FixedVDisksPerPDisk>
+    void FailVDisksImpl(TPDisk& pdisk, Ui32 pdiskIndex);
     void CompleteReplications();
     void ProcessRecoveries();
+    void ProcessOutages(TRandomStream& rng);
+    void EndOutages();
+    void SetDomainOffline(EFailDomainLevel level, Ui32 domain, bool offline);
+    void MarkGroupDirty(Ui32 vdiskIndex);
+    void InitializeFailureSchedule();
+    void ScheduleFailure(Ui32 pdiskIndex, double exponential);
+    void ProcessScheduledFailures(TRandomStream& rng);
+    void ProcessReplayedFailures();
+
+    // Плотные индексы: VDisk'и PDisk'а p занимают [p * VDisksPerPDisk, (p + 1) * VDisksPerPDisk).
+    std::vector<TVDisk*> VDiskByIndex;
+    std::vector<Ui32> GroupByVDisk;
+    std::vector<Ui16> PDiskOfflineCount;
+    std::vector<TOutage> ActiveOutages;
+    TReplicationScheduler Replications;
+
+    // Отказы по возрасту: у каждого PDisk'а разыгрывается время следующего отказа,
+    // и за час извлекаются только наступившие, без обхода всех дисков.
+    bool UseHazardModel = false;
+    bool UseReplay = false;
+    Ui64 ReplayOffset = 0;
+    std::vector<Ui32> ReplayDcOrder;
+    THazardTable Hazard;
+    std::vector<double> PDiskInstallTime;
+    std::vector<double> NextFailureTime;
+    TReusableHeap<std::pair<double, Ui32>, std::greater<std::pair<double, Ui32>>> FailureQueue;
+    std::vector<Ui32> PDisksToSchedule;
+    std::vector<double> ScheduleExponentials;
+    // Группы, у которых с прошлой проверки появились отказавшие или недоступные VDisk'и.
+    TIdBitset<TGroupId> GroupDirty;
+    std::vector<TGroupId> DirtyGroups;
+    TIdBitset<TGroupId> LostGroups;
+
+    TSimulationConfig Config;
+    // Проверка групп под схему раскладки для общего варианта ProcessGroupsImpl.
+    TGroupLossCheck GroupLossCheck = nullptr;
+    // Выбираются в Reset.
+    void (Simulation::*ProcessGroupsKernel)() = nullptr;
+    void (Simulation::*FailVDisksKernel)(TPDisk&, Ui32) = nullptr;
+    bool HasLayout = false;
+    TLayout Layout;
 };
 
-extern Ui32 GDisksPerDc;
-extern Ui32 GDiskSize;
-extern Ui32 GFailureRate;
-extern Ui32 GSpareDisksPerDc;
-extern Ui32 GWriteSpeed;
-extern Ui64 GSims;
-extern double GDataLossProb;
+// Упаковка уровня домена и длительности аварии в extra события трейса.
+inline Ui32 MakeOutageExtra(EFailDomainLevel level, Ui32 hours) { return (hours << 2) | level; }
+inline EFailDomainLevel OutageLevelFromExtra(Ui32 extra) { return static_cast<EFailDomainLevel>(extra & 3); }
+inline Ui32 OutageHoursFromExtra(Ui32 extra) { return extra >> 2; }
+
+// Seed прогона с номером simIndex в воспроизводимом потоке baseSeed.
+Ui64 MakeRunSeed(Ui64 baseSeed, Ui64 simIndex);
+
 } // namespace arctic 
\ No newline at end of file
@@ -1,4 +1,10 @@
 #include "simulation_params.h"
+#include "erasure_scheme.h"
+#include "failure_log.h"
+#include "failure_model.h"
+#include "varint.h"
+#include "../utils/logger.h"
+#include <cmath>
 
 namespace arctic {
 
@@ -13,8 +19,174 @@ Ui64 GSims = 0;
 
 Ui32 GPDiskRecoveryTimeHours = 24;
 Ui32 GVDisksPerPDisk = 9;
+Ui32 GErasureScheme = kMirror3DcScheme;
+Ui32 GNumDCs = 3;
+Ui32 GRacksPerDc = 3;
+Ui32 GDisksPerHost = 12;
+// Длина одного прогона; вероятность потери считается на этом горизонте.
+Ui32 GHorizonHours = 30 * 24;
+// Коррелированные аварии целого домена: частота на кластер в год и длительность.
+Ui32 GHostOutagesPerYear = 0;
+Ui32 GHostOutageHours = 4;
+Ui32 GRackOutagesPerYear = 0;
+Ui32 GRackOutageHours = 8;
+Ui32 GDcOutagesPerYear = 0;
+Ui32 GDcOutageHours = 12;
+// Сетевая полоса DC на все репликации в нём, MB/s; 0 - не ограничена.
+Ui32 GDcReplicationSpeed = 0;
+// Модель отказов по возрасту PDisk'а (EHazardModel). Форма Weibull в тысячных:
+// 700 - повышенная ранняя смертность. Доля NewBatchPercent дисков каждого DC - новая
+// партия нулевого возраста, остальные проработали FleetAgeDays.
+Ui32 GHazardModel = 0;
+Ui32 GWeibullShapeMilli = 700;
+Ui32 GWeibullScaleDays = 100000;
+Ui32 GFleetAgeDays = 365;
+Ui32 GNewBatchPercent = 0;
+std::vector<THazardSegment> GPiecewiseHazard;
+std::string GHazardTableFileName = "hazard.csv";
+// Журнал реальных отказов для модели kHazardReplay: отпечаток загруженного и файл, откуда его загружать.
+Ui64 GFailureLogFingerprint = 0;
+std::string GFailureLogFileName = "failures.csv";
 
 double GDataLossProb = 0.0;
-bool GDoRestart = true;
 
-} // namespace arctic 
\ No newline at end of file
+bool GRecordTraces = false;
+std::string GTraceFileName = "losing_runs.dftrace";
+
+// Калибровочных прогонов суррогатной модели на каждый прогон Simulation для
+// контрольной переменной, не больше kMaxCalibrationRuns; 0 отключает её.
+Ui32 GControlCalibrationRuns = 16;
+// Стратифицированная выборка по числу отказов за горизонт (TFailureStrata) вместо
+// независимых прогонов; контрольная переменная при ней не собирается.
+bool GStratifiedSampling = false;
+// Варианты горячих циклов Simulation под раскладку (SelectKernels); результат
+// от них не меняется, выключение нужно для сравнения с общим кодом.
+bool GSpecializedKernels = true;
+// При смене только интенсивности отказов кривая пересчитывается по накопленным
+// прогонам (ReweightFailureRate), пока их эффективный размер не меньше этого.
+Ui32 GReweightMinEss = 500;
+// Накопленные оценки по наборам параметров (TResultCache): записей в памяти и
+// каталог для их копий на диске, пустой - только память.
+Ui32 GResultCacheEntries = 32;
+std::string GResultCacheDir;
+
+// Закрепление воркеров движка за CPU с NUMA-локальной памятью (thread_affinity.h);
+// без SMT на физическое ядро приходится один воркер.
+bool GPinWorkers = false;
+bool GPinWorkersUseSmt = true;
+
+Ui64 GBaseSeed = 0;
+std::string GCheckpointFileName = "estimate.dfck";
+Ui32 GCheckpointIntervalSeconds = 30;
+
+TSimulationParams TSimulationParams::FromGlobals() {
+    TSimulationParams params;
+    params.DisksPerDc = GDisksPerDc;
+    params.SpareDisksPerDc = GSpareDisksPerDc;
+    params.VDisksPerPDisk = GVDisksPerPDisk;
+    params.DiskSize = GDiskSize;
+    params.WriteSpeed = GWriteSpeed;
+    params.FailureRate = GFailureRate;
+    params.PDiskRecoveryTimeHours = GPDiskRecoveryTimeHours;
+    params.ErasureScheme = GErasureScheme;
+    params.NumDCs = GNumDCs;
+    params.RacksPerDc = GRacksPerDc;
+    params.DisksPerHost = GDisksPerHost;
+    params.HostOutagesPerYear = GHostOutagesPerYear;
+    params.HostOutageHours = GHostOutageHours;
+    params.RackOutagesPerYear = GRackOutagesPerYear;
+    params.RackOutageHours = GRackOutageHours;
+    params.DcOutagesPerYear = GDcOutagesPerYear;
+    params.DcOutageHours = GDcOutageHours;
+    params.DcReplicationSpeed = GDcReplicationSpeed;
+    params.HazardModel = GHazardModel;
+    params.WeibullShapeMilli = GWeibullShapeMilli;
+    params.WeibullScaleDays = GWeibullScaleDays;
+    params.FleetAgeDays = GFleetAgeDays;
+    params.NewBatchPercent = GNewBatchPercent;
+    params.HorizonHours = GHorizonHours;
+    params.PiecewiseHazard = GPiecewiseHazard;
+    params.FailureLogFingerprint = GFailureLogFingerprint;
+    return params;
+}
+
+void TSimulationParams::Serialize(std::vector<Ui8>& out) const {
+    for (Ui32 field : {DisksPerDc, SpareDisksPerDc, VDisksPerPDisk, DiskSize, WriteSpeed,
+                       FailureRate, PDiskRecoveryTimeHours, ErasureScheme, NumDCs, RacksPerDc, DisksPerHost,
+                       HostOutagesPerYear, HostOutageHours, RackOutagesPerYear, RackOutageHours,
+                       DcOutagesPerYear, DcOutageHours, DcReplicationSpeed,
+                       HazardModel, WeibullShapeMilli, WeibullScaleDays, FleetAgeDays, NewBatchPercent, HorizonHours}) {
+        WriteVarint(out, field);
+    }
+    WriteVarint(out, PiecewiseHazard.size());
+    for (const THazardSegment& segment : PiecewiseHazard) {
+        WriteVarint(out, segment.AgeDays);
+        WriteVarint(out, segment.AfrMilliPercent);
+    }
+    WriteVarint(out, FailureLogFingerprint);
+}
+
+bool TSimulationParams::Deserialize(const Ui8*& pos, const Ui8* end) {
+    for (Ui32* field : {&DisksPerDc, &SpareDisksPerDc, &VDisksPerPDisk, &DiskSize, &WriteSpeed,
+                        &FailureRate, &PDiskRecoveryTimeHours, &ErasureScheme, &NumDCs, &RacksPerDc, &DisksPerHost,
+                        &HostOutagesPerYear, &HostOutageHours, &RackOutagesPerYear, &RackOutageHours,
+                        &DcOutagesPerYear, &DcOutageHours, &DcReplicationSpeed,
+                        &HazardModel, &WeibullShapeMilli, &WeibullScaleDays, &FleetAgeDays, &NewBatchPercent, &HorizonHours}) {
+        Ui64 value = 0;
+        if (!ReadVarint(pos, end, value)) {
+            return false;
+        }
+        *field = static_cast<Ui32>(value);
+    }
+    Ui64 segments = 0;
+    if (!ReadVarint(pos, end, segments) || segments > static_cast<Ui64>(end - pos)) {
+        return false;
+    }
+    PiecewiseHazard.resize(segments);
+    for (THazardSegment& segment : PiecewiseHazard) {
+        Ui64 ageDays = 0;
+        Ui64 afr = 0;
+        if (!ReadVarint(pos, end, ageDays) || !ReadVarint(pos, end, afr)) {
+            return false;
+        }
+        segment.AgeDays = static_cast<Ui32>(ageDays);
+        segment.AfrMilliPercent = static_cast<Ui32>(afr);
+    }
+    // Схема, которой в этой сборке нет, не должна молча подменяться другой.
+    return ReadVarint(pos, end, FailureLogFingerprint) && ErasureScheme < kErasureSchemeCount;
+}
+
+bool TSimulationConfig::FromParams(const TSimulationParams& params, TSimulationConfig& config) {
+    config = TSimulationConfig();
+    config.Params = params;
+    config.ControlCalibrationRuns = GControlCalibrationRuns;
+    config.StratifiedSampling = GStratifiedSampling;
+    config.RecordTraces = GRecordTraces;
+    config.SpecializedKernels = GSpecializedKernels;
+
+    config.PDisksPerDc = params.DisksPerDc + params.SpareDisksPerDc;
+    config.FailuresPerHour = params.FailureRate / 24.0;
+    config.BaseFailuresPerHour = static_cast<Si32>(config.FailuresPerHour);
+    config.ExtraFailureProbability = config.FailuresPerHour - config.BaseFailuresPerHour;
+    config.CopySizeMb = static_cast<double>(params.DiskSize) * 1024.0;
+    config.ReplicationHours = params.WriteSpeed > 0
+        ? static_cast<Ui32>(std::ceil(config.CopySizeMb / params.WriteSpeed / 3600.0))
+        : params.HorizonHours;
+    config.HostOutageProbability = params.HostOutagesPerYear / (365.0 * 24.0);
+    config.RackOutageProbability = params.RackOutagesPerYear / (365.0 * 24.0);
+    config.DcOutageProbability = params.DcOutagesPerYear / (365.0 * 24.0);
+    config.FleetAgeHours = params.FleetAgeDays * 24.0;
+    config.NewPDisksPerDc = config.PDisksPerDc * params.NewBatchPercent / 100;
+    if (params.HazardModel == kHazardReplay) {
+        config.FailureLog = FindFailureLog(params.FailureLogFingerprint);
+        if (!config.FailureLog) {
+            // Без журнала у прогонов нет отказов, и нулевая оценка выглядела бы настоящей.
+            LOG_ERROR("Failure log " + std::to_string(params.FailureLogFingerprint) +
+                      " is not loaded, replay is impossible");
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace arctic
@@ -1,9 +1,13 @@
 #pragma once
 #include <arctic/engine/easy.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace arctic {
 
+class TFailureLog;
+
 extern Ui32 GDisksPerDc;
 extern Ui32 GDiskSize;
 extern Ui32 GFailureRate;
@@ -11,10 +15,127 @@ extern Ui32 GSpareDisksPerDc;
 extern Ui32 GWriteSpeed;
 extern Ui64 GSims;
 extern double GDataLossProb;
-extern bool GDoRestart;
 extern Ui32 GPDiskRecoveryTimeHours;
 extern Ui32 GVDisksPerPDisk;
+extern Ui32 GErasureScheme;
+extern Ui32 GNumDCs;
+extern Ui32 GRacksPerDc;
+extern Ui32 GDisksPerHost;
+extern Ui32 GHorizonHours;
+extern Ui32 GHostOutagesPerYear;
+extern Ui32 GHostOutageHours;
+extern Ui32 GRackOutagesPerYear;
+extern Ui32 GRackOutageHours;
+extern Ui32 GDcOutagesPerYear;
+extern Ui32 GDcOutageHours;
+extern Ui32 GDcReplicationSpeed;
+
+// Участок кусочно-постоянной интенсивности отказов: AFR в тысячных долях процента с возраста AgeDays.
+struct THazardSegment {
+    Ui32 AgeDays = 0;
+    Ui32 AfrMilliPercent = 0;
+
+    bool operator==(const THazardSegment&) const = default;
+};
+
+extern Ui32 GHazardModel;
+extern Ui32 GWeibullShapeMilli;
+extern Ui32 GWeibullScaleDays;
+extern Ui32 GFleetAgeDays;
+extern Ui32 GNewBatchPercent;
+extern std::vector<THazardSegment> GPiecewiseHazard;
+extern std::string GHazardTableFileName;
+extern Ui64 GFailureLogFingerprint;
+extern std::string GFailureLogFileName;
+
+extern bool GRecordTraces;
+extern std::string GTraceFileName;
+
+extern Ui32 GControlCalibrationRuns;
+extern bool GStratifiedSampling;
+extern bool GSpecializedKernels;
+extern Ui32 GReweightMinEss;
+extern Ui32 GResultCacheEntries;
+extern std::string GResultCacheDir;
+
+extern bool GPinWorkers;
+extern bool GPinWorkersUseSmt;
+
+extern Ui64 GBaseSeed;
+extern std::string GCheckpointFileName;
+extern Ui32 GCheckpointIntervalSeconds;
 
 extern std::shared_ptr<GuiTheme> GTheme;
 
+// Набор параметров, определяющих результат прогона.
+struct TSimulationParams {
+    Ui32 DisksPerDc = 0;
+    Ui32 SpareDisksPerDc = 0;
+    Ui32 VDisksPerPDisk = 0;
+    Ui32 DiskSize = 0;
+    Ui32 WriteSpeed = 0;
+    Ui32 FailureRate = 0;
+    Ui32 PDiskRecoveryTimeHours = 0;
+    Ui32 ErasureScheme = 0;
+    Ui32 NumDCs = 0;
+    Ui32 RacksPerDc = 0;
+    Ui32 DisksPerHost = 0;
+    Ui32 HostOutagesPerYear = 0;
+    Ui32 HostOutageHours = 0;
+    Ui32 RackOutagesPerYear = 0;
+    Ui32 RackOutageHours = 0;
+    Ui32 DcOutagesPerYear = 0;
+    Ui32 DcOutageHours = 0;
+    Ui32 DcReplicationSpeed = 0;
+    Ui32 HazardModel = 0;
+    Ui32 WeibullShapeMilli = 0;
+    Ui32 WeibullScaleDays = 0;
+    Ui32 FleetAgeDays = 0;
+    Ui32 NewBatchPercent = 0;
+    Ui32 HorizonHours = 0;
+    std::vector<THazardSegment> PiecewiseHazard;
+    // Отпечаток журнала отказов (TFailureLog) для kHazardReplay.
+    Ui64 FailureLogFingerprint = 0;
+
+    static TSimulationParams FromGlobals();
+
+    void Serialize(std::vector<Ui8>& out) const;
+    bool Deserialize(const Ui8*& pos, const Ui8* end);
+
+    bool operator==(const TSimulationParams&) const = default;
+};
+
+// Снимок всего, что читает прогон: параметры модели, настройки оценки и производные
+// от них величины. Simulation и пакеты прогонов держат свою копию и не читают
+// глобальные переменные, которые меняет интерфейс, так что несколько конфигураций
+// могут считаться в одном процессе одновременно. После сборки не меняется.
+struct TSimulationConfig {
+    TSimulationParams Params;
+    Ui32 ControlCalibrationRuns = 0;
+    bool StratifiedSampling = false;
+    bool RecordTraces = false;
+    bool SpecializedKernels = true;
+
+    Ui32 PDisksPerDc = 0;
+    // r = FailureRate / 24: в час floor(r) отказов и ещё один с вероятностью frac(r).
+    double FailuresPerHour = 0;
+    Si32 BaseFailuresPerHour = 0;
+    double ExtraFailureProbability = 0;
+    // Объём копии VDisk'а в MB и длительность одиночной репликации в целых часах.
+    double CopySizeMb = 0;
+    Ui32 ReplicationHours = 0;
+    // Вероятность за час аварии хоста, стойки и DC.
+    double HostOutageProbability = 0;
+    double RackOutageProbability = 0;
+    double DcOutageProbability = 0;
+    double FleetAgeHours = 0;
+    Ui32 NewPDisksPerDc = 0;
+    // Журнал по Params.FailureLogFingerprint при kHazardReplay.
+    std::shared_ptr<const TFailureLog> FailureLog;
+
+    // Настройки оценки берутся из глобальных переменных, их задаёт командная строка.
+    // false, если для kHazardReplay не загружен журнал отказов.
+    static bool FromParams(const TSimulationParams& params, TSimulationConfig& config);
+};
+
 } // namespace arctic 
\ No newline at end of file
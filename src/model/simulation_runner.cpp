@@ -0,0 +1,114 @@
+#include "simulation_runner.h"
+#include "simulation.h"
+#include "event_trace.h"
+#include "loss_surrogate.h"
+#include "failure_model.h"
+#include "failure_strata.h"
+#include "../utils/logger.h"
+
+namespace arctic {
+
+namespace {
+
+// Калибровочные прогоны берут seed'ы из своего потока, не пересекающегося с прогонами Simulation.
+const Ui64 kCalibrationSeedSalt = 0x6a09e667f3bcc908ull;
+
+} // namespace
+
+SimulationResult RunSingleSimulation(const TSimulationConfig& config, Ui64 baseSeed, Ui64 simIndex,
+                                     const std::atomic<bool>* cancel) {
+    // Seed определяется номером прогона, поэтому оценку можно продолжить с чекпоинта.
+    const Ui64 seed = MakeRunSeed(baseSeed, simIndex);
+
+    // Модель живёт в потоке и сбрасывается на месте, так что прогон после
+    // первого на тех же параметрах не выделяет память.
+    thread_local static Simulation localSim;
+    localSim.Reset(config);
+    thread_local static TRandomStream rng;
+    rng.Seed(seed);
+    localSim.StartReplay(rng);
+
+    thread_local static TFailureStrata strata;
+    const bool stratified = config.StratifiedSampling && strata.Build(config.Params);
+    SimulationResult result;
+    // Дополнительные к floor(r) отказы страты раскладываются по часам выборкой без возвращения.
+    const Si32 baseFailures = config.BaseFailuresPerHour;
+    Ui32 extraFailuresLeft = 0;
+    if (stratified) {
+        result.stratum = static_cast<Si32>(strata.PickStratum(simIndex));
+        result.stratumWeight = strata.GetWeight(result.stratum);
+        extraFailuresLeft = strata.DrawFailureCount(result.stratum, rng);
+    }
+
+    // Контрольная переменная нужна закону отказов, известному суррогату, то есть постоянной интенсивности.
+    thread_local static TLossSurrogate surrogate;
+    const bool useControl = config.ControlCalibrationRuns > 0 && config.Params.HazardModel == kHazardConstant && !stratified;
+    localSim.Surrogate = nullptr;
+    if (useControl) {
+        surrogate.Reset(localSim);
+        localSim.Surrogate = &surrogate;
+    }
+
+    TTraceRecorder& recorder = TTraceRecorder::ThreadLocal();
+    localSim.Recorder = nullptr;
+    if (config.RecordTraces) {
+        recorder.BeginRun(seed, config.Params);
+        localSim.Recorder = &recorder;
+    }
+
+    bool hadDataLoss = false;
+    bool cancelled = false;
+
+    const Ui32 horizonHours = config.Params.HorizonHours;
+    for (Ui32 hour = 0; hour < horizonHours; ++hour) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            cancelled = true;
+            break;
+        }
+        result.hoursSimulated++;
+        if (stratified) {
+            Si32 failures = baseFailures;
+            if (rng.NextUniform() * (horizonHours - hour) < extraFailuresLeft) {
+                ++failures;
+                --extraFailuresLeft;
+            }
+            localSim.SimulateHour(failures, rng);
+        } else {
+            localSim.SimulateHour(rng);
+        }
+        if (!localSim.LostGroupInfo.empty()) {
+            result.lossHour = hour;
+            hadDataLoss = true;
+            break;
+        }
+    }
+
+    result.extraFailureHours = localSim.ExtraFailureHours;
+
+    if (useControl && !cancelled) {
+        // Отказы не зависят от состояния групп, так что после потери горизонт досчитывает суррогат.
+        surrogate.SimulateFailures(result.hoursSimulated, horizonHours, rng);
+        for (Ui32 window = 0; window < kControlWindows; ++window) {
+            result.controlLossHour[window] = surrogate.GetLossHour(window);
+        }
+        result.calibrationRuns = std::min(config.ControlCalibrationRuns, kMaxCalibrationRuns);
+        thread_local static TRandomStream calibrationRng;
+        for (Ui32 run = 0; run < result.calibrationRuns; ++run) {
+            calibrationRng.Seed(MakeRunSeed(baseSeed ^ kCalibrationSeedSalt, simIndex * kMaxCalibrationRuns + run));
+            surrogate.Restart();
+            surrogate.SimulateFailures(0, horizonHours, calibrationRng);
+            for (Ui32 window = 0; window < kControlWindows; ++window) {
+                result.calibrationLossHour[run][window] = surrogate.GetLossHour(window);
+            }
+        }
+    }
+
+    if (config.RecordTraces) {
+        // Сохраняем только прогоны с потерей данных, остальные выбрасываются из памяти.
+        recorder.EndRun(hadDataLoss);
+    }
+
+    return result;
+}
+
+} // namespace arctic
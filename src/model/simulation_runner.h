@@ -0,0 +1,15 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include "simulation_params.h"
+#include "simulation_stats.h"
+#include <atomic>
+
+namespace arctic {
+
+// Один прогон на HorizonHours часов с seed'ом MakeRunSeed(baseSeed, simIndex).
+// Результат зависит только от config и индекса, а не от потока или процесса.
+// Если cancel выставлен, прогон обрывается и его результат нужно выбросить.
+SimulationResult RunSingleSimulation(const TSimulationConfig& config, Ui64 baseSeed, Ui64 simIndex,
+                                     const std::atomic<bool>* cancel = nullptr);
+
+} // namespace arctic
@@ -0,0 +1,491 @@
+#include "simulation_stats.h"
+#include "varint.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace arctic {
+
+namespace {
+
+const Ui32 kSubBucketBits = 6;
+const Ui64 kSubBuckets = 1ull << kSubBucketBits;
+
+} // namespace
+
+Ui32 TLossTimeHistogram::GetBucket(Ui64 hours) {
+    if (hours < kSubBuckets) {
+        return static_cast<Ui32>(hours);
+    }
+    const Ui32 exponent = 63 - std::countl_zero(hours);
+    const Ui64 subBucket = (hours >> (exponent - kSubBucketBits)) - kSubBuckets;
+    return static_cast<Ui32>(kSubBuckets + (exponent - kSubBucketBits) * kSubBuckets + subBucket);
+}
+
+Ui64 TLossTimeHistogram::GetBucketBegin(Ui32 bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    const Ui32 exponent = (bucket - kSubBuckets) / kSubBuckets + kSubBucketBits;
+    const Ui64 subBucket = (bucket - kSubBuckets) % kSubBuckets;
+    return (kSubBuckets + subBucket) << (exponent - kSubBucketBits);
+}
+
+void TLossTimeHistogram::Add(Ui64 hours, Ui64 count) {
+    Buckets[GetBucket(hours)] += count;
+    Count += count;
+}
+
+void TLossTimeHistogram::Merge(const TLossTimeHistogram& other) {
+    for (const auto& [bucket, count] : other.Buckets) {
+        Buckets[bucket] += count;
+    }
+    Count += other.Count;
+}
+
+void TLossTimeHistogram::Clear() {
+    Buckets.clear();
+    Count = 0;
+}
+
+Ui64 TLossTimeHistogram::GetCountUpTo(Ui64 hours) const {
+    Ui64 result = 0;
+    const Ui32 last = GetBucket(hours);
+    for (const auto& [bucket, count] : Buckets) {
+        if (bucket > last) {
+            break;
+        }
+        result += count;
+    }
+    return result;
+}
+
+Ui64 TLossTimeHistogram::GetQuantile(double q) const {
+    if (Count == 0) {
+        return 0;
+    }
+    const Ui64 rank = static_cast<Ui64>(q * (Count - 1));
+    Ui64 seen = 0;
+    for (const auto& [bucket, count] : Buckets) {
+        seen += count;
+        if (seen > rank) {
+            return GetBucketBegin(bucket);
+        }
+    }
+    return GetBucketBegin(Buckets.rbegin()->first);
+}
+
+void TLossTimeHistogram::Serialize(std::vector<Ui8>& out) const {
+    WriteVarint(out, Buckets.size());
+    for (const auto& [bucket, count] : Buckets) {
+        WriteVarint(out, bucket);
+        WriteVarint(out, count);
+    }
+}
+
+bool TLossTimeHistogram::Deserialize(const Ui8*& pos, const Ui8* end) {
+    Ui64 size = 0;
+    if (!ReadVarint(pos, end, size)) {
+        return false;
+    }
+    Clear();
+    for (Ui64 i = 0; i < size; ++i) {
+        Ui64 bucket = 0;
+        Ui64 count = 0;
+        if (!ReadVarint(pos, end, bucket) || !ReadVarint(pos, end, count)) {
+            return false;
+        }
+        Buckets[static_cast<Ui32>(bucket)] = count;
+        Count += count;
+    }
+    return true;
+}
+
+void TControlStats::Merge(const TControlStats& other) {
+    InRuns.Merge(other.InRuns);
+    Joint.Merge(other.Joint);
+    Calibration.Merge(other.Calibration);
+}
+
+void TControlStats::Clear() {
+    InRuns.Clear();
+    Joint.Clear();
+    Calibration.Clear();
+}
+
+void TControlStats::Serialize(std::vector<Ui8>& out) const {
+    InRuns.Serialize(out);
+    Joint.Serialize(out);
+    Calibration.Serialize(out);
+}
+
+bool TControlStats::Deserialize(const Ui8*& pos, const Ui8* end) {
+    return InRuns.Deserialize(pos, end) &&
+           Joint.Deserialize(pos, end) &&
+           Calibration.Deserialize(pos, end);
+}
+
+void TStratumStats::Merge(const TStratumStats& other) {
+    if (other.Sims > 0) {
+        Weight = other.Weight;
+    }
+    Sims += other.Sims;
+    ExposureHours += other.ExposureHours;
+    LossTimes.Merge(other.LossTimes);
+}
+
+void TStratumStats::Serialize(std::vector<Ui8>& out) const {
+    WriteVarint(out, std::bit_cast<Ui64>(Weight));
+    WriteVarint(out, Sims);
+    WriteVarint(out, ExposureHours);
+    LossTimes.Serialize(out);
+}
+
+bool TStratumStats::Deserialize(const Ui8*& pos, const Ui8* end) {
+    Ui64 weightBits = 0;
+    if (!ReadVarint(pos, end, weightBits) ||
+        !ReadVarint(pos, end, Sims) ||
+        !ReadVarint(pos, end, ExposureHours)) {
+        return false;
+    }
+    Weight = std::bit_cast<double>(weightBits);
+    return LossTimes.Deserialize(pos, end);
+}
+
+void TRunSummaries::Add(const TRunSummary& summary) {
+    Tail.push_back(summary);
+    if (Tail.size() == kChunkSize) {
+        Chunks.push_back(std::make_shared<const std::vector<TRunSummary>>(std::move(Tail)));
+        Tail = {};
+    }
+}
+
+void TRunSummaries::Append(const TRunSummaries& other, size_t count) {
+    count = std::min(count, other.Size());
+    size_t index = 0;
+    // Целые куски other берутся без копирования, пока свой хвост пуст.
+    for (; Tail.empty() && index + kChunkSize <= count; index += kChunkSize) {
+        Chunks.push_back(other.Chunks[index / kChunkSize]);
+    }
+    for (; index < count; ++index) {
+        Add(other[index]);
+    }
+}
+
+void TRunSummaries::Clear() {
+    Chunks.clear();
+    Tail.clear();
+}
+
+const TRunSummary& TRunSummaries::operator[](size_t index) const {
+    const size_t chunk = index / kChunkSize;
+    return chunk < Chunks.size() ? (*Chunks[chunk])[index % kChunkSize] : Tail[index - Chunks.size() * kChunkSize];
+}
+
+bool TRunSummaries::operator==(const TRunSummaries& other) const {
+    if (Size() != other.Size()) {
+        return false;
+    }
+    for (size_t i = 0; i < Size(); ++i) {
+        if (!((*this)[i] == other[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TSimulationStats::AddResult(const SimulationResult& result) {
+    Sims++;
+    ExposureHours += result.hoursSimulated;
+    if (result.lossHour >= 0) {
+        LossTimes.Add(static_cast<Ui64>(result.lossHour));
+    }
+    if (result.stratum < 0 && RunSummaries.Size() < kMaxRunSummaries) {
+        RunSummaries.Add({result.extraFailureHours, static_cast<Ui32>(result.hoursSimulated), result.lossHour});
+    }
+    if (result.stratum >= 0) {
+        if (Strata.size() <= static_cast<size_t>(result.stratum)) {
+            Strata.resize(result.stratum + 1);
+        }
+        TStratumStats& stratum = Strata[result.stratum];
+        stratum.Weight = result.stratumWeight;
+        stratum.Sims++;
+        stratum.ExposureHours += result.hoursSimulated;
+        if (result.lossHour >= 0) {
+            stratum.LossTimes.Add(static_cast<Ui64>(result.lossHour));
+        }
+    }
+    if (result.calibrationRuns == 0) {
+        return;
+    }
+    CalibrationSims += result.calibrationRuns;
+    for (Ui32 window = 0; window < kControlWindows; ++window) {
+        TControlStats& control = Controls[window];
+        const Si64 controlHour = result.controlLossHour[window];
+        if (controlHour >= 0) {
+            control.InRuns.Add(static_cast<Ui64>(controlHour));
+            if (result.lossHour >= 0) {
+                control.Joint.Add(static_cast<Ui64>(std::max(controlHour, result.lossHour)));
+            }
+        }
+        for (Ui32 run = 0; run < result.calibrationRuns; ++run) {
+            if (result.calibrationLossHour[run][window] >= 0) {
+                control.Calibration.Add(static_cast<Ui64>(result.calibrationLossHour[run][window]));
+            }
+        }
+    }
+}
+
+void TSimulationStats::Merge(const TSimulationStats& other) {
+    Sims += other.Sims;
+    ExposureHours += other.ExposureHours;
+    LossTimes.Merge(other.LossTimes);
+    CalibrationSims += other.CalibrationSims;
+    for (Ui32 window = 0; window < kControlWindows; ++window) {
+        Controls[window].Merge(other.Controls[window]);
+    }
+    if (Strata.size() < other.Strata.size()) {
+        Strata.resize(other.Strata.size());
+    }
+    for (size_t stratum = 0; stratum < other.Strata.size(); ++stratum) {
+        Strata[stratum].Merge(other.Strata[stratum]);
+    }
+    RunSummaries.Append(other.RunSummaries, kMaxRunSummaries - RunSummaries.Size());
+}
+
+void TSimulationStats::Clear() {
+    LossTimes.Clear();
+    Sims = 0;
+    ExposureHours = 0;
+    CalibrationSims = 0;
+    for (TControlStats& control : Controls) {
+        control.Clear();
+    }
+    Strata.clear();
+    RunSummaries.Clear();
+}
+
+double TSimulationStats::GetLossProbability(Ui64 hours) const {
+    if (IsStratified()) {
+        return GetLossEstimate(hours).Probability;
+    }
+    return Sims > 0 ? static_cast<double>(LossTimes.GetCountUpTo(hours)) / Sims : 0.0;
+}
+
+TLossEstimate TSimulationStats::GetLossEstimate(Ui64 hours) const {
+    return TLossEstimateCursor(*this).Advance(hours);
+}
+
+void TLossEstimateCursor::THistogramCursor::Init(const TLossTimeHistogram& histogram) {
+    It = histogram.GetBuckets().begin();
+    End = histogram.GetBuckets().end();
+    Count = 0;
+}
+
+Ui64 TLossEstimateCursor::THistogramCursor::AdvanceTo(Ui32 bucket) {
+    for (; It != End && It->first <= bucket; ++It) {
+        Count += It->second;
+    }
+    return Count;
+}
+
+TLossEstimateCursor::TLossEstimateCursor(const TSimulationStats& stats)
+    : Stats(stats)
+{
+    Loss.Init(stats.LossTimes);
+    StrataLoss.resize(stats.Strata.size());
+    for (size_t stratum = 0; stratum < stats.Strata.size(); ++stratum) {
+        StrataLoss[stratum].Init(stats.Strata[stratum].LossTimes);
+    }
+    for (Ui32 window = 0; window < kControlWindows; ++window) {
+        InRuns[window].Init(stats.Controls[window].InRuns);
+        Joint[window].Init(stats.Controls[window].Joint);
+        Calibration[window].Init(stats.Controls[window].Calibration);
+    }
+}
+
+TLossEstimate TLossEstimateCursor::Advance(Ui64 hours) {
+    TLossEstimate estimate;
+    if (Stats.Sims == 0) {
+        return estimate;
+    }
+    const Ui32 bucket = TLossTimeHistogram::GetBucket(hours);
+    if (Stats.IsStratified()) {
+        return AdvanceStratified(bucket);
+    }
+    const double sims = static_cast<double>(Stats.Sims);
+    const double loss = Loss.AdvanceTo(bucket) / sims;
+    const double plainVariance = loss * (1.0 - loss) / sims;
+    estimate.Probability = loss;
+    estimate.StdError = std::sqrt(plainVariance);
+    if (!Stats.HasControl()) {
+        return estimate;
+    }
+
+    // Y - потеря прогона, C - потеря суррогата к тому же часу, E[C] = mean по калибровке.
+    // Оценка Y - beta * (C - mean) несмещена при любом beta, а beta = cov(Y, C) / var(C)
+    // минимизирует её дисперсию; к ней добавляется ошибка самого mean.
+    const double calibrationSims = static_cast<double>(Stats.CalibrationSims);
+    double bestVariance = plainVariance;
+    for (Ui32 window = 0; window < kControlWindows; ++window) {
+        const double controlLoss = InRuns[window].AdvanceTo(bucket) / sims;
+        const double joint = Joint[window].AdvanceTo(bucket) / sims;
+        const double mean = Calibration[window].AdvanceTo(bucket) / calibrationSims;
+        const double controlVariance = controlLoss * (1.0 - controlLoss);
+        if (plainVariance <= 0 || controlVariance <= 0) {
+            continue;
+        }
+        const double covariance = joint - loss * controlLoss;
+        const double beta = covariance / controlVariance;
+        const double variance = (loss * (1.0 - loss) - covariance * beta) / sims +
+                                beta * beta * mean * (1.0 - mean) / calibrationSims;
+        if (variance < bestVariance) {
+            bestVariance = variance;
+            estimate.Probability = std::clamp(loss - beta * (controlLoss - mean), 0.0, 1.0);
+        }
+    }
+    estimate.StdError = std::sqrt(std::max(bestVariance, 0.0));
+    estimate.VarianceReduction = bestVariance > 0 ? plainVariance / bestVariance : 1.0;
+    return estimate;
+}
+
+TLossEstimate TLossEstimateCursor::AdvanceStratified(Ui32 bucket) {
+    // Страты без прогонов пропускаются, и веса остальных нормируются на их сумму.
+    double weight = 0.0;
+    double probability = 0.0;
+    double variance = 0.0;
+    for (size_t s = 0; s < Stats.Strata.size(); ++s) {
+        const TStratumStats& stratum = Stats.Strata[s];
+        const Ui64 losses = StrataLoss[s].AdvanceTo(bucket);
+        if (stratum.Sims == 0) {
+            continue;
+        }
+        const double loss = static_cast<double>(losses) / stratum.Sims;
+        weight += stratum.Weight;
+        probability += stratum.Weight * loss;
+        variance += stratum.Weight * stratum.Weight * loss * (1.0 - loss) / stratum.Sims;
+    }
+    TLossEstimate estimate;
+    if (weight <= 0) {
+        return estimate;
+    }
+    estimate.Probability = probability / weight;
+    variance /= weight * weight;
+    estimate.StdError = std::sqrt(variance);
+    // Сравнение с независимыми прогонами того же числа.
+    const double plainVariance = estimate.Probability * (1.0 - estimate.Probability) / Stats.Sims;
+    estimate.VarianceReduction = variance > 0 ? plainVariance / variance : 1.0;
+    return estimate;
+}
+
+double TSimulationStats::GetMeanTimeToDataLoss() const {
+    if (IsStratified()) {
+        double exposure = 0.0;
+        double losses = 0.0;
+        for (const TStratumStats& stratum : Strata) {
+            if (stratum.Sims > 0) {
+                exposure += stratum.Weight * stratum.ExposureHours / stratum.Sims;
+                losses += stratum.Weight * stratum.LossTimes.GetCount() / stratum.Sims;
+            }
+        }
+        return losses > 0 ? exposure / losses : std::numeric_limits<double>::infinity();
+    }
+    if (GetLossCount() == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return static_cast<double>(ExposureHours) / GetLossCount();
+}
+
+Ui64 TSimulationStats::GetLossTimeQuantile(double q) const {
+    if (!IsStratified()) {
+        return LossTimes.GetQuantile(q);
+    }
+    std::map<Ui32, double> weighted;
+    double total = 0.0;
+    for (const TStratumStats& stratum : Strata) {
+        if (stratum.Sims == 0) {
+            continue;
+        }
+        const double scale = stratum.Weight / stratum.Sims;
+        for (const auto& [bucket, count] : stratum.LossTimes.GetBuckets()) {
+            weighted[bucket] += count * scale;
+            total += count * scale;
+        }
+    }
+    if (weighted.empty()) {
+        return 0;
+    }
+    const double rank = q * total;
+    double seen = 0.0;
+    for (const auto& [bucket, weight] : weighted) {
+        seen += weight;
+        if (seen > rank) {
+            return TLossTimeHistogram::GetBucketBegin(bucket);
+        }
+    }
+    return TLossTimeHistogram::GetBucketBegin(weighted.rbegin()->first);
+}
+
+void TSimulationStats::Serialize(std::vector<Ui8>& out) const {
+    WriteVarint(out, Sims);
+    WriteVarint(out, ExposureHours);
+    LossTimes.Serialize(out);
+    WriteVarint(out, CalibrationSims);
+    for (const TControlStats& control : Controls) {
+        control.Serialize(out);
+    }
+    WriteVarint(out, Strata.size());
+    for (const TStratumStats& stratum : Strata) {
+        stratum.Serialize(out);
+    }
+    WriteVarint(out, RunSummaries.Size());
+    for (size_t i = 0; i < RunSummaries.Size(); ++i) {
+        const TRunSummary& summary = RunSummaries[i];
+        WriteVarint(out, summary.ExtraFailureHours);
+        WriteVarint(out, summary.HoursSimulated);
+        // Час потери со сдвигом на 1, чтобы -1 (без потери) легло в беззнаковый varint.
+        WriteVarint(out, static_cast<Ui64>(summary.LossHour + 1));
+    }
+}
+
+bool TSimulationStats::Deserialize(const Ui8*& pos, const Ui8* end) {
+    if (!ReadVarint(pos, end, Sims) ||
+        !ReadVarint(pos, end, ExposureHours) ||
+        !LossTimes.Deserialize(pos, end) ||
+        !ReadVarint(pos, end, CalibrationSims)) {
+        return false;
+    }
+    for (TControlStats& control : Controls) {
+        if (!control.Deserialize(pos, end)) {
+            return false;
+        }
+    }
+    Ui64 strata = 0;
+    if (!ReadVarint(pos, end, strata) || strata > kMaxFailureStrata) {
+        return false;
+    }
+    Strata.resize(strata);
+    for (TStratumStats& stratum : Strata) {
+        if (!stratum.Deserialize(pos, end)) {
+            return false;
+        }
+    }
+    Ui64 summaries = 0;
+    if (!ReadVarint(pos, end, summaries) || summaries > kMaxRunSummaries) {
+        return false;
+    }
+    RunSummaries.Clear();
+    for (Ui64 i = 0; i < summaries; ++i) {
+        Ui64 failures = 0;
+        Ui64 hours = 0;
+        Ui64 lossHour = 0;
+        if (!ReadVarint(pos, end, failures) || !ReadVarint(pos, end, hours) || !ReadVarint(pos, end, lossHour)) {
+            return false;
+        }
+        RunSummaries.Add({static_cast<Ui32>(failures), static_cast<Ui32>(hours), static_cast<Si64>(lossHour) - 1});
+    }
+    return true;
+}
+
+} // namespace arctic
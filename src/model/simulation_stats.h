@@ -0,0 +1,199 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace arctic {
+
+// Окон суррогатной модели потерь (TLossSurrogate) и предел калибровочных прогонов на прогон.
+constexpr Ui32 kControlWindows = 4;
+constexpr Ui32 kMaxCalibrationRuns = 32;
+// Наибольшее число страт TFailureStrata.
+constexpr Ui32 kMaxFailureStrata = 8;
+// Сколько первых прогонов хранят сводку TRunSummary для пересчёта на другую интенсивность.
+constexpr Ui32 kMaxRunSummaries = 1 << 17;
+
+struct SimulationResult {
+    Si64 lossHour = -1;
+    Ui64 hoursSimulated = 0;
+    // Контрольная переменная: часы потери суррогатной модели на отказах этого прогона
+    // и в calibrationRuns независимых прогонах одной модели, -1 - потери не было.
+    std::array<Si64, kControlWindows> controlLossHour = {};
+    Ui32 calibrationRuns = 0;
+    std::array<std::array<Si64, kControlWindows>, kMaxCalibrationRuns> calibrationLossHour = {};
+    // Страта стратифицированной выборки и её вероятность, -1 - независимый прогон.
+    Si32 stratum = -1;
+    double stratumWeight = 0.0;
+    // Часы с отказом сверх floor(GFailureRate / 24) среди hoursSimulated.
+    Ui32 extraFailureHours = 0;
+};
+
+// Всё, от чего зависит отношение правдоподобий прогона при другой постоянной
+// интенсивности отказов: остальная случайность прогона от неё не зависит.
+struct TRunSummary {
+    Ui32 ExtraFailureHours = 0;
+    Ui32 HoursSimulated = 0;
+    Si64 LossHour = -1;
+
+    bool operator==(const TRunSummary&) const = default;
+};
+
+// Сводки прогонов кусками по kChunkSize. Заполненные куски неизменяемы и общие у всех
+// копий, поэтому копия статистики (снимок движка для интерфейса) копирует указатели
+// и только недописанный хвост, а не все сводки.
+class TRunSummaries {
+public:
+    static constexpr size_t kChunkSize = 1024;
+
+    void Add(const TRunSummary& summary);
+    // Дописывает первые count сводок other.
+    void Append(const TRunSummaries& other, size_t count);
+    void Clear();
+
+    size_t Size() const { return Chunks.size() * kChunkSize + Tail.size(); }
+    bool Empty() const { return Chunks.empty() && Tail.empty(); }
+    const TRunSummary& operator[](size_t index) const;
+
+    bool operator==(const TRunSummaries& other) const;
+
+private:
+    std::vector<std::shared_ptr<const std::vector<TRunSummary>>> Chunks;
+    std::vector<TRunSummary> Tail;
+};
+
+// Гистограмма времени до первой потери в часах с логарифмическими корзинами:
+// до 64 часов корзина на каждый час, дальше по 64 корзины на удвоение, то есть
+// относительная погрешность не больше 1/64. Число корзин растёт с логарифмом
+// горизонта и не зависит от числа прогонов.
+class TLossTimeHistogram {
+public:
+    static Ui32 GetBucket(Ui64 hours);
+    static Ui64 GetBucketBegin(Ui32 bucket);
+
+    void Add(Ui64 hours, Ui64 count = 1);
+    void Merge(const TLossTimeHistogram& other);
+    void Clear();
+
+    Ui64 GetCount() const { return Count; }
+    // Число значений, не превосходящих hours, с точностью до корзины.
+    Ui64 GetCountUpTo(Ui64 hours) const;
+    // Значение, ниже которого лежит доля q значений, по нижней границе корзины.
+    Ui64 GetQuantile(double q) const;
+    const std::map<Ui32, Ui64>& GetBuckets() const { return Buckets; }
+
+    void Serialize(std::vector<Ui8>& out) const;
+    bool Deserialize(const Ui8*& pos, const Ui8* end);
+
+    bool operator==(const TLossTimeHistogram&) const = default;
+
+private:
+    std::map<Ui32, Ui64> Buckets;
+    Ui64 Count = 0;
+};
+
+// Одно окно контрольной переменной. Из настоящих прогонов нужны потери суррогата
+// и совместные потери, из калибровочных - только потери суррогата.
+struct TControlStats {
+    TLossTimeHistogram InRuns;
+    // max(час потери прогона, час потери суррогата) по прогонам, где были обе.
+    TLossTimeHistogram Joint;
+    TLossTimeHistogram Calibration;
+
+    void Merge(const TControlStats& other);
+    void Clear();
+    void Serialize(std::vector<Ui8>& out) const;
+    bool Deserialize(const Ui8*& pos, const Ui8* end);
+
+    bool operator==(const TControlStats&) const = default;
+};
+
+// Прогоны одной страты TFailureStrata; общая оценка - сумма оценок страт с весами Weight.
+struct TStratumStats {
+    double Weight = 0.0;
+    Ui64 Sims = 0;
+    Ui64 ExposureHours = 0;
+    TLossTimeHistogram LossTimes;
+
+    void Merge(const TStratumStats& other);
+    void Serialize(std::vector<Ui8>& out) const;
+    bool Deserialize(const Ui8*& pos, const Ui8* end);
+
+    bool operator==(const TStratumStats&) const = default;
+};
+
+struct TLossEstimate {
+    double Probability = 0.0;
+    double StdError = 0.0;
+    // Во сколько раз дисперсия меньше, чем у доли прогонов с потерей по тем же прогонам.
+    double VarianceReduction = 1.0;
+};
+
+// Накопленная статистика оценки. Статистики независимых прогонов складываются через Merge.
+struct TSimulationStats {
+    TLossTimeHistogram LossTimes;
+    Ui64 Sims = 0;
+    // Суммарное время наблюдения всех прогонов для оценки MTTDL с учётом цензурирования.
+    Ui64 ExposureHours = 0;
+    std::array<TControlStats, kControlWindows> Controls;
+    Ui64 CalibrationSims = 0;
+    // Непусто при стратифицированной выборке; LossTimes и ExposureHours выше тогда
+    // смещены к стратам с большей долей прогонов, и оценки берутся по стратам.
+    std::vector<TStratumStats> Strata;
+    // Сводки первых kMaxRunSummaries независимых прогонов для ReweightFailureRate.
+    TRunSummaries RunSummaries;
+
+    void AddResult(const SimulationResult& result);
+    void Merge(const TSimulationStats& other);
+    void Clear();
+
+    Ui64 GetLossCount() const { return LossTimes.GetCount(); }
+    // Вероятность потери не позже hours часов от начала прогона.
+    double GetLossProbability(Ui64 hours) const;
+    // Та же вероятность с контрольной переменной, если она собрана: доля потерь
+    // поправляется на отклонение потерь суррогата от его среднего по калибровке.
+    // Берётся окно с наименьшей дисперсией оценки.
+    TLossEstimate GetLossEstimate(Ui64 hours) const;
+    bool HasControl() const { return CalibrationSims > 0; }
+    bool IsStratified() const { return !Strata.empty(); }
+    // MTTDL в часах: время наблюдения на одну потерю, бесконечность при отсутствии потерь.
+    double GetMeanTimeToDataLoss() const;
+    // Квантиль времени до потери среди прогонов с потерей, с весами страт.
+    Ui64 GetLossTimeQuantile(double q) const;
+
+    // Компактная varint-сериализация для чекпоинтов и обмена между процессами.
+    void Serialize(std::vector<Ui8>& out) const;
+    bool Deserialize(const Ui8*& pos, const Ui8* end);
+
+    bool operator==(const TSimulationStats&) const = default;
+};
+
+// Оценки GetLossEstimate для неубывающих hours за один проход по гистограммам,
+// чтобы кривая по всем корзинам строилась за линейное время.
+class TLossEstimateCursor {
+public:
+    explicit TLossEstimateCursor(const TSimulationStats& stats);
+    TLossEstimate Advance(Ui64 hours);
+
+private:
+    struct THistogramCursor {
+        std::map<Ui32, Ui64>::const_iterator It;
+        std::map<Ui32, Ui64>::const_iterator End;
+        Ui64 Count = 0;
+
+        void Init(const TLossTimeHistogram& histogram);
+        Ui64 AdvanceTo(Ui32 bucket);
+    };
+
+    TLossEstimate AdvanceStratified(Ui32 bucket);
+
+    const TSimulationStats& Stats;
+    THistogramCursor Loss;
+    std::vector<THistogramCursor> StrataLoss;
+    std::array<THistogramCursor, kControlWindows> InRuns;
+    std::array<THistogramCursor, kControlWindows> Joint;
+    std::array<THistogramCursor, kControlWindows> Calibration;
+};
+
+} // namespace arctic
@@ -0,0 +1,54 @@
+#include "topology.h"
+#include <algorithm>
+
+namespace arctic {
+
+void TTopology::Build(Ui32 numDCs, Ui32 pdisksPerDc, Ui32 racksPerDc, Ui32 disksPerHost) {
+    disksPerHost = std::max<Ui32>(1, disksPerHost);
+    const Ui32 hostsPerDc = (pdisksPerDc + disksPerHost - 1) / disksPerHost;
+    racksPerDc = std::max<Ui32>(1, std::min(racksPerDc, std::max<Ui32>(1, hostsPerDc)));
+
+    for (Ui32 level = 0; level < kDomainLevelCount; ++level) {
+        Domains[level].clear();
+        DomainOf[level].assign(numDCs * pdisksPerDc, 0);
+    }
+
+    for (Ui32 dc = 0; dc < numDCs; ++dc) {
+        const Ui32 dcBegin = dc * pdisksPerDc;
+        Domains[kDomainDC].push_back({dcBegin, dcBegin + pdisksPerDc, dc});
+
+        for (Ui32 rack = 0; rack < racksPerDc; ++rack) {
+            const Ui32 firstHost = rack * hostsPerDc / racksPerDc;
+            const Ui32 lastHost = (rack + 1) * hostsPerDc / racksPerDc;
+            const Ui32 rackIndex = Domains[kDomainRack].size();
+            const Ui32 rackBegin = dcBegin + std::min(pdisksPerDc, firstHost * disksPerHost);
+            const Ui32 rackEnd = dcBegin + std::min(pdisksPerDc, lastHost * disksPerHost);
+            Domains[kDomainRack].push_back({rackBegin, rackEnd, dc});
+
+            for (Ui32 host = firstHost; host < lastHost; ++host) {
+                const Ui32 hostIndex = Domains[kDomainHost].size();
+                const Ui32 hostBegin = dcBegin + host * disksPerHost;
+                const Ui32 hostEnd = dcBegin + std::min(pdisksPerDc, (host + 1) * disksPerHost);
+                Domains[kDomainHost].push_back({hostBegin, hostEnd, rackIndex});
+                for (Ui32 pdisk = hostBegin; pdisk < hostEnd; ++pdisk) {
+                    DomainOf[kDomainDC][pdisk] = dc;
+                    DomainOf[kDomainRack][pdisk] = rackIndex;
+                    DomainOf[kDomainHost][pdisk] = hostIndex;
+                }
+            }
+        }
+    }
+}
+
+Ui32 TTopology::GetDomainsInDC(EFailDomainLevel level, Ui32 dc) const {
+    if (level == kDomainDC) {
+        return 1;
+    }
+    const TFailDomain& range = Domains[kDomainDC][dc];
+    if (range.Begin == range.End) {
+        return 0;
+    }
+    return DomainOf[level][range.End - 1] - DomainOf[level][range.Begin] + 1;
+}
+
+} // namespace arctic
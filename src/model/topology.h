@@ -0,0 +1,40 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <vector>
+
+namespace arctic {
+
+enum EFailDomainLevel : Ui32 {
+    kDomainDC = 0,
+    kDomainRack,
+    kDomainHost,
+    kDomainLevelCount
+};
+
+// Домен отказа - непрерывный диапазон индексов PDisk [Begin, End).
+struct TFailDomain {
+    Ui32 Begin = 0;
+    Ui32 End = 0;
+    Ui32 Parent = 0;
+};
+
+// Плоское дерево доменов DC -> rack -> host. PDisk'и нумеруются по DC подряд,
+// внутри DC хосты идут подряд и делятся между стойками поровну, поэтому любой
+// домен - это диапазон индексов, а домен PDisk'а ищется за O(1).
+class TTopology {
+public:
+    void Build(Ui32 numDCs, Ui32 pdisksPerDc, Ui32 racksPerDc, Ui32 disksPerHost);
+
+    Ui32 GetDomain(EFailDomainLevel level, Ui32 pdiskIndex) const { return DomainOf[level][pdiskIndex]; }
+    const TFailDomain& GetDomainRange(EFailDomainLevel level, Ui32 domain) const { return Domains[level][domain]; }
+    Ui32 GetDomainCount(EFailDomainLevel level) const { return Domains[level].size(); }
+    // Число доменов уровня level внутри одного DC.
+    Ui32 GetDomainsInDC(EFailDomainLevel level, Ui32 dc) const;
+    Ui32 GetPDiskCount() const { return DomainOf[kDomainDC].size(); }
+
+private:
+    std::vector<TFailDomain> Domains[kDomainLevelCount];
+    std::vector<Ui32> DomainOf[kDomainLevelCount];
+};
+
+} // namespace arctic
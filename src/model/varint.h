@@ -0,0 +1,37 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <vector>
+
+namespace arctic {
+
+inline void WriteVarint(std::vector<Ui8>& out, Ui64 value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<Ui8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<Ui8>(value));
+}
+
+inline bool ReadVarint(const Ui8*& pos, const Ui8* end, Ui64& value) {
+    value = 0;
+    for (Ui32 shift = 0; shift < 64 && pos < end; shift += 7) {
+        Ui8 byte = *pos++;
+        value |= static_cast<Ui64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Контрольная сумма и ключи сериализованных данных.
+inline Ui64 Fnv1a(const Ui8* data, size_t size) {
+    Ui64 hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace arctic
@@ -13,11 +13,12 @@ void TVDisk::AssignToGroup(TGroupId groupId) {
 }
 
 void TVDisk::SetState(VDiskState state) {
-    State = state;
-    if (State != VDiskState::Replicating) {
-
-
+    // Новый отказ после завершённой репликации требует новой репликации.
+    if (state == VDiskState::Faulty && State != VDiskState::Faulty) {
+        ReplicationTriggered = false;
+        ReplicationCompleteTime = 0;
     }
+    State = state;
 }
 
 TVDisk::VDiskState TVDisk::GetState() const {
@@ -55,4 +56,11 @@ void TVDisk::MarkReplicationTriggered(double completeTime) {
     }
 }
 
-} 
+void TVDisk::Reset() {
+    State = VDiskState::Active;
+    ReplicationTriggered = false;
+    ReplicationCompleteTime = 0;
+    OfflineDomains = 0;
+}
+
+}
@@ -29,6 +29,13 @@ public:
     bool IsReplicationTriggered() const { return ReplicationTriggered; }
     double GetReplicationCompleteTime() const { return ReplicationCompleteTime; }
     void MarkReplicationTriggered(double completeTime);
+    // Возврат к начальному состоянию прогона; размещение и группа сохраняются.
+    void Reset();
+    // VDisk недоступен, пока его PDisk входит хотя бы в один домен под аварией.
+    void SetOffline(bool offline) { offline ? ++OfflineDomains : --OfflineDomains; }
+    bool IsOffline() const { return OfflineDomains > 0; }
+    // Копия недоступна для чтения: сломана, ещё восстанавливается или за аварией домена.
+    bool IsFailed() const { return State == Faulty || State == Replicating || IsOffline(); }
 
 private:
     TVDiskId Id;
@@ -38,6 +45,7 @@ private:
     VDiskState State = Active;
     bool ReplicationTriggered = false;
     double ReplicationCompleteTime = 0;
+    Ui8 OfflineDomains = 0;
 };
 
 } // namespace arctic
\ No newline at end of file
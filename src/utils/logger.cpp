@@ -3,9 +3,10 @@
 #include <sstream>
 #include <fstream>
 #include <mutex>
-#include <deque>
 #include <vector>
 #include <algorithm>
+#include <filesystem>
+#include <new>
 
 namespace arctic {
 
@@ -15,18 +16,33 @@ size_t Logger::maxLogLines = 1000;
 std::string Logger::logFilename;
 Logger::OutputMode Logger::outputMode = Logger::OutputMode::BOTH;
 std::mutex Logger::logMutex;
-size_t Logger::logCallsSinceLastTrim = 0;
+size_t Logger::linesInSegment = 0;
+size_t Logger::segmentMaxLines = 1000 / (Logger::kLogSegments + 1);
+bool Logger::rotationFailed = false;
+std::atomic<bool> Logger::debugEnabled{false};
 
-void Logger::Init(const std::string& filename, size_t maxLines /*= 300 (параметр больше не используется)*/, OutputMode mode /*= OutputMode::BOTH*/) {
+void Logger::Init(const std::string& filename, size_t maxLines /*= 1000 (суммарно по всем сегментам)*/, OutputMode mode /*= OutputMode::BOTH*/) {
     std::lock_guard<std::mutex> lock(logMutex);
+    InitLocked(filename, maxLines, mode);
+}
+
+void Logger::InitLocked(const std::string& filename, size_t maxLines, OutputMode mode) {
     if (!initialized) {
         maxLogLines = maxLines;
         logFilename = filename;
         outputMode = mode;
-        logCallsSinceLastTrim = 0;
+        linesInSegment = 0;
+        rotationFailed = false;
+        segmentMaxLines = std::max<size_t>(1, maxLogLines / (kLogSegments + 1));
 
         if (outputMode != OutputMode::CONSOLE_ONLY && !logFilename.empty()) {
-            file.open(logFilename, std::ios::out | std::ios::app);
+            // Содержимое прошлого запуска уходит в архивный сегмент, его строки мы не пересчитываем.
+            std::error_code ec;
+            if (maxLogLines > 0 && std::filesystem::exists(logFilename, ec) && std::filesystem::file_size(logFilename, ec) > 0) {
+                RotateLogFile();
+            } else {
+                file.open(logFilename, std::ios::out | std::ios::app);
+            }
             if (!file.is_open()) {
                 std::cerr << "ERROR: Could not open log file for appending: " << logFilename << std::endl;
             }
@@ -51,6 +67,27 @@ void Logger::SetOutputMode(OutputMode mode) {
     outputMode = mode;
 }
 
+void Logger::Close() {
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (file.is_open()) {
+        file.close();
+    }
+    initialized = false;
+}
+
+void Logger::DetachFileAfterFork() {
+    // Мьютекс мог быть захвачен другим потоком родителя в момент fork, а в ребёнке
+    // этого потока нет. Ребёнок однопоточный, поэтому мьютекс просто создаётся заново.
+    new (&logMutex) std::mutex();
+    if (file.is_open()) {
+        // Буфер пуст: WriteToLog сбрасывает его после каждого сообщения.
+        file.close();
+    }
+    initialized = true;
+    outputMode = OutputMode::CONSOLE_ONLY;
+    linesInSegment = 0;
+}
+
 void Logger::WriteToLog(const std::string& message) {
     if (outputMode != OutputMode::CONSOLE_ONLY && file.is_open()) {
         file << message;
@@ -58,7 +95,13 @@ void Logger::WriteToLog(const std::string& message) {
     }
 }
 
-void Logger::TrimLogFile() {
+std::string Logger::SegmentName(size_t index) {
+    return logFilename + "." + std::to_string(index);
+}
+
+// Ротация стоит kLogSegments переименований и не зависит от объёма лога:
+// старые строки никогда не перечитываются и не переписываются.
+void Logger::RotateLogFile() {
     if (outputMode == OutputMode::CONSOLE_ONLY || logFilename.empty() || maxLogLines == 0) {
         return;
     }
@@ -67,45 +110,54 @@ void Logger::TrimLogFile() {
         file.close();
     }
 
-    std::deque<std::string> lines;
-    std::ifstream infile(logFilename);
-    std::string line;
-    size_t lineCount = 0;
-
-    if (infile.is_open()) {
-        while (std::getline(infile, line)) {
-            lines.push_back(line);
-            lineCount++;
-            if (lines.size() > maxLogLines) {
-                lines.pop_front();
-            }
+    std::error_code ec;
+    std::filesystem::remove(SegmentName(kLogSegments - 1), ec);
+    for (size_t index = kLogSegments - 1; index > 0; --index) {
+        // Сегментов может ещё не быть, это не ошибка.
+        if (!std::filesystem::exists(SegmentName(index - 1), ec)) {
+            continue;
+        }
+        std::filesystem::rename(SegmentName(index - 1), SegmentName(index), ec);
+        if (ec) {
+            std::cerr << "ERROR: Could not rotate log segment: " << SegmentName(index - 1) << ": " << ec.message() << std::endl;
+        }
+    }
+    std::filesystem::rename(logFilename, SegmentName(0), ec);
+    if (ec) {
+        std::cerr << "ERROR: Could not rotate log file: " << logFilename << ": " << ec.message() << std::endl;
+        if (rotationFailed) {
+            // Лог уже занял место всех сегментов: дальше он рос бы без предела.
+            std::cerr << "ERROR: Log file " << logFilename << " reached its size limit, file logging stopped" << std::endl;
+            return;
         }
-        infile.close();
-    } else {
-        std::cerr << "ERROR: Could not open log file for trimming: " << logFilename << std::endl;
+        // trunc стёр бы текущий лог: дописываем в него же до общего лимита и тогда пробуем снова.
+        rotationFailed = true;
         file.open(logFilename, std::ios::out | std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "ERROR: Could not reopen log file: " << logFilename << std::endl;
+        }
         return;
     }
 
+    rotationFailed = false;
     file.open(logFilename, std::ios::out | std::ios::trunc);
-    if (file.is_open()) {
-        for (const auto& l : lines) {
-            file << l << std::endl;
-        }
-        file.close();
-    } else {
-         std::cerr << "ERROR: Could not open log file for writing trimmed content: " << logFilename << std::endl;
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open new log segment: " << logFilename << std::endl;
     }
+    linesInSegment = 0;
+}
 
-    file.open(logFilename, std::ios::out | std::ios::app);
-     if (!file.is_open()) {
-          std::cerr << "ERROR: Could not reopen log file for appending after trimming: " << logFilename << std::endl;
-     }
+void Logger::CountLine() {
+    linesInSegment++;
+    // Равенство, а не >=: после остановки записи в файл ротация не повторяется на каждой строке.
+    if (maxLogLines > 0 && linesInSegment == (rotationFailed ? maxLogLines : segmentMaxLines)) {
+        RotateLogFile();
+    }
 }
 
 void Logger::Log(const std::string& message) {
     std::lock_guard<std::mutex> lock(logMutex);
-    if (!initialized) Init();
+    if (!initialized) InitLocked("debug.log", 1000, OutputMode::BOTH);
 
     time_t now = time(0);
     std::string datetime = ctime(&now);
@@ -121,16 +173,12 @@ void Logger::Log(const std::string& message) {
         std::cout << logMessage;
     }
 
-    logCallsSinceLastTrim++;
-    if (logCallsSinceLastTrim >= kTrimCheckFrequency) {
-        TrimLogFile();
-        logCallsSinceLastTrim = 0;
-    }
+    CountLine();
 }
 
 void Logger::LogError(const std::string& message) {
     std::lock_guard<std::mutex> lock(logMutex);
-    if (!initialized) Init();
+    if (!initialized) InitLocked("debug.log", 1000, OutputMode::BOTH);
 
     time_t now = time(0);
     std::string datetime = ctime(&now);
@@ -146,16 +194,12 @@ void Logger::LogError(const std::string& message) {
         std::cerr << "\033[1;31m" << logMessage << "\033[0m";
     }
 
-    logCallsSinceLastTrim++;
-    if (logCallsSinceLastTrim >= kTrimCheckFrequency) {
-        TrimLogFile();
-        logCallsSinceLastTrim = 0;
-    }
+    CountLine();
 }
 
 void Logger::LogDebug(const std::string& message) {
     std::lock_guard<std::mutex> lock(logMutex);
-    if (!initialized) Init();
+    if (!initialized) InitLocked("debug.log", 1000, OutputMode::BOTH);
 
     time_t now = time(0);
     std::string datetime = ctime(&now);
@@ -171,16 +215,12 @@ void Logger::LogDebug(const std::string& message) {
         std::cout << "\033[1;34m" << logMessage << "\033[0m";
     }
 
-    logCallsSinceLastTrim++;
-    if (logCallsSinceLastTrim >= kTrimCheckFrequency) {
-        TrimLogFile();
-        logCallsSinceLastTrim = 0;
-    }
+    CountLine();
 }
 
 void Logger::LogWarning(const std::string& message) {
     std::lock_guard<std::mutex> lock(logMutex);
-    if (!initialized) Init();
+    if (!initialized) InitLocked("debug.log", 1000, OutputMode::BOTH);
 
     time_t now = time(0);
     std::string datetime = ctime(&now);
@@ -196,11 +236,7 @@ void Logger::LogWarning(const std::string& message) {
         std::cerr << "\033[1;33m" << logMessage << "\033[0m";
     }
 
-    logCallsSinceLastTrim++;
-    if (logCallsSinceLastTrim >= kTrimCheckFrequency) {
-        TrimLogFile();
-        logCallsSinceLastTrim = 0;
-    }
+    CountLine();
 }
 
 } // namespace arctic 
\ No newline at end of file
@@ -2,8 +2,8 @@
 #include <string>
 #include <fstream>
 #include <iostream>
-#include <deque>
 #include <mutex>
+#include <atomic>
 
 namespace arctic {
 
@@ -21,10 +21,22 @@ public:
     static void LogDebug(const std::string& message);
     static void LogWarning(const std::string& message);
     static void SetOutputMode(OutputMode mode);
+    // Закрывает файл лога; следующий Init открывает лог заново.
+    static void Close();
+    // Только в дочернем процессе сразу после fork: файл лога и его ротация остаются
+    // родителю, а сообщения ребёнка идут в консоль.
+    static void DetachFileAfterFork();
+    // Отладочные сообщения из горячих циклов симуляции, по умолчанию выключены:
+    // тогда LOG_DEBUG не собирает строку сообщения и не берёт мьютекс.
+    static void SetDebugEnabled(bool enabled) { debugEnabled.store(enabled, std::memory_order_relaxed); }
+    static bool IsDebugEnabled() { return debugEnabled.load(std::memory_order_relaxed); }
 
 private:
+    static void InitLocked(const std::string& filename, size_t maxLines, OutputMode mode);
     static void WriteToLog(const std::string& message);
-    static void TrimLogFile();
+    static void RotateLogFile();
+    static void CountLine();
+    static std::string SegmentName(size_t index);
 
     static std::ofstream file;
     static bool initialized;
@@ -32,12 +44,17 @@ private:
     static std::string logFilename;
     static OutputMode outputMode;
     static std::mutex logMutex;
-    static size_t logCallsSinceLastTrim;
-    static const size_t kTrimCheckFrequency = 1000;
+    static size_t linesInSegment;
+    static size_t segmentMaxLines;
+    // Активный лог не удалось переименовать: он растёт до maxLogLines строк вместо segmentMaxLines.
+    static bool rotationFailed;
+    static std::atomic<bool> debugEnabled;
+    // Количество архивных сегментов debug.log.0..N-1 помимо активного файла.
+    static const size_t kLogSegments = 4;
 };
 
 #define LOG(msg) Logger::Log(msg)
 #define LOG_ERROR(msg) Logger::LogError(msg)
-#define LOG_DEBUG(msg) Logger::LogDebug(msg)
+#define LOG_DEBUG(msg) do { if (Logger::IsDebugEnabled()) Logger::LogDebug(msg); } while (false)
 #define LOG_WARNING(msg) Logger::LogWarning(msg)
 } // namespace arctic 
@@ -0,0 +1,82 @@
+#include "mapped_file.h"
+#include "logger.h"
+#include <fstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ARCTIC_HAVE_MMAP 1
+#endif
+
+namespace arctic {
+
+TMappedFile::~TMappedFile() {
+    Close();
+}
+
+bool TMappedFile::Open(const std::string& path) {
+    Close();
+#ifdef ARCTIC_HAVE_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Could not open file: " + path);
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        LOG_ERROR("Could not stat file: " + path);
+        return false;
+    }
+    Size = static_cast<size_t>(info.st_size);
+    if (Size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void* address = ::mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Отображение держит файл и после закрытия дескриптора.
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        Size = 0;
+        LOG_ERROR("Could not map file: " + path);
+        return false;
+    }
+    // Файл читается от начала к концу, ядру стоит читать вперёд крупнее.
+    ::madvise(address, Size, MADV_SEQUENTIAL);
+    Data = static_cast<const Ui8*>(address);
+    Mapped = true;
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        LOG_ERROR("Could not open file: " + path);
+        return false;
+    }
+    Fallback.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(Fallback.data()), Fallback.size())) {
+        Fallback.clear();
+        LOG_ERROR("Could not read file: " + path);
+        return false;
+    }
+    Data = Fallback.data();
+    Size = Fallback.size();
+    return true;
+#endif
+}
+
+void TMappedFile::Close() {
+#ifdef ARCTIC_HAVE_MMAP
+    if (Mapped) {
+        ::munmap(const_cast<Ui8*>(Data), Size);
+    }
+#endif
+    Mapped = false;
+    Data = nullptr;
+    Size = 0;
+    Fallback.clear();
+    Fallback.shrink_to_fit();
+}
+
+} // namespace arctic
@@ -0,0 +1,34 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace arctic {
+
+// Файл только для чтения, отображённый в память целиком: содержимое читается с
+// диска страницами по мере обращения и не копируется. Где mmap нет, файл
+// читается в буфер, так что для вызывающего кода разницы нет.
+class TMappedFile {
+public:
+    TMappedFile() = default;
+    ~TMappedFile();
+    TMappedFile(const TMappedFile&) = delete;
+    TMappedFile& operator=(const TMappedFile&) = delete;
+
+    // Закрывает прежний файл. false и запись в лог, если файл не открылся.
+    bool Open(const std::string& path);
+    void Close();
+
+    // Выровнено по странице при mmap и по alignof(max_align_t) в буфере.
+    const Ui8* GetData() const { return Data; }
+    size_t GetSize() const { return Size; }
+
+private:
+    const Ui8* Data = nullptr;
+    size_t Size = 0;
+    bool Mapped = false;
+    std::vector<Ui8> Fallback;
+};
+
+} // namespace arctic
@@ -0,0 +1,16 @@
+#pragma once
+#include <queue>
+#include <vector>
+
+namespace arctic {
+
+// priority_queue, которую можно очистить без освобождения памяти: модель
+// переиспользуется между прогонами, и куча не должна выделяться заново.
+template <typename T, typename TCompare = std::less<T>>
+class TReusableHeap : public std::priority_queue<T, std::vector<T>, TCompare> {
+public:
+    void Clear() { this->c.clear(); }
+    void Reserve(size_t size) { this->c.reserve(size); }
+};
+
+} // namespace arctic
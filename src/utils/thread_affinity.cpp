@@ -0,0 +1,121 @@
+#include "thread_affinity.h"
+#include "logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+namespace arctic {
+
+namespace {
+
+#ifdef __linux__
+
+const char* const kCpuSysfsDir = "/sys/devices/system/cpu/cpu";
+
+Ui32 ReadTopologyValue(Ui32 cpu, const char* name, Ui32 fallback) {
+    std::ifstream in(kCpuSysfsDir + std::to_string(cpu) + "/topology/" + name);
+    Ui32 value = fallback;
+    return in >> value ? value : fallback;
+}
+
+Ui32 GetCpuNode(Ui32 cpu) {
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0) {
+        const int node = numa_node_of_cpu(static_cast<int>(cpu));
+        return node >= 0 ? static_cast<Ui32>(node) : 0;
+    }
+#endif
+    // Каталог CPU содержит ссылку nodeN на свой узел.
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(kCpuSysfsDir + std::to_string(cpu), error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return static_cast<Ui32>(std::stoul(name.substr(4)));
+        }
+    }
+    return 0;
+}
+
+#endif
+
+} // namespace
+
+std::vector<TCpuSlot> BuildWorkerCpuOrder(bool useSmt) {
+    std::vector<TCpuSlot> order;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        LOG_WARNING("BuildWorkerCpuOrder: sched_getaffinity failed");
+        return order;
+    }
+    // Для каждого узла: первые логические CPU физических ядер и остальные потоки ядер.
+    std::map<Ui32, std::pair<std::vector<Ui32>, std::vector<Ui32>>> byNode;
+    std::set<std::pair<Ui32, Ui32>> seenCores;
+    for (Ui32 cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        const Ui32 package = ReadTopologyValue(cpu, "physical_package_id", 0);
+        const Ui32 core = ReadTopologyValue(cpu, "core_id", cpu);
+        auto& [primary, siblings] = byNode[GetCpuNode(cpu)];
+        (seenCores.insert({package, core}).second ? primary : siblings).push_back(cpu);
+    }
+    for (bool smtPass : {false, true}) {
+        if (smtPass && !useSmt) {
+            break;
+        }
+        for (size_t round = 0;; ++round) {
+            bool any = false;
+            for (const auto& [node, cpus] : byNode) {
+                const std::vector<Ui32>& list = smtPass ? cpus.second : cpus.first;
+                if (round < list.size()) {
+                    order.push_back({list[round], node});
+                    any = true;
+                }
+            }
+            if (!any) {
+                break;
+            }
+        }
+    }
+#endif
+    return order;
+}
+
+bool PinCurrentThread(const TCpuSlot& slot) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(slot.Cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        LOG_WARNING("PinCurrentThread: cannot pin to CPU " + std::to_string(slot.Cpu));
+        return false;
+    }
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0) {
+        // Страницы потока берутся с узла, на котором он исполняется, даже если
+        // политика процесса задана иначе (например, interleave через numactl).
+        numa_set_localalloc();
+    }
+#endif
+    return true;
+#else
+    (void)slot;
+    return false;
+#endif
+}
+
+} // namespace arctic
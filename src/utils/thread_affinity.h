@@ -0,0 +1,25 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <vector>
+
+namespace arctic {
+
+// Логический CPU и его NUMA-узел.
+struct TCpuSlot {
+    Ui32 Cpu = 0;
+    Ui32 Node = 0;
+};
+
+// Порядок CPU для закрепления воркеров из тех, что разрешены процессу: сначала по
+// одному логическому CPU на физическое ядро, по очереди с каждого узла, чтобы
+// воркеры делили пропускную способность памяти всех сокетов; затем, если useSmt,
+// вторые потоки тех же ядер. Воркер i берёт слот i по модулю размера.
+std::vector<TCpuSlot> BuildWorkerCpuOrder(bool useSmt);
+
+// Закрепляет текущий поток за slot.Cpu и делает его выделения памяти локальными
+// для slot.Node: с libnuma (HAVE_LIBNUMA) политикой localalloc, без неё - через
+// first-touch, поэтому состояние прогонов надо создавать уже после вызова.
+// false, если закрепить не удалось; поток тогда продолжает работать где угодно.
+bool PinCurrentThread(const TCpuSlot& slot);
+
+} // namespace arctic
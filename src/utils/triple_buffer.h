@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace arctic {
+
+// Тройной буфер для одного писателя и одного читателя: писатель заполняет свой
+// буфер и публикует его обменом с промежуточным, читатель забирает промежуточный,
+// если там свежие данные. Ни одна из сторон не ждёт другую и не видит полузаписанных данных.
+template <typename T>
+class TTripleBuffer {
+public:
+    T& GetWriteBuffer() { return Buffers[WriteIndex]; }
+
+    void Publish() {
+        WriteIndex = Middle.exchange(WriteIndex | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Возвращает true, если с прошлого вызова был опубликован новый буфер.
+    bool Update() {
+        if (!(Middle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        ReadIndex = Middle.exchange(ReadIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    const T& GetReadBuffer() const { return Buffers[ReadIndex]; }
+
+private:
+    static constexpr std::uint32_t kIndexMask = 3;
+    static constexpr std::uint32_t kFresh = 4;
+
+    T Buffers[3];
+    std::uint32_t WriteIndex = 0;
+    std::atomic<std::uint32_t> Middle{1};
+    std::uint32_t ReadIndex = 2;
+};
+
+} // namespace arctic
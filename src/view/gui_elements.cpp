@@ -2,6 +2,8 @@
 #include <sstream>
 #include <iomanip>
 #include "../utils/logger.h"
+#include "model/erasure_scheme.h"
+#include "model/failure_model.h"
 
 namespace arctic {
 
@@ -128,85 +130,239 @@ void InitializeGui(GuiElements& gui) {
     gui.ScrollRecoveryTime->SetValue(24);
     gui.Gui->AddChild(gui.ScrollRecoveryTime);
 
+    gui.TextErasureScheme = guiFactory.MakeText();
+    gui.TextErasureScheme->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 400 + 29);
+    gui.TextErasureScheme->SetText(std::string("Erasure Scheme: ") + GetErasureScheme(kMirror3DcScheme).Name);
+    gui.Gui->AddChild(gui.TextErasureScheme);
+
+    gui.ScrollErasureScheme = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollErasureScheme->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 400);
+    gui.ScrollErasureScheme->SetWidth(300);
+    gui.ScrollErasureScheme->SetMinValue(0);
+    gui.ScrollErasureScheme->SetMaxValue(kErasureSchemeCount - 1);
+    gui.ScrollErasureScheme->SetValue(kMirror3DcScheme);
+    gui.Gui->AddChild(gui.ScrollErasureScheme);
+
+    gui.TextNumDCs = guiFactory.MakeText();
+    gui.TextNumDCs->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 500 + 29);
+    gui.TextNumDCs->SetText("DCs: 3");
+    gui.Gui->AddChild(gui.TextNumDCs);
+
+    gui.ScrollNumDCs = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollNumDCs->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 500);
+    gui.ScrollNumDCs->SetWidth(300);
+    gui.ScrollNumDCs->SetMinValue(1);
+    gui.ScrollNumDCs->SetMaxValue(8);
+    gui.ScrollNumDCs->SetValue(3);
+    gui.Gui->AddChild(gui.ScrollNumDCs);
+
+    gui.TextHostOutages = guiFactory.MakeText();
+    gui.TextHostOutages->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 100 + 29);
+    gui.TextHostOutages->SetText("Host Outages: 0 per year");
+    gui.Gui->AddChild(gui.TextHostOutages);
+
+    gui.ScrollHostOutages = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollHostOutages->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 100);
+    gui.ScrollHostOutages->SetWidth(300);
+    gui.ScrollHostOutages->SetMinValue(0);
+    gui.ScrollHostOutages->SetMaxValue(100);
+    gui.ScrollHostOutages->SetValue(0);
+    gui.Gui->AddChild(gui.ScrollHostOutages);
+
+    gui.TextRackOutages = guiFactory.MakeText();
+    gui.TextRackOutages->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset + 600 + 29);
+    gui.TextRackOutages->SetText("Rack Outages: 0 per year");
+    gui.Gui->AddChild(gui.TextRackOutages);
+
+    gui.ScrollRackOutages = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollRackOutages->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset + 600);
+    gui.ScrollRackOutages->SetWidth(300);
+    gui.ScrollRackOutages->SetMinValue(0);
+    gui.ScrollRackOutages->SetMaxValue(24);
+    gui.ScrollRackOutages->SetValue(0);
+    gui.Gui->AddChild(gui.ScrollRackOutages);
+
+    gui.TextDcOutages = guiFactory.MakeText();
+    gui.TextDcOutages->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 600 + 29);
+    gui.TextDcOutages->SetText("DC Outages: 0 per year");
+    gui.Gui->AddChild(gui.TextDcOutages);
+
+    gui.ScrollDcOutages = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollDcOutages->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 600);
+    gui.ScrollDcOutages->SetWidth(300);
+    gui.ScrollDcOutages->SetMinValue(0);
+    gui.ScrollDcOutages->SetMaxValue(12);
+    gui.ScrollDcOutages->SetValue(0);
+    gui.Gui->AddChild(gui.ScrollDcOutages);
+
+    gui.TextDcReplicationSpeed = guiFactory.MakeText();
+    gui.TextDcReplicationSpeed->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset + 700 + 29);
+    gui.TextDcReplicationSpeed->SetText("DC Replication Network: unlimited");
+    gui.Gui->AddChild(gui.TextDcReplicationSpeed);
+
+    gui.ScrollDcReplicationSpeed = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollDcReplicationSpeed->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset + 700);
+    gui.ScrollDcReplicationSpeed->SetWidth(300);
+    gui.ScrollDcReplicationSpeed->SetMinValue(0);
+    gui.ScrollDcReplicationSpeed->SetMaxValue(2000);
+    gui.ScrollDcReplicationSpeed->SetValue(0);
+    gui.Gui->AddChild(gui.ScrollDcReplicationSpeed);
+
+    gui.TextHazardModel = guiFactory.MakeText();
+    gui.TextHazardModel->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 700 + 29);
+    gui.TextHazardModel->SetText(std::string("Failure Model: ") + GetHazardModelName(kHazardConstant));
+    gui.Gui->AddChild(gui.TextHazardModel);
+
+    gui.ScrollHazardModel = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollHazardModel->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 700);
+    gui.ScrollHazardModel->SetWidth(300);
+    gui.ScrollHazardModel->SetMinValue(0);
+    gui.ScrollHazardModel->SetMaxValue(kHazardModelCount - 1);
+    gui.ScrollHazardModel->SetValue(kHazardConstant);
+    gui.Gui->AddChild(gui.ScrollHazardModel);
+
+    gui.TextFleetAge = guiFactory.MakeText();
+    gui.TextFleetAge->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset + 800 + 29);
+    gui.TextFleetAge->SetText("Fleet Age: 365 days");
+    gui.Gui->AddChild(gui.TextFleetAge);
+
+    gui.ScrollFleetAge = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollFleetAge->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset + 800);
+    gui.ScrollFleetAge->SetWidth(300);
+    gui.ScrollFleetAge->SetMinValue(0);
+    gui.ScrollFleetAge->SetMaxValue(3650);
+    gui.ScrollFleetAge->SetValue(365);
+    gui.Gui->AddChild(gui.ScrollFleetAge);
+
+    gui.TextNewBatch = guiFactory.MakeText();
+    gui.TextNewBatch->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 800 + 29);
+    gui.TextNewBatch->SetText("New Batch: 0%");
+    gui.Gui->AddChild(gui.TextNewBatch);
+
+    gui.ScrollNewBatch = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollNewBatch->SetPos(kLeftMargin + kGraphWidth + 50, kTopMargin + kControlsYOffset + 800);
+    gui.ScrollNewBatch->SetWidth(300);
+    gui.ScrollNewBatch->SetMinValue(0);
+    gui.ScrollNewBatch->SetMaxValue(100);
+    gui.ScrollNewBatch->SetValue(0);
+    gui.Gui->AddChild(gui.ScrollNewBatch);
+
+    gui.TextHorizon = guiFactory.MakeText();
+    gui.TextHorizon->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset + 29);
+    gui.TextHorizon->SetText("Horizon: 30 days");
+    gui.Gui->AddChild(gui.TextHorizon);
+
+    gui.ScrollHorizonDays = guiFactory.MakeHorizontalScrollbar();
+    gui.ScrollHorizonDays->SetPos(kLeftMargin - 320, kTopMargin + kControlsYOffset);
+    gui.ScrollHorizonDays->SetWidth(300);
+    gui.ScrollHorizonDays->SetMinValue(1);
+    gui.ScrollHorizonDays->SetMaxValue(5 * 365);
+    gui.ScrollHorizonDays->SetValue(30);
+    gui.Gui->AddChild(gui.ScrollHorizonDays);
+
     LOG("GUI initialized");
     LOG("GUI elements created");
 }
 
-void UpdateGuiText(GuiElements& gui) {
+void UpdateGuiText(GuiElements& gui, const TSimulationStats& stats, const TReweightedLoss* whatIf) {
     std::stringstream ss;
     ss << "Simulations: " << GSims;
+    if (stats.GetLossCount() > 0) {
+        const double mttdlYears = stats.GetMeanTimeToDataLoss() / (365.0 * 24.0);
+        ss << std::fixed << std::setprecision(1)
+           << "   MTTDL: " << mttdlYears << " years"
+           << "   Time to loss p50/p90/p99: "
+           << stats.GetLossTimeQuantile(0.5) / 24.0 << " / "
+           << stats.GetLossTimeQuantile(0.9) / 24.0 << " / "
+           << stats.GetLossTimeQuantile(0.99) / 24.0 << " days";
+    }
+    if (stats.HasControl() || stats.IsStratified()) {
+        ss << std::fixed << std::setprecision(1)
+           << "   Variance reduction: x" << stats.GetLossEstimate(GHorizonHours).VarianceReduction;
+    }
+    if (whatIf) {
+        ss << std::fixed << std::setprecision(0)
+           << "   Reweighted to " << whatIf->FailureRate << " disks/day from " << whatIf->Runs
+           << " runs, ESS: " << whatIf->EffectiveSampleSize;
+    }
     gui.TextStats->SetText(ss.str());
 }
 
-void DrawCumulative(const std::map<Si64, Si64>& valuesByCount, Rgba color, 
-                   Vec2Si32 position, Vec2Si32 size, const char* title) {
-    std::vector<Vec2D> points;
-    points.reserve(valuesByCount.size() + 2);
-    points.emplace_back(0.0, 0.0);
-
-    double totalSum = 0.0;
-    for (const auto& pair : valuesByCount) {
-        totalSum += pair.second;
-        points.emplace_back(pair.first, totalSum);
+void BuildPlot(TPlotCache& plot, const TSimulationStats& stats, Ui64 version, double horizonDays,
+               const TMarkovEstimate* analytic, const TReweightedLoss* whatIf) {
+    std::vector<Vec2D>& raw = plot.GetRawBuffer();
+    plot.Begin(version, horizonDays, analytic ? 4 : 3, Vec2Si32(kGraphWidth, kGraphHeight));
+    if (whatIf) {
+        BuildReweightedCurve(*whatIf, horizonDays, 0.0, raw);
+        plot.SetCurve(0, Rgba(255, 0, 0), raw);
+        BuildReweightedCurve(*whatIf, horizonDays, -1.96, raw);
+        plot.SetCurve(1, Rgba(96, 32, 32), raw);
+        BuildReweightedCurve(*whatIf, horizonDays, 1.96, raw);
+        plot.SetCurve(2, Rgba(96, 32, 32), raw);
+    } else {
+        BuildLossCurve(stats, horizonDays, raw);
+        plot.SetCurve(0, Rgba(255, 0, 0), raw);
+        BuildLossCurveBound(stats, horizonDays, false, raw);
+        plot.SetCurve(1, Rgba(96, 32, 32), raw);
+        BuildLossCurveBound(stats, horizonDays, true, raw);
+        plot.SetCurve(2, Rgba(96, 32, 32), raw);
     }
+    if (analytic) {
+        BuildMarkovCurve(*analytic, raw);
+        plot.SetCurve(3, Rgba(64, 160, 255), raw);
+    }
+    plot.Finish();
+}
 
-    if (points.size() > 1) {
-        if (totalSum > 0.0) {
-            for (auto& point : points) {
-                point.y /= totalSum;
-            }
-        }
-
-        DrawRectangle(position, position + size, Rgba(32,32,32));
+void DrawCumulative(const TPlotCache& plot, Vec2Si32 position, Vec2Si32 size, const char* title) {
+    if (plot.GetCurveCount() == 0 || plot.GetHorizonDays() <= 0) {
+        return;
+    }
 
-        Vec2D scale = Vec2D(double(size.x) / 30.0, size.y);
-        Vec2D point0 = points[0];
+    DrawRectangle(position, position + size, Rgba(32,32,32));
 
-        for (Si32 i = 1; i < points.size(); ++i) {
-            Vec2D point1 = points[i];
-            DrawLine(position + Vec2Si32(scale.x * point0.x, scale.y * point0.y),
-                    position + Vec2Si32(scale.x * point1.x, scale.y * point1.y),
-                    color);
-            point0 = point1;
+    // Основная кривая рисуется последней, поверх остальных.
+    for (size_t i = plot.GetCurveCount(); i-- > 0;) {
+        const TPlotCurve& curve = plot.GetCurves()[i];
+        for (size_t j = 1; j < curve.Pixels.size(); ++j) {
+            DrawLine(position + curve.Pixels[j - 1], position + curve.Pixels[j], curve.Color);
         }
-
-        DrawLabelsAndMouseInteraction(points, position, size, scale, title);
     }
+
+    DrawLabelsAndMouseInteraction(plot, position, size, title);
 }
 
-void DrawLabelsAndMouseInteraction(const std::vector<Vec2D>& points, 
+void DrawLabelsAndMouseInteraction(const TPlotCache& plot, 
                                  Vec2Si32 position, Vec2Si32 size, 
-                                 Vec2D scale, const char* title) {
+                                 const char* title) {
     GFont.Draw("Days", position.x + size.x / 2, position.y - 20, kTextOriginTop);
     GFont.Draw("Probability", position.x - 20, position.y + size.y / 2, kTextOriginTop);
     GFont.Draw("0", position.x, position.y, kTextOriginTop);
-    GFont.Draw("30", position.x + size.x, position.y, kTextOriginTop);
+    GFont.Draw(std::to_string(static_cast<Si64>(plot.GetHorizonDays())).c_str(), position.x + size.x, position.y, kTextOriginTop);
 
-    HandleMouseInteraction(points, position, size, scale);
+    HandleMouseInteraction(plot.GetCurves()[0], position, size, plot.GetScale());
 }
 
-void DrawSimulation(const std::map<Si64, Si64>& probabilityByDay) {
-    DrawCumulative(probabilityByDay, Rgba(255, 0, 0),
+void DrawSimulation(const TPlotCache& plot) {
+    DrawCumulative(plot,
                   Vec2Si32(kLeftMargin, kTopMargin), 
                   Vec2Si32(kGraphWidth, kGraphHeight),
                   "Data Loss Probability Distribution");
 }
 
-void HandleMouseInteraction(const std::vector<Vec2D>& points, 
+void HandleMouseInteraction(const TPlotCurve& curve, 
                           Vec2Si32 position, Vec2Si32 size, 
                           Vec2D scale) {
+    const std::vector<Vec2D>& points = curve.Points;
     Si32 mouseX = MouseX();
     Si32 viewMouseX = mouseX - position.x;
-    if (viewMouseX >= 0 && viewMouseX < size.x) {
-        Si32 currentDay = viewMouseX * 30 / size.x;
-
-        Si32 nearestIdx = 0;
-        for (Si32 i = 0; i < points.size(); ++i) {
-            if (points[i].x > currentDay) {
-                nearestIdx = std::max(0, i-1);
-                break;
-            }
-        }
+    if (viewMouseX >= 0 && viewMouseX < size.x && !points.empty() && scale.x > 0.0) {
+        const double currentDay = viewMouseX / scale.x;
+
+        // Последняя точка не правее курсора.
+        auto it = std::upper_bound(points.begin(), points.end(), currentDay,
+                                   [](double day, const Vec2D& point) { return day < point.x; });
+        const size_t nearestIdx = it == points.begin() ? 0 : (it - points.begin()) - 1;
 
         DrawLine(position + Vec2Si32(viewMouseX, 0),
                 position + Vec2Si32(viewMouseX, size.y),
@@ -214,7 +370,7 @@ void HandleMouseInteraction(const std::vector<Vec2D>& points,
 
         std::stringstream str;
         str << std::fixed << std::setprecision(6)
-            << "Day " << currentDay 
+            << "Day " << static_cast<Si64>(currentDay)
             << "\nProbability of data loss: " 
             << (points[nearestIdx].y * 100.0) << "%";
         GFont.Draw(str.str().c_str(),
@@ -2,6 +2,8 @@
 #include <arctic/engine/easy.h>
 #include <map>
 #include "model/simulation_params.h"
+#include "model/simulation_stats.h"
+#include "plot_cache.h"
 
 namespace arctic {
 
@@ -22,6 +24,16 @@ struct GuiElements {
     std::shared_ptr<Text> TextDataLossTitle;
     std::shared_ptr<Text> TextRecoveryTime;
     std::shared_ptr<Text> TextVDisksPerPDisk;
+    std::shared_ptr<Text> TextErasureScheme;
+    std::shared_ptr<Text> TextNumDCs;
+    std::shared_ptr<Text> TextHostOutages;
+    std::shared_ptr<Text> TextRackOutages;
+    std::shared_ptr<Text> TextDcOutages;
+    std::shared_ptr<Text> TextDcReplicationSpeed;
+    std::shared_ptr<Text> TextHazardModel;
+    std::shared_ptr<Text> TextFleetAge;
+    std::shared_ptr<Text> TextNewBatch;
+    std::shared_ptr<Text> TextHorizon;
 
     std::shared_ptr<Scrollbar> ScrollDisksPerDc;
     std::shared_ptr<Scrollbar> ScrollDiskSize;
@@ -30,20 +42,35 @@ struct GuiElements {
     std::shared_ptr<Scrollbar> ScrollWriteSpeed;
     std::shared_ptr<Scrollbar> ScrollRecoveryTime;
     std::shared_ptr<Scrollbar> ScrollVDisksPerPDisk;
+    std::shared_ptr<Scrollbar> ScrollErasureScheme;
+    std::shared_ptr<Scrollbar> ScrollNumDCs;
+    std::shared_ptr<Scrollbar> ScrollHostOutages;
+    std::shared_ptr<Scrollbar> ScrollRackOutages;
+    std::shared_ptr<Scrollbar> ScrollDcOutages;
+    std::shared_ptr<Scrollbar> ScrollDcReplicationSpeed;
+    std::shared_ptr<Scrollbar> ScrollHazardModel;
+    std::shared_ptr<Scrollbar> ScrollFleetAge;
+    std::shared_ptr<Scrollbar> ScrollNewBatch;
+    std::shared_ptr<Scrollbar> ScrollHorizonDays;
 };
 
 void InitializeGui(GuiElements& gui);
-void UpdateGuiText(GuiElements& gui);
-void DrawSimulation(const std::map<Si64, Si64>& probabilityByDay);
-void DrawCumulative(const std::map<Si64, Si64>& valuesByCount, Rgba color, 
-                   Vec2Si32 position, Vec2Si32 size, const char* title);
+// whatIf, если задан, - оценка для новой интенсивности отказов по прогонам со старой.
+void UpdateGuiText(GuiElements& gui, const TSimulationStats& stats, const TReweightedLoss* whatIf);
+// Пересобирает кривую потерь и её доверительный интервал под размер графика.
+// Если задан whatIf, кривая и интервал берутся из него.
+void BuildPlot(TPlotCache& plot, const TSimulationStats& stats, Ui64 version, double horizonDays,
+               const TMarkovEstimate* analytic, const TReweightedLoss* whatIf);
+// Рисует кривые из кэша; по первой подписывается значение под курсором.
+void DrawSimulation(const TPlotCache& plot);
+void DrawCumulative(const TPlotCache& plot, Vec2Si32 position, Vec2Si32 size, const char* title);
 
-void HandleMouseInteraction(const std::vector<Vec2D>& points, 
+void HandleMouseInteraction(const TPlotCurve& curve, 
                           Vec2Si32 position, Vec2Si32 size, 
                           Vec2D scale);
 
-void DrawLabelsAndMouseInteraction(const std::vector<Vec2D>& points, 
+void DrawLabelsAndMouseInteraction(const TPlotCache& plot, 
                                  Vec2Si32 position, Vec2Si32 size, 
-                                 Vec2D scale, const char* title);
+                                 const char* title);
 
 } // namespace arctic 
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "plot_cache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace arctic {
+
+void TPlotCache::Begin(Ui64 version, double horizonDays, size_t curveCount, Vec2Si32 size) {
+    Version = version;
+    Size = size;
+    HorizonDays = horizonDays;
+    CurveCount = curveCount;
+    if (Curves.size() < curveCount) {
+        Curves.resize(curveCount);
+    }
+    Valid = false;
+}
+
+void TPlotCache::SetCurve(size_t index, Rgba color, const std::vector<Vec2D>& raw) {
+    TPlotCurve& curve = Curves[index];
+    curve.Color = color;
+    DecimateMinMax(raw, HorizonDays, Size.x, curve.Points);
+}
+
+void TPlotCache::Finish() {
+    // Лишние кривые от прошлой сборки не удаляются, чтобы не терять их память.
+    for (size_t i = CurveCount; i < Curves.size(); ++i) {
+        Curves[i].Points.clear();
+        Curves[i].Pixels.clear();
+    }
+
+    // Вероятности потери малы, поэтому ось Y масштабируется по максимуму кривых.
+    double maxY = 0.0;
+    for (size_t i = 0; i < CurveCount; ++i) {
+        for (const Vec2D& point : Curves[i].Points) {
+            maxY = std::max(maxY, point.y);
+        }
+    }
+    Scale = Vec2D(HorizonDays > 0.0 ? Size.x / HorizonDays : 0.0, maxY > 0.0 ? Size.y / maxY : Size.y);
+
+    for (size_t i = 0; i < CurveCount; ++i) {
+        TPlotCurve& curve = Curves[i];
+        curve.Pixels.clear();
+        for (const Vec2D& point : curve.Points) {
+            curve.Pixels.emplace_back(Scale.x * point.x, Scale.y * point.y);
+        }
+    }
+    Valid = true;
+}
+
+void DecimateMinMax(const std::vector<Vec2D>& points, double xMax, Si32 columns, std::vector<Vec2D>& out) {
+    out.clear();
+    if (columns <= 0 || xMax <= 0.0 || points.size() <= 4 * static_cast<size_t>(columns)) {
+        out.insert(out.end(), points.begin(), points.end());
+        return;
+    }
+
+    auto columnOf = [&](double x) {
+        return std::clamp<Si64>(static_cast<Si64>(x / xMax * columns), 0, columns - 1);
+    };
+
+    size_t begin = 0;
+    while (begin < points.size()) {
+        const Si64 column = columnOf(points[begin].x);
+        size_t end = begin + 1;
+        size_t minIdx = begin;
+        size_t maxIdx = begin;
+        while (end < points.size() && columnOf(points[end].x) == column) {
+            if (points[end].y < points[minIdx].y) {
+                minIdx = end;
+            }
+            if (points[end].y > points[maxIdx].y) {
+                maxIdx = end;
+            }
+            ++end;
+        }
+        const size_t last = end - 1;
+
+        size_t picked[4] = {begin, std::min(minIdx, maxIdx), std::max(minIdx, maxIdx), last};
+        for (size_t i = 0; i < 4; ++i) {
+            if (i == 0 || picked[i] != picked[i - 1]) {
+                out.push_back(points[picked[i]]);
+            }
+        }
+        begin = end;
+    }
+}
+
+namespace {
+
+// С контрольной переменной или стратами оценка меняется на границе корзины любой
+// из гистограмм, поэтому точка ставится на каждой корзине до горизонта.
+void BuildEstimateCurve(const TSimulationStats& stats, double horizonDays, double z, std::vector<Vec2D>& out) {
+    out.clear();
+    out.emplace_back(0.0, 0.0);
+    TLossEstimateCursor cursor(stats);
+    const Ui32 lastBucket = TLossTimeHistogram::GetBucket(static_cast<Ui64>(horizonDays * 24.0));
+    for (Ui32 bucket = 0; bucket <= lastBucket; ++bucket) {
+        const Ui64 hours = TLossTimeHistogram::GetBucketBegin(bucket);
+        const TLossEstimate estimate = cursor.Advance(hours);
+        const double day = hours / 24.0;
+        out.emplace_back(day, out.back().y);
+        out.emplace_back(day, std::clamp(estimate.Probability + z * estimate.StdError, 0.0, 1.0));
+    }
+    out.emplace_back(horizonDays, out.back().y);
+}
+
+} // namespace
+
+void BuildLossCurve(const TSimulationStats& stats, double horizonDays, std::vector<Vec2D>& out) {
+    if (stats.HasControl() || stats.IsStratified()) {
+        BuildEstimateCurve(stats, horizonDays, 0.0, out);
+        return;
+    }
+    out.clear();
+    out.emplace_back(0.0, 0.0);
+    const double sims = static_cast<double>(std::max<Ui64>(1, stats.Sims));
+    Ui64 losses = 0;
+    for (const auto& [bucket, count] : stats.LossTimes.GetBuckets()) {
+        const double day = TLossTimeHistogram::GetBucketBegin(bucket) / 24.0;
+        out.emplace_back(day, out.back().y);
+        losses += count;
+        out.emplace_back(day, losses / sims);
+    }
+    out.emplace_back(horizonDays, out.back().y);
+}
+
+void BuildLossCurveBound(const TSimulationStats& stats, double horizonDays, bool upper, std::vector<Vec2D>& out) {
+    const double z = upper ? 1.96 : -1.96;
+    if (stats.HasControl() || stats.IsStratified()) {
+        BuildEstimateCurve(stats, horizonDays, z, out);
+        return;
+    }
+    BuildLossCurve(stats, horizonDays, out);
+    const double sims = static_cast<double>(std::max<Ui64>(1, stats.Sims));
+    for (Vec2D& point : out) {
+        const double p = point.y;
+        point.y = std::clamp(p + z * std::sqrt(p * (1.0 - p) / sims), 0.0, 1.0);
+    }
+}
+
+void BuildReweightedCurve(const TReweightedLoss& loss, double horizonDays, double z, std::vector<Vec2D>& out) {
+    out.clear();
+    out.emplace_back(0.0, 0.0);
+    for (const TReweightedLoss::TPoint& point : loss.Points) {
+        const double day = point.Hour / 24.0;
+        out.emplace_back(day, out.back().y);
+        out.emplace_back(day, std::clamp(point.Probability + z * point.StdError, 0.0, 1.0));
+    }
+    out.emplace_back(horizonDays, out.back().y);
+}
+
+void BuildMarkovCurve(const TMarkovEstimate& estimate, std::vector<Vec2D>& out) {
+    out.clear();
+    for (size_t i = 0; i < estimate.LossProbability.size(); ++i) {
+        out.emplace_back(i * estimate.StepHours / 24.0, estimate.LossProbability[i]);
+    }
+}
+
+} // namespace arctic
@@ -0,0 +1,64 @@
+#pragma once
+#include <arctic/engine/easy.h>
+#include <vector>
+#include "model/simulation_stats.h"
+#include "model/markov_estimator.h"
+#include "model/rate_reweighting.h"
+
+namespace arctic {
+
+// Кривая в единицах графика (день, вероятность) и те же точки в пикселях
+// относительно левого нижнего угла графика.
+struct TPlotCurve {
+    Rgba Color;
+    std::vector<Vec2D> Points;
+    std::vector<Vec2Si32> Pixels;
+};
+
+// Геометрия графика, пересобираемая только при смене версии снимка статистики.
+// Векторы кривых переиспользуются, так что в установившемся режиме кадр ничего не выделяет.
+class TPlotCache {
+public:
+    bool IsUpToDate(Ui64 version) const { return Valid && Version == version; }
+    void Invalidate() { Valid = false; }
+
+    // Начинает пересборку: curveCount кривых на графике размера size, ось X от 0 до horizonDays.
+    void Begin(Ui64 version, double horizonDays, size_t curveCount, Vec2Si32 size);
+    // Прореживает raw до ширины графика и кладёт в кривую index.
+    void SetCurve(size_t index, Rgba color, const std::vector<Vec2D>& raw);
+    // Общий масштаб по всем кривым и пересчёт в пиксели.
+    void Finish();
+
+    const std::vector<TPlotCurve>& GetCurves() const { return Curves; }
+    size_t GetCurveCount() const { return CurveCount; }
+    // Буфер для исходных точек кривой перед SetCurve.
+    std::vector<Vec2D>& GetRawBuffer() { return Raw; }
+    Vec2D GetScale() const { return Scale; }
+    double GetHorizonDays() const { return HorizonDays; }
+
+private:
+    std::vector<TPlotCurve> Curves;
+    std::vector<Vec2D> Raw;
+    size_t CurveCount = 0;
+    Ui64 Version = 0;
+    bool Valid = false;
+    double HorizonDays = 0.0;
+    Vec2Si32 Size;
+    Vec2D Scale;
+};
+
+// Оставляет в каждом из columns столбцов по оси X [0, xMax) первую, минимальную,
+// максимальную и последнюю точки в исходном порядке. Точки должны идти по
+// возрастанию x. Линия по результату в пикселях совпадает с линией по исходным точкам.
+void DecimateMinMax(const std::vector<Vec2D>& points, double xMax, Si32 columns, std::vector<Vec2D>& out);
+
+// Ступенчатая кривая P(потеря не позже t) по корзинам гистограммы.
+void BuildLossCurve(const TSimulationStats& stats, double horizonDays, std::vector<Vec2D>& out);
+// Верхняя или нижняя граница 95% доверительного интервала для той же кривой.
+void BuildLossCurveBound(const TSimulationStats& stats, double horizonDays, bool upper, std::vector<Vec2D>& out);
+// Аналитическая кривая из TMarkovEstimate, точки через StepHours.
+void BuildMarkovCurve(const TMarkovEstimate& estimate, std::vector<Vec2D>& out);
+// Кривая пересчёта на другую интенсивность, сдвинутая на z стандартных ошибок (0 - сама оценка).
+void BuildReweightedCurve(const TReweightedLoss& loss, double horizonDays, double z, std::vector<Vec2D>& out);
+
+} // namespace arctic
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "model/simulation_runner.h"
+#include "model/simulation_params.h"
+#include "model/simulation.h"
+#include "test_config.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<arctic::Ui64> GAllocations{0};
+
+} // namespace
+
+// Подсчёт выделений памяти во всём тестовом бинаре.
+void* operator new(std::size_t size) {
+    GAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+class TAllocationTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+
+    void SetUp() override {
+        arctic::InitTestLogger("allocation_tests");
+        // Проверяем то, что работает в программе: отладочный лог там выключен.
+        ASSERT_FALSE(arctic::Logger::IsDebugEnabled());
+        Params = arctic::MakeTestParams();
+    }
+
+    // Выделения памяти на прогон после прогрева, вместе с калибровочными прогонами контрольной переменной.
+    double MeasureAllocationsPerRun(arctic::Ui64 warmUpRuns, arctic::Ui64 runs) {
+        const arctic::TSimulationConfig config = arctic::MakeTestConfig(Params, 16);
+        for (arctic::Ui64 simIndex = 0; simIndex < warmUpRuns; ++simIndex) {
+            arctic::RunSingleSimulation(config, 500, simIndex);
+        }
+        const arctic::Ui64 before = GAllocations.load();
+        for (arctic::Ui64 simIndex = warmUpRuns; simIndex < warmUpRuns + runs; ++simIndex) {
+            arctic::RunSingleSimulation(config, 500, simIndex);
+        }
+        return static_cast<double>(GAllocations.load() - before) / runs;
+    }
+};
+
+TEST_F(TAllocationTest, RunsDoNotAllocateAfterWarmUp) {
+    Params.FailureRate = 10;
+    Params.HostOutagesPerYear = 200;
+    Params.RackOutagesPerYear = 20;
+    const double perRun = MeasureAllocationsPerRun(10, 20);
+    RecordProperty("allocations_per_run", std::to_string(perRun));
+    ASSERT_EQ(perRun, 0.0);
+}
+
+TEST_F(TAllocationTest, HazardModelRunsDoNotAllocateAfterWarmUp) {
+    Params.HazardModel = arctic::kHazardWeibull;
+    Params.WeibullScaleDays = 2000;
+    const double perRun = MeasureAllocationsPerRun(10, 20);
+    RecordProperty("allocations_per_run", std::to_string(perRun));
+    ASSERT_EQ(perRun, 0.0);
+}
+
+TEST_F(TAllocationTest, LayoutChangeRebuildsModel) {
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(Params));
+    const size_t pdisks = sim.PDisks.Size();
+    Params.SpareDisksPerDc += 2;
+    sim.Reset(arctic::MakeTestConfig(Params));
+    ASSERT_EQ(sim.PDisks.Size(), pdisks + 2 * Params.NumDCs);
+}
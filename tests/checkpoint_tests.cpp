@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "model/checkpoint.h"
+#include "test_config.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+arctic::TCheckpoint MakeCheckpoint(arctic::Ui64 baseSeed, arctic::Ui64 sims, int lossDay) {
+    arctic::TCheckpoint checkpoint;
+    checkpoint.Params = arctic::MakeTestParams();
+    checkpoint.BaseSeed = baseSeed;
+    checkpoint.NextSimIndex = sims;
+    for (arctic::Ui64 i = 0; i < sims; ++i) {
+        arctic::SimulationResult result;
+        result.lossHour = (i == 0) ? lossDay * 24 : -1;
+        result.hoursSimulated = (i == 0) ? lossDay * 24 + 1 : 30 * 24;
+        checkpoint.Stats.AddResult(result);
+    }
+    return checkpoint;
+}
+
+} // namespace
+
+class TCheckpointTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        arctic::InitTestLogger("checkpoint_tests");
+    }
+};
+
+TEST_F(TCheckpointTest, SaveLoadRoundTrip) {
+    const std::string path = ::testing::TempDir() + "roundtrip.dfck";
+    arctic::TCheckpoint saved = MakeCheckpoint(12345, 10, 7);
+    saved.ControlCalibrationRuns = 300;
+    saved.StratifiedSampling = true;
+    ASSERT_TRUE(arctic::SaveCheckpoint(path, saved));
+
+    arctic::TCheckpoint loaded;
+    ASSERT_TRUE(arctic::LoadCheckpoint(path, loaded));
+    ASSERT_EQ(loaded.Params, saved.Params);
+    ASSERT_TRUE(loaded.IsSameEstimate(saved));
+    ASSERT_EQ(loaded.BaseSeed, 12345u);
+    ASSERT_EQ(loaded.NextSimIndex, 10u);
+    ASSERT_EQ(loaded.Stats.Sims, 10u);
+    ASSERT_TRUE(loaded.Stats == saved.Stats);
+}
+
+TEST_F(TCheckpointTest, CorruptedFileIsRejected) {
+    const std::string path = ::testing::TempDir() + "corrupted.dfck";
+    ASSERT_TRUE(arctic::SaveCheckpoint(path, MakeCheckpoint(1, 5, 3)));
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(8);
+        file.put('\x7f');
+    }
+    arctic::TCheckpoint loaded;
+    ASSERT_FALSE(arctic::LoadCheckpoint(path, loaded));
+}
+
+TEST_F(TCheckpointTest, MergeAddsStatistics) {
+    const std::string first = ::testing::TempDir() + "part1.dfck";
+    const std::string second = ::testing::TempDir() + "part2.dfck";
+    ASSERT_TRUE(arctic::SaveCheckpoint(first, MakeCheckpoint(1, 4, 10)));
+    ASSERT_TRUE(arctic::SaveCheckpoint(second, MakeCheckpoint(2, 6, 20)));
+
+    arctic::TCheckpoint merged;
+    ASSERT_TRUE(arctic::MergeCheckpoints({first, second}, merged));
+    ASSERT_EQ(merged.Stats.Sims, 10u);
+    ASSERT_EQ(merged.Stats.GetLossCount(), 2u);
+    ASSERT_EQ(merged.Stats.LossTimes.GetCountUpTo(15 * 24), 1u);
+    ASSERT_EQ(merged.Stats.ExposureHours, 8u * 30 * 24 + 10 * 24 + 1 + 20 * 24 + 1);
+    ASSERT_EQ(merged.NextSimIndex, 6u);
+}
+
+TEST_F(TCheckpointTest, MergeRejectsDifferentParams) {
+    const std::string first = ::testing::TempDir() + "params1.dfck";
+    const std::string second = ::testing::TempDir() + "params2.dfck";
+    arctic::TCheckpoint other = MakeCheckpoint(2, 3, 5);
+    other.Params.FailureRate += 1;
+    ASSERT_TRUE(arctic::SaveCheckpoint(first, MakeCheckpoint(1, 3, 5)));
+    ASSERT_TRUE(arctic::SaveCheckpoint(second, other));
+
+    arctic::TCheckpoint merged;
+    ASSERT_FALSE(arctic::MergeCheckpoints({first, second}, merged));
+}
+
+TEST_F(TCheckpointTest, MergeRejectsDifferentEstimationSettings) {
+    const std::string first = ::testing::TempDir() + "settings1.dfck";
+    const std::string second = ::testing::TempDir() + "settings2.dfck";
+    arctic::TCheckpoint stratified = MakeCheckpoint(2, 3, 5);
+    stratified.StratifiedSampling = true;
+    ASSERT_TRUE(arctic::SaveCheckpoint(first, MakeCheckpoint(1, 3, 5)));
+    ASSERT_TRUE(arctic::SaveCheckpoint(second, stratified));
+
+    arctic::TCheckpoint merged;
+    ASSERT_FALSE(arctic::MergeCheckpoints({first, second}, merged));
+
+    arctic::TCheckpoint calibrated = MakeCheckpoint(2, 3, 5);
+    calibrated.ControlCalibrationRuns = 100;
+    ASSERT_TRUE(arctic::SaveCheckpoint(second, calibrated));
+    ASSERT_FALSE(arctic::MergeCheckpoints({first, second}, merged));
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "model/simulation_runner.h"
+#include "model/simulation_stats.h"
+#include "model/failure_model.h"
+#include "test_config.h"
+#include <cmath>
+
+class TControlVariateTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+    arctic::Ui32 CalibrationRuns = 16;
+
+    void SetUp() override {
+        arctic::InitTestLogger("control_variate_tests");
+        // Частые отказы и много спаре: потери заметны за короткий горизонт.
+        Params = arctic::MakeTestParams();
+        Params.FailureRate = 20;
+        Params.SpareDisksPerDc = 200;
+        Params.HorizonHours = 72;
+    }
+
+    arctic::TSimulationStats RunSims(arctic::Ui32 sims) const {
+        const arctic::TSimulationConfig config = arctic::MakeTestConfig(Params, CalibrationRuns);
+        arctic::TSimulationStats stats;
+        for (arctic::Ui32 i = 0; i < sims; ++i) {
+            stats.AddResult(arctic::RunSingleSimulation(config, 23, i));
+        }
+        return stats;
+    }
+};
+
+TEST_F(TControlVariateTest, WithoutControlMatchesPlainEstimate) {
+    CalibrationRuns = 0;
+    const arctic::TSimulationStats stats = RunSims(100);
+    ASSERT_FALSE(stats.HasControl());
+    const arctic::TLossEstimate estimate = stats.GetLossEstimate(Params.HorizonHours);
+    const double p = stats.GetLossProbability(Params.HorizonHours);
+    EXPECT_DOUBLE_EQ(estimate.Probability, p);
+    EXPECT_DOUBLE_EQ(estimate.StdError, std::sqrt(p * (1.0 - p) / stats.Sims));
+    EXPECT_DOUBLE_EQ(estimate.VarianceReduction, 1.0);
+}
+
+TEST_F(TControlVariateTest, AgeBasedModelHasNoControl) {
+    Params.HazardModel = arctic::kHazardWeibull;
+    const arctic::TSimulationStats stats = RunSims(20);
+    EXPECT_FALSE(stats.HasControl());
+}
+
+// Суррогат на отказах прогона и в калибровочных прогонах - одна и та же модель,
+// поэтому частоты её потерь совпадают в пределах статистической ошибки.
+TEST_F(TControlVariateTest, SurrogateMeanMatchesCalibration) {
+    const arctic::TSimulationStats stats = RunSims(300);
+    ASSERT_TRUE(stats.HasControl());
+    EXPECT_EQ(stats.CalibrationSims, 300u * 16u);
+    for (arctic::Ui32 window = 0; window < arctic::kControlWindows; ++window) {
+        const arctic::TControlStats& control = stats.Controls[window];
+        const double inRuns = static_cast<double>(control.InRuns.GetCountUpTo(Params.HorizonHours)) / stats.Sims;
+        const double calibration = static_cast<double>(control.Calibration.GetCountUpTo(Params.HorizonHours)) /
+                                   stats.CalibrationSims;
+        EXPECT_NEAR(inRuns, calibration, 4.0 * std::sqrt(calibration * (1.0 - calibration) / stats.Sims) + 1e-9)
+            << "window " << window;
+    }
+}
+
+TEST_F(TControlVariateTest, ControlReducesVariance) {
+    const arctic::TSimulationStats stats = RunSims(300);
+    const arctic::TLossEstimate estimate = stats.GetLossEstimate(Params.HorizonHours);
+    const double p = stats.GetLossProbability(Params.HorizonHours);
+    RecordProperty("variance_reduction", std::to_string(estimate.VarianceReduction));
+    ASSERT_GT(p, 0.0);
+    EXPECT_GT(estimate.VarianceReduction, 2.0);
+    EXPECT_LT(estimate.StdError, std::sqrt(p * (1.0 - p) / stats.Sims));
+    EXPECT_NEAR(estimate.Probability, p, 4.0 * std::sqrt(p * (1.0 - p) / stats.Sims));
+}
+
+TEST_F(TControlVariateTest, CursorMatchesPointEstimates) {
+    const arctic::TSimulationStats stats = RunSims(100);
+    arctic::TLossEstimateCursor cursor(stats);
+    for (arctic::Ui64 hours = 0; hours <= Params.HorizonHours; hours += 5) {
+        const arctic::TLossEstimate fromCursor = cursor.Advance(hours);
+        const arctic::TLossEstimate direct = stats.GetLossEstimate(hours);
+        EXPECT_DOUBLE_EQ(fromCursor.Probability, direct.Probability);
+        EXPECT_DOUBLE_EQ(fromCursor.StdError, direct.StdError);
+    }
+}
+
+TEST_F(TControlVariateTest, SerializationKeepsControls) {
+    arctic::TSimulationStats stats = RunSims(50);
+    std::vector<arctic::Ui8> buffer;
+    stats.Serialize(buffer);
+    arctic::TSimulationStats restored;
+    const arctic::Ui8* pos = buffer.data();
+    ASSERT_TRUE(restored.Deserialize(pos, buffer.data() + buffer.size()));
+    EXPECT_TRUE(restored == stats);
+
+    arctic::TSimulationStats merged;
+    merged.Merge(stats);
+    merged.Merge(restored);
+    EXPECT_EQ(merged.CalibrationSims, 2 * stats.CalibrationSims);
+    EXPECT_DOUBLE_EQ(merged.GetLossEstimate(Params.HorizonHours).Probability,
+                     stats.GetLossEstimate(Params.HorizonHours).Probability);
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "controller/simulation_engine.h"
+#include "model/simulation_runner.h"
+#include "model/failure_model.h"
+#include "model/result_cache.h"
+#include "model/simulation_params.h"
+#include "utils/triple_buffer.h"
+#include "test_config.h"
+#include <chrono>
+#include <thread>
+
+class TEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        arctic::InitTestLogger("engine_tests");
+        // Иначе новые параметры могут продолжить запись, оставленную другим тестом, с её сидом.
+        arctic::TResultCache::Instance().Clear();
+    }
+
+    // Ждёт снимок поколения generation хотя бы с count прогонами.
+    const arctic::TEngineSnapshot& WaitFor(arctic::TSimulationEngine& engine, arctic::Ui64 generation, arctic::Ui64 count) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (std::chrono::steady_clock::now() < deadline) {
+            const arctic::TEngineSnapshot& snapshot = engine.ReadSnapshot();
+            if (snapshot.Generation == generation && snapshot.NextSimIndex >= count) {
+                return snapshot;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return engine.ReadSnapshot();
+    }
+};
+
+TEST(TTripleBufferTest, ReaderSeesLatestPublished) {
+    arctic::TTripleBuffer<int> buffer;
+    ASSERT_FALSE(buffer.Update());
+
+    buffer.GetWriteBuffer() = 1;
+    buffer.Publish();
+    buffer.GetWriteBuffer() = 2;
+    buffer.Publish();
+    ASSERT_TRUE(buffer.Update());
+    ASSERT_EQ(buffer.GetReadBuffer(), 2);
+    ASSERT_FALSE(buffer.Update());
+    ASSERT_EQ(buffer.GetReadBuffer(), 2);
+
+    buffer.GetWriteBuffer() = 3;
+    buffer.Publish();
+    ASSERT_TRUE(buffer.Update());
+    ASSERT_EQ(buffer.GetReadBuffer(), 3);
+}
+
+TEST_F(TEngineTest, SnapshotMatchesSequentialRun) {
+    arctic::TEngineSnapshot initial;
+    initial.Params = arctic::MakeSmallTestParams();
+    initial.BaseSeed = 901;
+
+    arctic::TSimulationEngine engine;
+    ASSERT_TRUE(engine.Start(3, initial));
+    const arctic::TEngineSnapshot& snapshot = WaitFor(engine, 0, 30);
+    ASSERT_GE(snapshot.NextSimIndex, 30u);
+    const arctic::TEngineSnapshot result = snapshot;
+    engine.Stop();
+
+    // Снимок покрывает ровно префикс индексов, как последовательный прогон.
+    const arctic::TSimulationConfig config = arctic::MakeEngineConfig(initial.Params);
+    arctic::TSimulationStats sequential;
+    for (arctic::Ui64 simIndex = 0; simIndex < result.NextSimIndex; ++simIndex) {
+        sequential.AddResult(arctic::RunSingleSimulation(config, 901, simIndex));
+    }
+    ASSERT_EQ(result.Stats.Sims, result.NextSimIndex);
+    ASSERT_TRUE(result.Stats == sequential);
+}
+
+TEST_F(TEngineTest, NewParamsRestartEstimate) {
+    arctic::TEngineSnapshot initial;
+    initial.Params = arctic::MakeSmallTestParams();
+    initial.BaseSeed = 902;
+
+    const arctic::TSimulationParams globals = arctic::TSimulationParams::FromGlobals();
+    arctic::TSimulationEngine engine;
+    ASSERT_TRUE(engine.Start(2, initial));
+    WaitFor(engine, 0, 5);
+
+    arctic::TSimulationParams params = initial.Params;
+    params.FailureRate = 5;
+    ASSERT_TRUE(engine.PostParams(params, 903));
+    const arctic::TEngineSnapshot& snapshot = WaitFor(engine, 1, 10);
+    ASSERT_EQ(snapshot.Generation, 1u);
+    ASSERT_TRUE(snapshot.Params == params);
+    const arctic::TEngineSnapshot result = snapshot;
+    engine.Stop();
+
+    // Движок не трогает глобальные параметры, прогоны сверяются с их снимком.
+    EXPECT_TRUE(arctic::TSimulationParams::FromGlobals() == globals);
+    const arctic::TSimulationConfig config = arctic::MakeEngineConfig(params);
+    arctic::TSimulationStats sequential;
+    for (arctic::Ui64 simIndex = 0; simIndex < result.NextSimIndex; ++simIndex) {
+        sequential.AddResult(arctic::RunSingleSimulation(config, 903, simIndex));
+    }
+    ASSERT_TRUE(result.Stats == sequential);
+}
+
+// Закреплённые воркеры считают то же самое, что и незакреплённые.
+TEST_F(TEngineTest, PinnedWorkersMatchSequentialRun) {
+    arctic::GPinWorkers = true;
+    arctic::GPinWorkersUseSmt = false;
+    arctic::TEngineSnapshot initial;
+    initial.Params = arctic::MakeSmallTestParams();
+    initial.BaseSeed = 906;
+
+    arctic::TSimulationEngine engine;
+    ASSERT_TRUE(engine.Start(2, initial));
+    const arctic::TEngineSnapshot result = WaitFor(engine, 0, 20);
+    engine.Stop();
+    arctic::GPinWorkers = false;
+    arctic::GPinWorkersUseSmt = true;
+
+    ASSERT_GE(result.NextSimIndex, 20u);
+    const arctic::TSimulationConfig config = arctic::MakeEngineConfig(initial.Params);
+    arctic::TSimulationStats sequential;
+    for (arctic::Ui64 simIndex = 0; simIndex < result.NextSimIndex; ++simIndex) {
+        sequential.AddResult(arctic::RunSingleSimulation(config, 906, simIndex));
+    }
+    ASSERT_TRUE(result.Stats == sequential);
+}
+
+// Две конфигурации считаются в одном процессе параллельно и не мешают друг другу.
+TEST_F(TEngineTest, ConfigsRunConcurrently) {
+    arctic::TSimulationParams params = arctic::MakeSmallTestParams();
+    const arctic::TSimulationConfig first = arctic::MakeTestConfig(params);
+    params.FailureRate = 5;
+    params.HostOutagesPerYear = 2000;
+    const arctic::TSimulationConfig second = arctic::MakeTestConfig(params);
+    const arctic::Ui64 sims = 20;
+
+    auto runAll = [sims](const arctic::TSimulationConfig& config) {
+        arctic::TSimulationStats stats;
+        for (arctic::Ui64 simIndex = 0; simIndex < sims; ++simIndex) {
+            stats.AddResult(arctic::RunSingleSimulation(config, 905, simIndex));
+        }
+        return stats;
+    };
+    const arctic::TSimulationStats firstExpected = runAll(first);
+    const arctic::TSimulationStats secondExpected = runAll(second);
+    ASSERT_FALSE(firstExpected == secondExpected);
+
+    arctic::TSimulationStats firstStats;
+    arctic::TSimulationStats secondStats;
+    std::thread firstThread([&] { firstStats = runAll(first); });
+    std::thread secondThread([&] { secondStats = runAll(second); });
+    firstThread.join();
+    secondThread.join();
+    EXPECT_TRUE(firstStats == firstExpected);
+    EXPECT_TRUE(secondStats == secondExpected);
+}
+
+TEST_F(TEngineTest, ReplayWithoutLogIsRejected) {
+    arctic::TEngineSnapshot initial;
+    initial.Params = arctic::MakeSmallTestParams();
+    initial.BaseSeed = 907;
+    arctic::TSimulationParams replay = initial.Params;
+    replay.HazardModel = arctic::kHazardReplay;
+    replay.FailureLogFingerprint = 0x5eed;
+
+    arctic::TSimulationEngine engine;
+    arctic::TEngineSnapshot rejected = initial;
+    rejected.Params = replay;
+    EXPECT_FALSE(engine.Start(2, rejected));
+
+    // Запущенный движок отвергает такие параметры и продолжает прежнюю оценку.
+    ASSERT_TRUE(engine.Start(2, initial));
+    EXPECT_FALSE(engine.PostParams(replay, 908));
+    const arctic::TEngineSnapshot result = WaitFor(engine, 0, 5);
+    engine.Stop();
+    EXPECT_EQ(result.Generation, 0u);
+    EXPECT_TRUE(result.Params == initial.Params);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "model/failure_log.h"
+#include "model/failure_model.h"
+#include "model/simulation.h"
+#include "model/simulation_runner.h"
+#include "test_config.h"
+#include <fstream>
+#include <set>
+
+class TFailureLogTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+
+    void SetUp() override {
+        arctic::InitTestLogger("failure_log_tests");
+        Params = arctic::MakeTestParams();
+        Params.DisksPerDc = 40;
+        Params.SpareDisksPerDc = 10;
+        Params.PDiskRecoveryTimeHours = 24 * 365;
+    }
+
+    static std::string WriteCsv(const std::string& name, const std::string& text) {
+        const std::string path = ::testing::TempDir() + name;
+        std::ofstream(path, std::ios::binary) << text;
+        return path;
+    }
+
+    // Журнал из трёх DC с идентификаторами 10, 20, 30: часы 0, 2, 2 и 5.
+    std::shared_ptr<const arctic::TFailureLog> OpenSampleLog() {
+        const auto log = arctic::OpenFailureLog(WriteCsv("failure_log_sample.csv",
+            "time,dc,disk\n1000000,10,3\n1007300,20,5\n1007400,30,7\n1018000,10,8\n"));
+        if (log) {
+            Params.HazardModel = arctic::kHazardReplay;
+            Params.FailureLogFingerprint = log->GetFingerprint();
+        }
+        return log;
+    }
+
+    static std::set<arctic::Ui32> GetBrokenPDisks(const arctic::Simulation& sim) {
+        std::set<arctic::Ui32> broken;
+        for (const auto& pdisk : sim.PDisks) {
+            if (pdisk->GetState() == arctic::TPDisk::Broken) {
+                broken.insert(pdisk->GetId().GetRawId());
+            }
+        }
+        return broken;
+    }
+};
+
+TEST_F(TFailureLogTest, CsvAndBinaryAgree) {
+    const std::string csv = WriteCsv("failure_log_unsorted.csv",
+        "# exported from the fleet database\r\n7300, 2, 11\r\n0,1,4\r\n\r\n3599,1,5\r\n");
+    arctic::TFailureLog fromCsv;
+    ASSERT_TRUE(fromCsv.Load(csv));
+    ASSERT_EQ(fromCsv.GetRecords().size(), 3u);
+    EXPECT_EQ(fromCsv.GetRecords()[0], (arctic::TFailureRecord{0, 1, 4}));
+    EXPECT_EQ(fromCsv.GetHourCount(), 3u);
+    EXPECT_EQ(fromCsv.GetHour(0).size(), 2u);
+    EXPECT_TRUE(fromCsv.GetHour(1).empty());
+    EXPECT_EQ(fromCsv.GetHour(2)[0].Disk, 11u);
+    EXPECT_EQ(fromCsv.GetDcCount(), 2u);
+    EXPECT_EQ(fromCsv.GetDcIndex(2), 1u);
+
+    const std::string binary = ::testing::TempDir() + "failure_log.dflg";
+    ASSERT_TRUE(arctic::SaveFailureLog(binary, {fromCsv.GetRecords().begin(), fromCsv.GetRecords().end()}));
+    arctic::TFailureLog fromBinary;
+    ASSERT_TRUE(fromBinary.Load(binary));
+    EXPECT_TRUE(std::equal(fromBinary.GetRecords().begin(), fromBinary.GetRecords().end(),
+                           fromCsv.GetRecords().begin(), fromCsv.GetRecords().end()));
+    EXPECT_EQ(fromBinary.GetFingerprint(), fromCsv.GetFingerprint());
+}
+
+TEST_F(TFailureLogTest, RejectsBrokenFiles) {
+    arctic::TFailureLog log;
+    EXPECT_FALSE(log.Load(WriteCsv("failure_log_bad.csv", "0,1,4\n5,x,4\n")));
+    EXPECT_FALSE(log.Load(WriteCsv("failure_log_empty.csv", "time,dc,disk\n")));
+    EXPECT_FALSE(log.Load(WriteCsv("failure_log_truncated.dflg", std::string("DFLG\1\0\0\0\5\0\0\0\0\0\0\0", 16))));
+    EXPECT_FALSE(log.Load(::testing::TempDir() + "no_such_failure_log.csv"));
+}
+
+TEST_F(TFailureLogTest, ReplaysLoggedDisksHourByHour) {
+    ASSERT_TRUE(OpenSampleLog());
+    const arctic::Ui32 pdisksPerDc = Params.DisksPerDc + Params.SpareDisksPerDc;
+    arctic::TRandomStream rng(1);
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(Params));
+    sim.SimulateHour(rng);
+    EXPECT_EQ(GetBrokenPDisks(sim), (std::set<arctic::Ui32>{3}));
+    sim.SimulateHour(rng);
+    sim.SimulateHour(rng);
+    EXPECT_EQ(GetBrokenPDisks(sim), (std::set<arctic::Ui32>{3, pdisksPerDc + 5, 2 * pdisksPerDc + 7}));
+    // Журнал циклический: на седьмом часу он начинается заново, и сломанный диск 3 заменяется соседним.
+    for (int hour = 3; hour < 7; ++hour) {
+        sim.SimulateHour(rng);
+    }
+    EXPECT_EQ(GetBrokenPDisks(sim), (std::set<arctic::Ui32>{3, 4, 8, pdisksPerDc + 5, 2 * pdisksPerDc + 7}));
+}
+
+TEST_F(TFailureLogTest, BootstrapShiftsTimeAndPermutesDcs) {
+    const auto log = OpenSampleLog();
+    ASSERT_TRUE(log);
+    std::set<std::set<arctic::Ui32>> firstHours;
+    for (arctic::Ui64 seed = 0; seed < 40; ++seed) {
+        arctic::TRandomStream rng(seed);
+        arctic::Simulation sim;
+        sim.Reset(arctic::MakeTestConfig(Params));
+        sim.StartReplay(rng);
+        for (arctic::Ui32 hour = 0; hour < log->GetHourCount(); ++hour) {
+            sim.SimulateHour(rng);
+            if (hour == 0) {
+                firstHours.insert(GetBrokenPDisks(sim));
+            }
+        }
+        // За полный цикл журнала воспроизводится каждый отказ ровно один раз.
+        EXPECT_EQ(GetBrokenPDisks(sim).size(), log->GetRecords().size());
+    }
+    EXPECT_GT(firstHours.size(), 3u);
+}
+
+TEST_F(TFailureLogTest, RunsAreReproducible) {
+    ASSERT_TRUE(OpenSampleLog());
+    Params.HorizonHours = 100;
+    const arctic::TSimulationConfig config = arctic::MakeTestConfig(Params);
+    ASSERT_TRUE(config.FailureLog);
+    for (arctic::Ui64 simIndex = 0; simIndex < 5; ++simIndex) {
+        const arctic::SimulationResult first = arctic::RunSingleSimulation(config, 7, simIndex);
+        const arctic::SimulationResult second = arctic::RunSingleSimulation(config, 7, simIndex);
+        EXPECT_EQ(first.lossHour, second.lossHour);
+        EXPECT_EQ(first.hoursSimulated, second.hoursSimulated);
+    }
+}
+
+// Без журнала прогоны шли бы без отказов, поэтому такая конфигурация не собирается.
+TEST_F(TFailureLogTest, ReplayWithoutLogIsRejected) {
+    Params.HazardModel = arctic::kHazardReplay;
+    Params.FailureLogFingerprint = 0x5eed;
+    arctic::TSimulationConfig config;
+    EXPECT_FALSE(arctic::TSimulationConfig::FromParams(Params, config));
+    EXPECT_FALSE(config.FailureLog);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "model/failure_model.h"
+#include "model/simulation.h"
+#include "test_config.h"
+#include <cmath>
+#include <fstream>
+
+class TFailureModelTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+
+    void SetUp() override {
+        arctic::InitTestLogger("failure_model_tests");
+        Params = arctic::MakeTestParams();
+    }
+};
+
+TEST_F(TFailureModelTest, WeibullTableMatchesClosedForm) {
+    Params.HazardModel = arctic::kHazardWeibull;
+    Params.WeibullShapeMilli = 700;
+    Params.WeibullScaleDays = 1000;
+    arctic::THazardTable table;
+    ASSERT_TRUE(table.BuildFromParams(Params, 2000 * 24.0));
+
+    const double scale = 1000 * 24.0;
+    for (double ageDays : {1.0, 30.0, 365.0, 1500.0}) {
+        const double age = ageDays * 24.0;
+        const double exact = std::pow(age / scale, 0.7);
+        EXPECT_NEAR(table.GetCumulative(age), exact, exact * 0.01);
+        EXPECT_NEAR(table.GetAgeForCumulative(exact), age, age * 0.01);
+    }
+}
+
+TEST_F(TFailureModelTest, PiecewiseTableFromCsv) {
+    const std::string path = ::testing::TempDir() + "hazard_test.csv";
+    {
+        std::ofstream file(path);
+        file << "age_days,afr_percent\n";
+        file << "100,2\n";
+        file << "0,10\n";
+    }
+    ASSERT_TRUE(arctic::LoadPiecewiseHazard(path, Params.PiecewiseHazard));
+    ASSERT_EQ(Params.PiecewiseHazard.size(), 2u);
+    EXPECT_EQ(Params.PiecewiseHazard[0].AgeDays, 0u);
+    EXPECT_EQ(Params.PiecewiseHazard[0].AfrMilliPercent, 10000u);
+
+    Params.HazardModel = arctic::kHazardPiecewise;
+    arctic::THazardTable table;
+    ASSERT_TRUE(table.BuildFromParams(Params, 400 * 24.0));
+
+    const double youngRate = -std::log(0.9) / 365.0;
+    const double oldRate = -std::log(0.98) / 365.0;
+    EXPECT_NEAR(table.GetCumulative(50 * 24.0), 50 * youngRate, 1e-3);
+    EXPECT_NEAR(table.GetCumulative(300 * 24.0), 100 * youngRate + 200 * oldRate, 1e-3);
+    // За пределами таблицы интенсивность остаётся последней.
+    EXPECT_NEAR(table.GetCumulative(800 * 24.0) - table.GetCumulative(400 * 24.0), 400 * oldRate, 1e-3);
+
+    std::remove(path.c_str());
+}
+
+TEST_F(TFailureModelTest, SampledLifetimesFollowHazard) {
+    Params.HazardModel = arctic::kHazardWeibull;
+    Params.WeibullShapeMilli = 1000;
+    Params.WeibullScaleDays = 10;
+    arctic::THazardTable table;
+    ASSERT_TRUE(table.BuildFromParams(Params, 100 * 24.0));
+
+    // Форма 1 - экспоненциальное распределение со средним 10 дней при любом возрасте.
+    arctic::TRandomStream rng(7);
+    const int samples = 20000;
+    double sum = 0;
+    for (int i = 0; i < samples; ++i) {
+        sum += table.SampleTimeToFailure(50 * 24.0, rng);
+    }
+    EXPECT_NEAR(sum / samples, 240.0, 240.0 * 0.03);
+}
+
+TEST_F(TFailureModelTest, NewBatchFailsMoreOften) {
+    Params.HazardModel = arctic::kHazardWeibull;
+    Params.WeibullShapeMilli = 500;
+    Params.WeibullScaleDays = 20000;
+    Params.FleetAgeDays = 1000;
+    Params.NewBatchPercent = 50;
+    Params.PDiskRecoveryTimeHours = 24 * 365;
+
+    arctic::Ui32 newFailures = 0;
+    arctic::Ui32 oldFailures = 0;
+    const arctic::Ui32 pdisksPerDc = Params.DisksPerDc + Params.SpareDisksPerDc;
+    for (arctic::Ui32 run = 0; run < 5; ++run) {
+        arctic::TRandomStream rng(run);
+        arctic::Simulation sim;
+        sim.Reset(arctic::MakeTestConfig(Params));
+        for (arctic::Ui32 hour = 0; hour < 30 * 24; ++hour) {
+            sim.SimulateHour(rng);
+        }
+        for (const auto& pdisk : sim.PDisks) {
+            if (pdisk->GetState() == arctic::TPDisk::Broken) {
+                (pdisk->GetId().GetRawId() % pdisksPerDc < pdisksPerDc / 2 ? newFailures : oldFailures)++;
+            }
+        }
+    }
+    EXPECT_GT(newFailures, 2 * oldFailures);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "model/failure_strata.h"
+#include "model/failure_model.h"
+#include "model/simulation_runner.h"
+#include "model/simulation_stats.h"
+#include "test_config.h"
+#include <cmath>
+
+class TFailureStrataTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+
+    void SetUp() override {
+        arctic::InitTestLogger("failure_strata_tests");
+        Params = arctic::MakeTestParams();
+    }
+};
+
+TEST_F(TFailureStrataTest, WeightsAndAllocationSumToOne) {
+    arctic::TFailureStrata strata;
+    ASSERT_TRUE(strata.Build(Params));
+    ASSERT_GT(strata.GetStratumCount(), 1u);
+    ASSERT_LE(strata.GetStratumCount(), arctic::kMaxFailureStrata);
+    double weight = 0.0;
+    double allocation = 0.0;
+    for (arctic::Ui32 s = 0; s < strata.GetStratumCount(); ++s) {
+        weight += strata.GetWeight(s);
+        allocation += strata.GetAllocation(s);
+        EXPECT_GT(strata.GetAllocation(s), 0.0);
+    }
+    EXPECT_NEAR(weight, 1.0, 1e-9);
+    EXPECT_NEAR(allocation, 1.0, 1e-9);
+    // Страты с большим числом отказов получают долю прогонов больше своей вероятности.
+    const arctic::Ui32 last = strata.GetStratumCount() - 1;
+    EXPECT_GT(strata.GetAllocation(last) / strata.GetWeight(last), strata.GetAllocation(0) / strata.GetWeight(0));
+}
+
+TEST_F(TFailureStrataTest, PickStratumFollowsAllocation) {
+    arctic::TFailureStrata strata;
+    ASSERT_TRUE(strata.Build(Params));
+    const arctic::Ui32 runs = 10000;
+    std::vector<arctic::Ui32> counts(strata.GetStratumCount());
+    for (arctic::Ui32 i = 0; i < runs; ++i) {
+        counts[strata.PickStratum(i)]++;
+    }
+    for (arctic::Ui32 s = 0; s < strata.GetStratumCount(); ++s) {
+        EXPECT_NEAR(static_cast<double>(counts[s]) / runs, strata.GetAllocation(s), 0.002) << "stratum " << s;
+    }
+}
+
+// Смесь условных распределений страт с их весами даёт исходное Binomial(H, frac).
+TEST_F(TFailureStrataTest, WeightedCountsMatchBinomialMean) {
+    Params.FailureRate = 2;
+    Params.HorizonHours = 240;
+    arctic::TFailureStrata strata;
+    ASSERT_TRUE(strata.Build(Params));
+    arctic::TRandomStream rng(7);
+    double mean = 0.0;
+    for (arctic::Ui32 s = 0; s < strata.GetStratumCount(); ++s) {
+        double sum = 0.0;
+        const arctic::Ui32 draws = 4000;
+        for (arctic::Ui32 i = 0; i < draws; ++i) {
+            sum += strata.DrawFailureCount(s, rng);
+        }
+        mean += strata.GetWeight(s) * sum / draws;
+    }
+    EXPECT_NEAR(mean, 240.0 * 2.0 / 24.0, 0.1);
+}
+
+TEST_F(TFailureStrataTest, NothingToStratify) {
+    arctic::TFailureStrata strata;
+    Params.FailureRate = 48;
+    EXPECT_FALSE(strata.Build(Params));
+    Params.FailureRate = 3;
+    Params.HazardModel = arctic::kHazardWeibull;
+    EXPECT_FALSE(strata.Build(Params));
+    Params.HazardModel = arctic::kHazardConstant;
+    EXPECT_TRUE(strata.Build(Params));
+}
+
+TEST_F(TFailureStrataTest, StratifiedEstimateCombinesStrata) {
+    arctic::TSimulationStats stats;
+    // Вклад страты определяется её весом, а не долей прогонов в ней.
+    for (arctic::Ui32 i = 0; i < 100; ++i) {
+        arctic::SimulationResult result;
+        result.hoursSimulated = 10;
+        result.stratum = i % 4 == 0 ? 1 : 0;
+        result.stratumWeight = result.stratum == 1 ? 0.25 : 0.75;
+        const bool loss = result.stratum == 1 ? i % 8 == 0 : i % 10 == 1;
+        result.lossHour = loss ? 5 : -1;
+        stats.AddResult(result);
+    }
+    ASSERT_TRUE(stats.IsStratified());
+    const double p0 = static_cast<double>(stats.Strata[0].LossTimes.GetCount()) / stats.Strata[0].Sims;
+    const double p1 = static_cast<double>(stats.Strata[1].LossTimes.GetCount()) / stats.Strata[1].Sims;
+    EXPECT_DOUBLE_EQ(stats.GetLossProbability(10), 0.75 * p0 + 0.25 * p1);
+    EXPECT_DOUBLE_EQ(stats.GetLossProbability(4), 0.0);
+    const arctic::TLossEstimate estimate = stats.GetLossEstimate(10);
+    EXPECT_NEAR(estimate.StdError, std::sqrt(0.75 * 0.75 * p0 * (1 - p0) / stats.Strata[0].Sims +
+                                             0.25 * 0.25 * p1 * (1 - p1) / stats.Strata[1].Sims), 1e-12);
+
+    std::vector<arctic::Ui8> buffer;
+    stats.Serialize(buffer);
+    arctic::TSimulationStats restored;
+    const arctic::Ui8* pos = buffer.data();
+    ASSERT_TRUE(restored.Deserialize(pos, buffer.data() + buffer.size()));
+    EXPECT_TRUE(restored == stats);
+}
+
+// Стратифицированная выборка несмещена: совпадает с независимыми прогонами в пределах ошибки.
+TEST_F(TFailureStrataTest, StratifiedRunsMatchIndependentRuns) {
+    Params.FailureRate = 20;
+    Params.SpareDisksPerDc = 200;
+    Params.HorizonHours = 72;
+    const arctic::Ui32 sims = 300;
+    const arctic::TSimulationConfig plainConfig = arctic::MakeTestConfig(Params);
+    const arctic::TSimulationConfig stratifiedConfig = arctic::MakeTestConfig(Params, 0, true);
+
+    arctic::TSimulationStats plain;
+    for (arctic::Ui32 i = 0; i < sims; ++i) {
+        plain.AddResult(arctic::RunSingleSimulation(plainConfig, 31, i));
+    }
+    arctic::TSimulationStats stratified;
+    for (arctic::Ui32 i = 0; i < sims; ++i) {
+        stratified.AddResult(arctic::RunSingleSimulation(stratifiedConfig, 31, i));
+    }
+    ASSERT_FALSE(plain.IsStratified());
+    ASSERT_TRUE(stratified.IsStratified());
+    EXPECT_FALSE(stratified.HasControl());
+
+    const arctic::TLossEstimate a = plain.GetLossEstimate(Params.HorizonHours);
+    const arctic::TLossEstimate b = stratified.GetLossEstimate(Params.HorizonHours);
+    EXPECT_NEAR(a.Probability, b.Probability, 4.0 * std::hypot(a.StdError, b.StdError));
+}
@@ -1,9 +1,15 @@
 #include <gtest/gtest.h>
 #include "model/group.h"
+#include "model/group_loss.h"
 #include "model/vdisk.h"
 #include "model/pdisk.h" 
+#include "model/simulation_params.h"
+#include "utils/logger.h"
+#include "test_config.h"
 #include <memory> 
 #include <unordered_map> 
+#include <algorithm>
+#include <cstring>
 
 class TGroupTest : public ::testing::Test {
 protected:
@@ -164,3 +170,144 @@ TEST_F(TGroupTest, CheckDataLoss_LossCase_2_1_1) {
     SetVDiskState(6, arctic::TVDisk::Faulty);
     ASSERT_TRUE(group->CheckDataLoss());
 }
+
+TEST(TErasureSchemeTest, Mirror3DcMatchesSortedRule) {
+    for (int a = 0; a <= 3; ++a) {
+        for (int b = 0; b <= 3; ++b) {
+            for (int c = 0; c <= 3; ++c) {
+                std::vector<int> sorted = {a, b, c};
+                std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+                const bool expected = sorted[2] > 0 || (sorted[1] >= 2 && sorted[0] >= 3);
+                const arctic::Ui8 failed[3] = {arctic::Ui8(a), arctic::Ui8(b), arctic::Ui8(c)};
+                ASSERT_EQ(arctic::TMirror3Dc::IsDataLoss(failed), expected) << a << b << c;
+            }
+        }
+    }
+}
+
+TEST(TErasureSchemeTest, Block42ToleratesTwoFailures) {
+    const arctic::TErasureSchemeInfo& scheme = arctic::GetErasureScheme(arctic::kBlock42Scheme);
+    ASSERT_EQ(scheme.NumDCs, 1u);
+    ASSERT_EQ(scheme.GetGroupSize(), 8u);
+
+    arctic::TGroup group(arctic::TGroupId::FromValue(2), scheme);
+    std::vector<std::shared_ptr<arctic::TVDisk>> vdisks;
+    for (int i = 0; i < 8; ++i) {
+        auto vdisk = std::make_shared<arctic::TVDisk>(arctic::TVDiskId::FromValue(i), arctic::TPDiskId::FromValue(i), arctic::TDCId(1));
+        vdisks.push_back(vdisk);
+        group.AddVDisk(vdisk, arctic::TDCId(0));
+    }
+    vdisks[0]->SetState(arctic::TVDisk::Faulty);
+    vdisks[5]->SetState(arctic::TVDisk::Replicating);
+    ASSERT_FALSE(group.CheckDataLoss());
+    vdisks[7]->SetState(arctic::TVDisk::Faulty);
+    ASSERT_TRUE(group.CheckDataLoss());
+}
+
+TEST(TErasureSchemeTest, Mirror3Of4LosesDataOnlyWhenThreeDomainsFail) {
+    const arctic::TErasureSchemeInfo& scheme = arctic::GetErasureScheme(arctic::kMirror3Of4Scheme);
+    ASSERT_STREQ(scheme.Name, arctic::TMirror3Of4::Name);
+    ASSERT_EQ(scheme.NumDCs, 4u);
+    ASSERT_EQ(scheme.GetGroupSize(), 8u);
+
+    for (int mask = 0; mask < 81; ++mask) {
+        arctic::Ui8 failed[4];
+        int touchedDomains = 0;
+        for (int domain = 0, rest = mask; domain < 4; ++domain, rest /= 3) {
+            failed[domain] = rest % 3;
+            touchedDomains += failed[domain] > 0;
+        }
+        ASSERT_EQ(scheme.IsDataLoss(failed), touchedDomains >= 3) << mask;
+    }
+}
+
+namespace {
+
+// Перебирает все наборы отказавших VDisk'ов группы схемы TScheme и сравнивает
+// развёрнутую проверку записи с проверкой TGroup по предикату из реестра.
+template <typename TScheme>
+void ExpectRecordCheckMatchesGroup(arctic::Ui32 schemeId) {
+    const arctic::Ui32 size = TScheme::NumDCs * TScheme::VDisksPerDC;
+    arctic::TGroup group(arctic::TGroupId::FromValue(0), arctic::GetErasureScheme(schemeId));
+    arctic::TGroupRecord record;
+    record.VDisksPerDC = TScheme::VDisksPerDC;
+    record.Scheme = schemeId;
+    std::vector<std::shared_ptr<arctic::TVDisk>> vdisks;
+    std::vector<const arctic::TVDisk*> byIndex;
+    // VDisk'и группы лежат не подряд, как и в симуляции.
+    for (arctic::Ui32 i = 0; i < 2 * size; ++i) {
+        vdisks.push_back(std::make_shared<arctic::TVDisk>(arctic::TVDiskId::FromValue(i), arctic::TPDiskId::FromValue(i),
+                                                          arctic::TDCId(0)));
+        byIndex.push_back(vdisks.back().get());
+    }
+    for (arctic::Ui32 position = 0; position < size; ++position) {
+        record.VDisks[record.Size++] = 2 * position + 1;
+        group.AddVDisk(vdisks[2 * position + 1], arctic::TDCId(position / TScheme::VDisksPerDC));
+    }
+    const arctic::TGroupLossCheck check = arctic::GetGroupLossCheck(schemeId);
+    for (arctic::Ui32 mask = 0; mask < (1u << size); ++mask) {
+        for (arctic::Ui32 position = 0; position < size; ++position) {
+            arctic::TVDisk& vdisk = *vdisks[record.VDisks[position]];
+            vdisk.Reset();
+            if (mask & (1u << position)) {
+                vdisk.SetState(position % 2 ? arctic::TVDisk::Faulty : arctic::TVDisk::Replicating);
+            }
+        }
+        ASSERT_EQ(arctic::CheckDataLoss<TScheme>(record, byIndex.data()), group.CheckDataLoss()) << mask;
+        ASSERT_EQ(check(record, byIndex.data()), group.CheckDataLoss()) << mask;
+    }
+}
+
+} // namespace
+
+TEST(TGroupRecordTest, SchemeCheckMatchesGroupForAllFailureSets) {
+    ExpectRecordCheckMatchesGroup<arctic::TMirror3Dc>(arctic::kMirror3DcScheme);
+    ExpectRecordCheckMatchesGroup<arctic::TBlock42>(arctic::kBlock42Scheme);
+    ExpectRecordCheckMatchesGroup<arctic::TMirror3Of4>(arctic::kMirror3Of4Scheme);
+}
+
+TEST(TGroupRecordTest, MatchesGroupAndCopiesByValue) {
+    const arctic::TErasureSchemeInfo& scheme = arctic::GetErasureScheme(arctic::kMirror3DcScheme);
+    arctic::TGroup group(arctic::TGroupId::FromValue(0), scheme);
+    arctic::TGroupRecord record;
+    record.VDisksPerDC = scheme.VDisksPerDC;
+    record.Scheme = arctic::kMirror3DcScheme;
+
+    std::vector<std::shared_ptr<arctic::TVDisk>> vdisks;
+    std::vector<const arctic::TVDisk*> byIndex;
+    for (int i = 0; i < 9; ++i) {
+        auto vdisk = std::make_shared<arctic::TVDisk>(arctic::TVDiskId::FromValue(i), arctic::TPDiskId::FromValue(i), arctic::TDCId(i / 3));
+        vdisks.push_back(vdisk);
+        byIndex.push_back(vdisk.get());
+        group.AddVDisk(vdisk, arctic::TDCId(i / 3));
+        record.VDisks[record.Size++] = i;
+    }
+    ASSERT_LE(sizeof(record), 40u);
+
+    // Один DC целиком и ещё два отказа во втором.
+    for (int i : {0, 1, 2, 3}) {
+        vdisks[i]->SetState(arctic::TVDisk::Faulty);
+        ASSERT_EQ(arctic::CheckDataLoss<arctic::TMirror3Dc>(record, byIndex.data()), group.CheckDataLoss());
+    }
+    ASSERT_FALSE(arctic::CheckDataLoss<arctic::TMirror3Dc>(record, byIndex.data()));
+    vdisks[4]->SetState(arctic::TVDisk::Replicating);
+    ASSERT_TRUE(arctic::CheckDataLoss<arctic::TMirror3Dc>(record, byIndex.data()));
+    ASSERT_TRUE(group.CheckDataLoss());
+
+    arctic::TGroupRecord copy;
+    std::memcpy(&copy, &record, sizeof(record));
+    ASSERT_TRUE(arctic::GetGroupLossCheck(copy.Scheme)(copy, byIndex.data()));
+}
+
+TEST(TErasureSchemeTest, UnknownSchemeIsRejected) {
+    arctic::InitTestLogger("group_tests");
+    EXPECT_STREQ(arctic::GetErasureScheme(arctic::kErasureSchemeCount).Name, arctic::TMirror3Dc::Name);
+
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.ErasureScheme = arctic::kErasureSchemeCount;
+    std::vector<arctic::Ui8> buffer;
+    params.Serialize(buffer);
+    arctic::TSimulationParams restored;
+    const arctic::Ui8* pos = buffer.data();
+    EXPECT_FALSE(restored.Deserialize(pos, buffer.data() + buffer.size()));
+}
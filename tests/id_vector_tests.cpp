@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "model/id_vector.h"
+
+TEST(TIdWrapperTest, Addition) {
+    arctic::TPDiskId id = arctic::TPDiskId::FromValue(5);
+    ASSERT_EQ((id + 3u).GetRawId(), 8u);
+    id += 2;
+    ASSERT_EQ(id.GetRawId(), 7u);
+}
+
+TEST(TIdVectorTest, IndexesByRawId) {
+    arctic::TIdVector<arctic::TVDiskId, int> values;
+    ASSERT_TRUE(values.Empty());
+    for (int i = 0; i < 10; ++i) {
+        const arctic::TVDiskId id = values.PushBack(i * 10);
+        ASSERT_EQ(id.GetRawId(), static_cast<arctic::Ui32>(i));
+    }
+    ASSERT_EQ(values.Size(), 10u);
+    ASSERT_EQ(values.EndId().GetRawId(), 10u);
+    ASSERT_EQ(values[arctic::TVDiskId::FromValue(7)], 70);
+
+    values[arctic::TVDiskId::FromValue(3)] = -1;
+    ASSERT_EQ(*values.FindPtr(arctic::TVDiskId::FromValue(3)), -1);
+    ASSERT_EQ(values.FindPtr(arctic::TVDiskId::FromValue(10)), nullptr);
+    ASSERT_FALSE(values.Contains(arctic::TVDiskId::FromValue(10)));
+
+    int sum = 0;
+    for (int value : values) {
+        sum += value;
+    }
+    ASSERT_EQ(sum, 450 - 30 - 1);
+}
+
+TEST(TIdBitsetTest, SetTestAndReset) {
+    arctic::TIdBitset<arctic::TGroupId> bits(130);
+    ASSERT_EQ(bits.Size(), 130u);
+    ASSERT_EQ(bits.Count(), 0u);
+
+    const arctic::TGroupId id = arctic::TGroupId::FromValue(129);
+    ASSERT_TRUE(bits.TestAndSet(id));
+    ASSERT_FALSE(bits.TestAndSet(id));
+    bits.Set(arctic::TGroupId::FromValue(0));
+    bits.Set(arctic::TGroupId::FromValue(64));
+    ASSERT_TRUE(bits.Test(arctic::TGroupId::FromValue(64)));
+    ASSERT_FALSE(bits.Test(arctic::TGroupId::FromValue(63)));
+    ASSERT_EQ(bits.Count(), 3u);
+
+    bits.Reset(id);
+    ASSERT_FALSE(bits.Test(id));
+    bits.Clear();
+    ASSERT_EQ(bits.Count(), 0u);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "utils/logger.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+class TLoggerTest : public ::testing::Test {
+protected:
+    std::string Path;
+
+    void SetUp() override {
+        Path = ::testing::TempDir() + "logger_tests.log";
+        RemoveLog();
+        arctic::Logger::Close();
+        // 10 строк на сегмент: ротация после каждых 10 сообщений.
+        arctic::Logger::Init(Path, 50, arctic::Logger::OutputMode::FILE_ONLY);
+    }
+
+    void TearDown() override {
+        arctic::Logger::Close();
+        RemoveLog();
+    }
+
+    void RemoveLog() const {
+        std::error_code ec;
+        std::filesystem::remove_all(Path, ec);
+        for (int index = 0; index < 4; ++index) {
+            std::filesystem::remove_all(Path + "." + std::to_string(index), ec);
+        }
+    }
+
+    static size_t CountLines(const std::string& path) {
+        std::ifstream file(path);
+        size_t lines = 0;
+        for (std::string line; std::getline(file, line);) {
+            lines++;
+        }
+        return lines;
+    }
+};
+
+// Воркер после fork не пишет в лог координатора и не ротирует его сегменты.
+TEST_F(TLoggerTest, ForkedChildDetachesFromLogFile) {
+    arctic::Logger::Log("before fork");
+    const size_t lines = CountLines(Path);
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        arctic::Logger::DetachFileAfterFork();
+        for (int i = 0; i < 30; ++i) {
+            arctic::Logger::Log("from the child");
+        }
+        _exit(0);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(CountLines(Path), lines);
+    EXPECT_FALSE(std::filesystem::exists(Path + ".0"));
+
+    arctic::Logger::Log("after fork");
+    EXPECT_EQ(CountLines(Path), lines + 1);
+}
+
+// Активный лог не переименовывается: он дописывается, но не дальше общего лимита сегментов.
+TEST_F(TLoggerTest, FailedRotationKeepsSizeLimit) {
+    // Непустые каталоги на месте сегментов: ни сдвиг, ни переименование активного лога не проходят.
+    for (int index = 0; index < 4; ++index) {
+        const std::string dir = Path + "." + std::to_string(index);
+        std::filesystem::create_directories(dir);
+        std::ofstream(dir + "/keep") << "x";
+    }
+    for (int i = 0; i < 200; ++i) {
+        arctic::Logger::Log("message " + std::to_string(i));
+    }
+    // Заголовок запуска занимает две строки, сообщений не больше maxLines.
+    EXPECT_LE(CountLines(Path), 52u);
+    std::ifstream file(Path);
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(text.find("message 0\n"), std::string::npos);
+    EXPECT_NE(text.find("message 49\n"), std::string::npos);
+    EXPECT_EQ(text.find("message 50\n"), std::string::npos);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "model/markov_estimator.h"
+#include "model/simulation_runner.h"
+#include "model/simulation_stats.h"
+#include "model/erasure_scheme.h"
+#include "model/failure_model.h"
+#include "test_config.h"
+
+class TMarkovTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        arctic::InitTestLogger("markov_tests");
+    }
+};
+
+TEST_F(TMarkovTest, NoFailuresNoLoss) {
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.FailureRate = 0;
+    arctic::TMarkovEstimate estimate;
+    ASSERT_TRUE(arctic::EstimateLossMarkov(params, estimate));
+    ASSERT_EQ(estimate.LossProbability.size(), params.HorizonHours / estimate.StepHours + 1);
+    for (double p : estimate.LossProbability) {
+        EXPECT_EQ(p, 0.0);
+    }
+}
+
+TEST_F(TMarkovTest, CurveIsMonotoneForAllSchemes) {
+    for (arctic::Ui32 scheme = 0; scheme < arctic::kErasureSchemeCount; ++scheme) {
+        arctic::TSimulationParams params = arctic::MakeTestParams();
+        params.ErasureScheme = scheme;
+        arctic::TMarkovEstimate estimate;
+        ASSERT_TRUE(arctic::EstimateLossMarkov(params, estimate));
+        EXPECT_GT(estimate.LossProbability.back(), 0.0);
+        for (size_t i = 1; i < estimate.LossProbability.size(); ++i) {
+            EXPECT_GE(estimate.LossProbability[i] + 1e-12, estimate.LossProbability[i - 1]);
+            EXPECT_LE(estimate.LossProbability[i], 1.0);
+        }
+    }
+}
+
+TEST_F(TMarkovTest, FasterReplicationLowersLoss) {
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    arctic::TMarkovEstimate slow;
+    ASSERT_TRUE(arctic::EstimateLossMarkov(params, slow));
+    params.WriteSpeed *= 4;
+    arctic::TMarkovEstimate fast;
+    ASSERT_TRUE(arctic::EstimateLossMarkov(params, fast));
+    EXPECT_LT(fast.LossProbability.back(), slow.LossProbability.back());
+}
+
+TEST_F(TMarkovTest, SpareExhaustionRaisesLoss) {
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.FailureRate = 20;
+    arctic::TMarkovEstimate plenty;
+    ASSERT_TRUE(arctic::EstimateLossMarkov(params, plenty));
+    params.SpareDisksPerDc = 1;
+    params.PDiskRecoveryTimeHours = 24 * 30;
+    arctic::TMarkovEstimate scarce;
+    ASSERT_TRUE(arctic::EstimateLossMarkov(params, scarce));
+    EXPECT_GT(scarce.LossProbability.back(), plenty.LossProbability.back());
+}
+
+TEST_F(TMarkovTest, AgeBasedModelIsRejected) {
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.HazardModel = arctic::kHazardWeibull;
+    arctic::TMarkovEstimate estimate;
+    EXPECT_FALSE(arctic::EstimateLossMarkov(params, estimate));
+}
+
+// С большим запасом спаре параллельные репликации почти не делят полосу, и цепь
+// должна совпасть с Monte Carlo в пределах статистической ошибки.
+TEST_F(TMarkovTest, MatchesMonteCarloWithPlentyOfSpares) {
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.FailureRate = 20;
+    params.SpareDisksPerDc = 200;
+    params.HorizonHours = 72;
+    arctic::TMarkovEstimate estimate;
+    ASSERT_TRUE(arctic::EstimateLossMarkov(params, estimate));
+
+    const arctic::TSimulationConfig config = arctic::MakeTestConfig(params);
+    arctic::TSimulationStats stats;
+    const arctic::Ui32 sims = 600;
+    for (arctic::Ui32 i = 0; i < sims; ++i) {
+        stats.AddResult(arctic::RunSingleSimulation(config, 17, i));
+    }
+    const double markov = estimate.LossProbability.back();
+    const double monteCarlo = stats.GetLossProbability(params.HorizonHours);
+    RecordProperty("markov_loss", std::to_string(markov));
+    RecordProperty("monte_carlo_loss", std::to_string(monteCarlo));
+    EXPECT_GT(markov, 0.02);
+    EXPECT_NEAR(markov, monteCarlo, 0.03);
+}
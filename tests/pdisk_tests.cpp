@@ -12,7 +12,7 @@ namespace arctic {
 TEST(TPDiskTest, InitialState) {
     arctic::TPDiskId pdiskId = arctic::TPDiskId::FromValue(1);
     arctic::TDCId dcId(0);
-    arctic::TPDisk pdisk(pdiskId, dcId, arctic::TPDisk::Active);
+    arctic::TPDisk pdisk(pdiskId, dcId, arctic::TPDisk::Active, arctic::GVDisksPerPDisk);
 
     ASSERT_EQ(pdisk.GetState(), arctic::TPDisk::Active);
     ASSERT_EQ(pdisk.GetId(), pdiskId);
@@ -24,7 +24,7 @@ TEST(TPDiskTest, InitialState) {
 TEST(TPDiskTest, FailAndRecover) {
     arctic::TPDiskId pdiskId = arctic::TPDiskId::FromValue(2);
     arctic::TDCId dcId(1);
-    auto pdisk = std::make_shared<arctic::TPDisk>(pdiskId, dcId, arctic::TPDisk::Active);
+    auto pdisk = std::make_shared<arctic::TPDisk>(pdiskId, dcId, arctic::TPDisk::Active, arctic::GVDisksPerPDisk);
 
     auto vdisk1 = std::make_shared<arctic::TVDisk>(arctic::TVDiskId::FromValue(10), pdiskId, dcId);
     auto vdisk2 = std::make_shared<arctic::TVDisk>(arctic::TVDiskId::FromValue(11), pdiskId, dcId);
@@ -56,7 +56,7 @@ TEST(TPDiskTest, FailAndRecover) {
 TEST(TPDiskTest, DecrementSlots) {
      arctic::TPDiskId pdiskId = arctic::TPDiskId::FromValue(3);
      arctic::TDCId dcId(2);
-     arctic::TPDisk pdisk(pdiskId, dcId, arctic::TPDisk::Spare);
+     arctic::TPDisk pdisk(pdiskId, dcId, arctic::TPDisk::Spare, arctic::GVDisksPerPDisk);
 
      ASSERT_EQ(pdisk.GetAvailableVDiskSlots(), arctic::GVDisksPerPDisk);
      pdisk.DecrementAvailableVDiskSlots();
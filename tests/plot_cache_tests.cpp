@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "view/plot_cache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Линия из точек по пикселям: в каждом столбце минимум и максимум y.
+void ColumnExtremes(const std::vector<arctic::Vec2D>& points, double xMax, arctic::Si32 columns,
+                    std::vector<double>& lo, std::vector<double>& hi) {
+    lo.assign(columns, 1e300);
+    hi.assign(columns, -1e300);
+    for (const auto& point : points) {
+        const arctic::Si32 column = std::min<arctic::Si32>(columns - 1, static_cast<arctic::Si32>(point.x / xMax * columns));
+        lo[column] = std::min(lo[column], point.y);
+        hi[column] = std::max(hi[column], point.y);
+    }
+}
+
+} // namespace
+
+TEST(TPlotCacheTest, DecimationKeepsColumnExtremes) {
+    std::vector<arctic::Vec2D> points;
+    for (int i = 0; i < 100000; ++i) {
+        const double x = i * 0.01;
+        points.emplace_back(x, std::sin(x * 7.0) + (i % 97 == 0 ? 3.0 : 0.0));
+    }
+    const double xMax = 1000.0;
+    const arctic::Si32 columns = 200;
+
+    std::vector<arctic::Vec2D> decimated;
+    arctic::DecimateMinMax(points, xMax, columns, decimated);
+    ASSERT_LE(decimated.size(), 4u * columns);
+    ASSERT_EQ(decimated.front().x, points.front().x);
+    ASSERT_EQ(decimated.back().x, points.back().x);
+    ASSERT_TRUE(std::is_sorted(decimated.begin(), decimated.end(),
+                               [](const auto& a, const auto& b) { return a.x < b.x; }));
+
+    std::vector<double> loRaw, hiRaw, lo, hi;
+    ColumnExtremes(points, xMax, columns, loRaw, hiRaw);
+    ColumnExtremes(decimated, xMax, columns, lo, hi);
+    ASSERT_EQ(lo, loRaw);
+    ASSERT_EQ(hi, hiRaw);
+}
+
+TEST(TPlotCacheTest, SmallCurvesAreKeptAsIs) {
+    std::vector<arctic::Vec2D> points = {{0.0, 0.0}, {1.0, 0.5}, {2.0, 0.25}};
+    std::vector<arctic::Vec2D> decimated;
+    arctic::DecimateMinMax(points, 30.0, 100, decimated);
+    ASSERT_EQ(decimated.size(), points.size());
+}
+
+TEST(TPlotCacheTest, RebuiltOnlyOnNewVersion) {
+    arctic::TSimulationStats stats;
+    for (arctic::Ui64 i = 0; i < 100; ++i) {
+        arctic::SimulationResult result;
+        result.hoursSimulated = 720;
+        if (i % 10 == 0) {
+            result.lossHour = i * 7;
+            result.hoursSimulated = i * 7 + 1;
+        }
+        stats.AddResult(result);
+    }
+
+    arctic::TPlotCache plot;
+    ASSERT_FALSE(plot.IsUpToDate(1));
+    plot.Begin(1, 30.0, 2, arctic::Vec2Si32(300, 100));
+    arctic::BuildLossCurve(stats, 30.0, plot.GetRawBuffer());
+    plot.SetCurve(0, arctic::Rgba(255, 0, 0), plot.GetRawBuffer());
+    arctic::BuildLossCurveBound(stats, 30.0, true, plot.GetRawBuffer());
+    plot.SetCurve(1, arctic::Rgba(96, 32, 32), plot.GetRawBuffer());
+    plot.Finish();
+
+    ASSERT_TRUE(plot.IsUpToDate(1));
+    ASSERT_FALSE(plot.IsUpToDate(2));
+    const auto& curves = plot.GetCurves();
+    ASSERT_EQ(plot.GetCurveCount(), 2u);
+    ASSERT_NEAR(curves[0].Points.back().y, 0.1, 1e-12);
+    ASSERT_GT(curves[1].Points.back().y, curves[0].Points.back().y);
+    // Общий масштаб берётся по верхней кривой интервала.
+    ASSERT_EQ(curves[1].Pixels.back().y, 100);
+    ASSERT_EQ(curves[0].Pixels.back().x, 300);
+}
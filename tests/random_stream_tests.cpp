@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "model/random_stream.h"
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+arctic::Ui64 Rotl(arctic::Ui64 x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+arctic::Ui64 SplitMix64(arctic::Ui64& state) {
+    arctic::Ui64 z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Эталонный xoshiro256** одной дорожки.
+struct TReferenceLane {
+    std::array<arctic::Ui64, 4> S;
+
+    arctic::Ui64 Next() {
+        const arctic::Ui64 result = Rotl(S[1] * 5, 7) * 9;
+        const arctic::Ui64 t = S[1] << 17;
+        S[2] ^= S[0];
+        S[3] ^= S[1];
+        S[1] ^= S[2];
+        S[0] ^= S[3];
+        S[2] ^= t;
+        S[3] = Rotl(S[3], 45);
+        return result;
+    }
+};
+
+} // namespace
+
+// Какой бы путь ни выбрался на этом процессоре, выход - чередование четырёх эталонных дорожек.
+TEST(TRandomStreamTest, MatchesReferenceLanes) {
+    const arctic::Ui64 seed = 12345;
+    arctic::Ui64 mix = seed;
+    std::array<TReferenceLane, 4> lanes;
+    for (auto& lane : lanes) {
+        for (auto& word : lane.S) {
+            word = SplitMix64(mix);
+        }
+    }
+    arctic::TRandomStream rng(seed);
+    for (int step = 0; step < 1000; ++step) {
+        for (auto& lane : lanes) {
+            ASSERT_EQ(rng(), lane.Next()) << "step " << step;
+        }
+    }
+}
+
+TEST(TRandomStreamTest, ReseedRepeatsSequence) {
+    arctic::TRandomStream rng(7);
+    std::vector<arctic::Ui64> first;
+    for (int i = 0; i < 700; ++i) {
+        first.push_back(rng());
+    }
+    rng.Seed(8);
+    const arctic::Ui64 other = rng();
+    rng.Seed(7);
+    for (int i = 0; i < 700; ++i) {
+        ASSERT_EQ(rng(), first[i]);
+    }
+    EXPECT_NE(other, first[0]);
+}
+
+TEST(TRandomStreamTest, BoundedIsUniform) {
+    arctic::TRandomStream rng(3);
+    const arctic::Ui32 range = 7;
+    const int draws = 70000;
+    std::array<int, range> counts = {};
+    for (int i = 0; i < draws; ++i) {
+        const arctic::Ui32 value = rng.NextBounded(range);
+        ASSERT_LT(value, range);
+        ++counts[value];
+    }
+    // Ожидается 10000 на значение, стандартное отклонение около 93.
+    for (int count : counts) {
+        EXPECT_NEAR(count, draws / range, 500);
+    }
+    EXPECT_EQ(rng.NextBounded(1), 0u);
+}
+
+TEST(TRandomStreamTest, DistributionMeans) {
+    arctic::TRandomStream rng(11);
+    const int draws = 200000;
+    double uniformSum = 0.0;
+    double exponentialSum = 0.0;
+    double geometricSum = 0.0;
+    for (int i = 0; i < draws; ++i) {
+        const double u = rng.NextUniform();
+        ASSERT_GE(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        uniformSum += u;
+        exponentialSum += rng.NextExponential();
+        geometricSum += static_cast<double>(rng.NextGeometric(0.25));
+    }
+    EXPECT_NEAR(uniformSum / draws, 0.5, 0.005);
+    EXPECT_NEAR(exponentialSum / draws, 1.0, 0.01);
+    // Среднее число неудач (1 - p) / p = 3.
+    EXPECT_NEAR(geometricSum / draws, 3.0, 0.05);
+    EXPECT_EQ(rng.NextGeometric(1.0), 0u);
+}
+
+TEST(TRandomStreamTest, FillExponentialMatchesSequentialDraws) {
+    arctic::TRandomStream bulk(5);
+    arctic::TRandomStream single(5);
+    // Куски разной длины, чтобы пересечь границы буфера.
+    for (size_t count : {3u, 300u, 1u, 517u}) {
+        std::vector<double> values(count);
+        bulk.FillExponential(values.data(), values.size());
+        for (double value : values) {
+            ASSERT_EQ(value, single.NextExponential());
+        }
+        ASSERT_EQ(bulk.NextUniform(), single.NextUniform());
+    }
+}
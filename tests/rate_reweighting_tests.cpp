@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "model/rate_reweighting.h"
+#include "model/simulation_runner.h"
+#include "model/failure_model.h"
+#include "test_config.h"
+#include <cmath>
+
+class TRateReweightingTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+
+    void SetUp() override {
+        arctic::InitTestLogger("rate_reweighting_tests");
+        Params = arctic::MakeTestParams();
+        Params.FailureRate = 18;
+        Params.SpareDisksPerDc = 200;
+        Params.HorizonHours = 72;
+    }
+
+    arctic::TSimulationStats RunSims(arctic::Ui64 seed, arctic::Ui32 sims) const {
+        const arctic::TSimulationConfig config = arctic::MakeTestConfig(Params);
+        arctic::TSimulationStats stats;
+        for (arctic::Ui32 i = 0; i < sims; ++i) {
+            stats.AddResult(arctic::RunSingleSimulation(config, seed, i));
+        }
+        return stats;
+    }
+};
+
+TEST_F(TRateReweightingTest, SameRateKeepsPlainEstimate) {
+    const arctic::TSimulationStats stats = RunSims(41, 200);
+    ASSERT_EQ(stats.RunSummaries.Size(), 200u);
+    arctic::TReweightedLoss loss;
+    ASSERT_TRUE(arctic::ReweightFailureRate(stats, Params, 18, loss));
+    EXPECT_DOUBLE_EQ(loss.EffectiveSampleSize, 200.0);
+    for (arctic::Ui64 hours = 0; hours <= Params.HorizonHours; hours += 8) {
+        EXPECT_NEAR(loss.GetLossProbability(hours), stats.GetLossProbability(hours), 1e-12);
+    }
+}
+
+TEST_F(TRateReweightingTest, WeightsFollowLikelihoodRatio) {
+    // Два прогона по 10 часов: с 5 и 2 дополнительными отказами, первый с потерей в час 9.
+    arctic::TSimulationStats stats;
+    stats.RunSummaries.Add({5, 10, 9});
+    stats.RunSummaries.Add({2, 10, -1});
+    arctic::TSimulationParams params = Params;
+    params.FailureRate = 12;
+    arctic::TReweightedLoss loss;
+    ASSERT_TRUE(arctic::ReweightFailureRate(stats, params, 6, loss));
+    // p = 1/2, p' = 1/4: w = (1/2)^K (3/2)^(T - K).
+    const double first = std::pow(0.5, 5) * std::pow(1.5, 5);
+    const double second = std::pow(0.5, 2) * std::pow(1.5, 8);
+    EXPECT_NEAR(loss.GetLossProbability(9), first / (first + second), 1e-12);
+    EXPECT_DOUBLE_EQ(loss.GetLossProbability(8), 0.0);
+    EXPECT_NEAR(loss.EffectiveSampleSize, (first + second) * (first + second) / (first * first + second * second), 1e-9);
+}
+
+TEST_F(TRateReweightingTest, DisjointFailureProcessesAreRejected) {
+    const arctic::TSimulationStats stats = RunSims(41, 10);
+    arctic::TSimulationParams params = Params;
+    arctic::TReweightedLoss loss;
+    // floor(r) при 30 отказах в сутки на час больше, и таких прогонов среди посчитанных нет.
+    EXPECT_FALSE(arctic::ReweightFailureRate(stats, params, 30, loss));
+    EXPECT_FALSE(arctic::ReweightFailureRate(stats, params, 24, loss));
+    params.HazardModel = arctic::kHazardWeibull;
+    EXPECT_FALSE(arctic::ReweightFailureRate(stats, params, 17, loss));
+}
+
+// Пересчёт на соседнюю интенсивность совпадает с прямым Monte Carlo в пределах ошибки.
+TEST_F(TRateReweightingTest, MatchesDirectSimulation) {
+    const arctic::Ui32 sims = 400;
+    const arctic::TSimulationStats base = RunSims(41, sims);
+    arctic::TReweightedLoss loss;
+    ASSERT_TRUE(arctic::ReweightFailureRate(base, Params, 17, loss));
+    EXPECT_GT(loss.EffectiveSampleSize, sims / 4.0);
+
+    Params.FailureRate = 17;
+    const arctic::TSimulationStats direct = RunSims(43, sims);
+    const double p = direct.GetLossProbability(Params.HorizonHours);
+    const double reweighted = loss.GetLossProbability(Params.HorizonHours);
+    const double stdError = std::hypot(std::sqrt(p * (1.0 - p) / sims), loss.Points.empty() ? 0.0 : loss.Points.back().StdError);
+    EXPECT_NEAR(reweighted, p, 4.0 * stdError + 1e-9);
+}
+
+TEST_F(TRateReweightingTest, SummariesSurviveSerialization) {
+    const arctic::TSimulationStats stats = RunSims(41, 30);
+    std::vector<arctic::Ui8> buffer;
+    stats.Serialize(buffer);
+    arctic::TSimulationStats restored;
+    const arctic::Ui8* pos = buffer.data();
+    ASSERT_TRUE(restored.Deserialize(pos, buffer.data() + buffer.size()));
+    EXPECT_TRUE(restored.RunSummaries == stats.RunSummaries);
+}
+
+// Копия делит заполненные куски с оригиналом, но дописывается независимо от него.
+TEST_F(TRateReweightingTest, SummaryCopiesAreIndependent) {
+    const size_t count = 3 * arctic::TRunSummaries::kChunkSize + 5;
+    arctic::TRunSummaries summaries;
+    for (size_t i = 0; i < count; ++i) {
+        summaries.Add({static_cast<arctic::Ui32>(i), 10, -1});
+    }
+    arctic::TRunSummaries copy = summaries;
+    copy.Add({7, 10, 3});
+    ASSERT_EQ(summaries.Size(), count);
+    ASSERT_EQ(copy.Size(), count + 1);
+    EXPECT_EQ(copy[count].LossHour, 3);
+    EXPECT_FALSE(copy == summaries);
+
+    arctic::TRunSummaries merged;
+    merged.Append(summaries, count - 2);
+    merged.Append(copy, 3);
+    ASSERT_EQ(merged.Size(), count + 1);
+    for (size_t i = 0; i < count - 2; ++i) {
+        ASSERT_EQ(merged[i].ExtraFailureHours, i);
+    }
+    EXPECT_EQ(merged[count - 2].ExtraFailureHours, 0u);
+    EXPECT_EQ(merged[count].ExtraFailureHours, 2u);
+}
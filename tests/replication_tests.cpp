@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "model/replication_flows.h"
+#include "model/simulation.h"
+#include "test_config.h"
+
+namespace {
+
+// 3600 MB при 1 MB/s - ровно час.
+const double kHourOfWriteMB = 3600.0;
+
+} // namespace
+
+TEST(TReplicationSchedulerTest, SingleFlowRunsAtFullSpeed) {
+    arctic::TReplicationScheduler scheduler;
+    scheduler.Reset(4, 1, 1.0, 0.0);
+    ASSERT_DOUBLE_EQ(scheduler.StartFlow(7, 0, 0, kHourOfWriteMB, 0.0), 1.0);
+
+    arctic::Ui32 vdisk = 0;
+    double time = 0;
+    ASSERT_FALSE(scheduler.PopCompleted(0.5, vdisk, time));
+    ASSERT_TRUE(scheduler.PopCompleted(1.0, vdisk, time));
+    ASSERT_EQ(vdisk, 7u);
+    ASSERT_DOUBLE_EQ(time, 1.0);
+    ASSERT_EQ(scheduler.GetActiveFlowCount(), 0u);
+}
+
+TEST(TReplicationSchedulerTest, FlowsShareTargetPDisk) {
+    arctic::TReplicationScheduler scheduler;
+    scheduler.Reset(4, 1, 1.0, 0.0);
+    scheduler.StartFlow(1, 0, 0, kHourOfWriteMB, 0.0);
+    // Второй поток на тот же PDisk стартует, когда первый выполнен наполовину.
+    scheduler.StartFlow(2, 0, 0, kHourOfWriteMB, 0.5);
+    // Поток на другом PDisk'е не мешает первым двум.
+    scheduler.StartFlow(3, 1, 0, kHourOfWriteMB, 0.25);
+
+    arctic::Ui32 vdisk = 0;
+    double time = 0;
+    ASSERT_TRUE(scheduler.PopCompleted(10.0, vdisk, time));
+    ASSERT_EQ(vdisk, 3u);
+    ASSERT_DOUBLE_EQ(time, 1.25);
+    // Оставшиеся полчаса работы первого потока при половинной скорости занимают час.
+    ASSERT_TRUE(scheduler.PopCompleted(10.0, vdisk, time));
+    ASSERT_EQ(vdisk, 1u);
+    ASSERT_DOUBLE_EQ(time, 1.5);
+    // Второй сделал половину за час, остаток - на полной скорости.
+    ASSERT_TRUE(scheduler.PopCompleted(10.0, vdisk, time));
+    ASSERT_EQ(vdisk, 2u);
+    ASSERT_DOUBLE_EQ(time, 2.0);
+    ASSERT_FALSE(scheduler.PopCompleted(10.0, vdisk, time));
+}
+
+TEST(TReplicationSchedulerTest, DcNetworkLimitsAllFlowsInDc) {
+    arctic::TReplicationScheduler scheduler;
+    scheduler.Reset(4, 2, 1.0, 1.0);
+    scheduler.StartFlow(1, 0, 0, kHourOfWriteMB, 0.0);
+    scheduler.StartFlow(2, 1, 0, kHourOfWriteMB, 0.0);
+    scheduler.StartFlow(3, 2, 1, kHourOfWriteMB, 0.0);
+
+    arctic::Ui32 vdisk = 0;
+    double time = 0;
+    ASSERT_TRUE(scheduler.PopCompleted(10.0, vdisk, time));
+    ASSERT_EQ(vdisk, 3u);
+    ASSERT_DOUBLE_EQ(time, 1.0);
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(scheduler.PopCompleted(10.0, vdisk, time));
+        ASSERT_DOUBLE_EQ(time, 2.0);
+    }
+}
+
+TEST(TReplicationSchedulerTest, CancelledFlowFreesBandwidth) {
+    arctic::TReplicationScheduler scheduler;
+    scheduler.Reset(4, 1, 1.0, 0.0);
+    scheduler.StartFlow(1, 0, 0, kHourOfWriteMB, 0.0);
+    scheduler.StartFlow(2, 0, 0, kHourOfWriteMB, 0.0);
+    // За полчаса вдвоём каждый сделал четверть, дальше второй идёт один.
+    ASSERT_TRUE(scheduler.CancelFlow(1, 0.5));
+    ASSERT_FALSE(scheduler.CancelFlow(1, 0.5));
+    ASSERT_EQ(scheduler.GetActiveFlowCount(), 1u);
+
+    arctic::Ui32 vdisk = 0;
+    double time = 0;
+    ASSERT_TRUE(scheduler.PopCompleted(10.0, vdisk, time));
+    ASSERT_EQ(vdisk, 2u);
+    ASSERT_DOUBLE_EQ(time, 1.25);
+    ASSERT_FALSE(scheduler.PopCompleted(10.0, vdisk, time));
+}
+
+// Повторный отказ PDisk'а посреди репликации: завершение прежней репликации не закрывает новый отказ.
+TEST(TReplicationSchedulerTest, RefaultRestartsReplication) {
+    arctic::InitTestLogger("replication_tests");
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.ErasureScheme = arctic::kMirror3DcScheme;
+    params.DiskSize = 360;
+    params.WriteSpeed = 1;
+    params.PDiskRecoveryTimeHours = 1;
+    // Спар хватает, чтобы вторая репликация не делила PDisk с первой.
+    params.SpareDisksPerDc = 30;
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(params));
+    // Копия 360 * 1024 MB на 1 MB/s пишется 102.4 часа.
+    ASSERT_EQ(sim.GetConfig().CopySizeMb, 360.0 * 1024);
+
+    const arctic::TVDiskId vdiskId = arctic::TVDiskId::FromValue(sim.Groups.begin()->VDisks[0]);
+    const arctic::TVDisk& vdisk = *sim.VDisks[vdiskId];
+    const arctic::TPDiskId pdiskId = vdisk.GetPDiskId();
+    ASSERT_TRUE(sim.FailPDisk(pdiskId));
+    sim.AdvanceHour();
+    ASSERT_EQ(vdisk.GetState(), arctic::TVDisk::Replicating);
+    sim.AdvanceHour();
+    ASSERT_EQ(sim.PDisks[pdiskId]->GetState(), arctic::TPDisk::Spare);
+
+    ASSERT_TRUE(sim.FailPDisk(pdiskId));
+    ASSERT_EQ(vdisk.GetState(), arctic::TVDisk::Faulty);
+    while (sim.CurrentTime < 104) {
+        sim.AdvanceHour();
+    }
+    // Первая репликация закончилась бы в 102.4, вторая стартовала в час 2.
+    EXPECT_EQ(vdisk.GetState(), arctic::TVDisk::Replicating);
+    while (sim.CurrentTime < 106) {
+        sim.AdvanceHour();
+    }
+    EXPECT_EQ(vdisk.GetState(), arctic::TVDisk::Replicated);
+    EXPECT_TRUE(sim.LostGroupInfo.empty());
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "controller/shard_coordinator.h"
+#include "controller/simulation_engine.h"
+#include "model/result_cache.h"
+#include "model/simulation_runner.h"
+#include "test_config.h"
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+class TResultCacheTest : public ::testing::Test {
+protected:
+    arctic::Ui32 savedEntries = 0;
+    std::string savedDir;
+
+    void SetUp() override {
+        arctic::InitTestLogger("result_cache_tests");
+        savedEntries = arctic::GResultCacheEntries;
+        savedDir = arctic::GResultCacheDir;
+        arctic::GResultCacheDir.clear();
+        arctic::TResultCache::Instance().Clear();
+    }
+
+    void TearDown() override {
+        arctic::GResultCacheEntries = savedEntries;
+        arctic::GResultCacheDir = savedDir;
+        arctic::TResultCache::Instance().Clear();
+    }
+
+    static arctic::TSimulationConfig MakeConfig(arctic::Ui32 failureRate) {
+        arctic::TSimulationParams params = arctic::MakeSmallTestParams();
+        params.FailureRate = failureRate;
+        return arctic::MakeTestConfig(params);
+    }
+
+    static arctic::TCheckpoint MakeEntry(arctic::Ui32 failureRate, arctic::Ui64 baseSeed, arctic::Ui64 sims) {
+        arctic::TCheckpoint entry = arctic::TCheckpoint::ForConfig(MakeConfig(failureRate));
+        entry.BaseSeed = baseSeed;
+        entry.NextSimIndex = sims;
+        entry.Stats.Sims = sims;
+        return entry;
+    }
+};
+
+TEST_F(TResultCacheTest, PutGetRoundTrip) {
+    arctic::TResultCache& cache = arctic::TResultCache::Instance();
+    cache.Put(MakeEntry(20, 5, 100));
+    arctic::TCheckpoint entry;
+    ASSERT_TRUE(cache.Get(MakeConfig(20), entry));
+    EXPECT_EQ(entry.BaseSeed, 5u);
+    EXPECT_EQ(entry.NextSimIndex, 100u);
+    EXPECT_FALSE(cache.Get(MakeConfig(21), entry));
+}
+
+TEST_F(TResultCacheTest, KeyDependsOnEstimationSettings) {
+    const arctic::TCheckpoint estimate = MakeEntry(20, 0, 0);
+    const arctic::Ui64 key = arctic::MakeResultCacheKey(estimate);
+    EXPECT_NE(key, arctic::MakeResultCacheKey(MakeEntry(21, 0, 0)));
+    arctic::TCheckpoint other = estimate;
+    other.StratifiedSampling = !other.StratifiedSampling;
+    EXPECT_NE(key, arctic::MakeResultCacheKey(other));
+    other = estimate;
+    other.ControlCalibrationRuns += 1;
+    EXPECT_NE(key, arctic::MakeResultCacheKey(other));
+    EXPECT_EQ(key, arctic::MakeResultCacheKey(MakeEntry(20, 5, 100)));
+}
+
+// Оценка с другими настройками лежит отдельно и не продолжается прогонами текущей конфигурации.
+TEST_F(TResultCacheTest, GetMatchesConfigSettings) {
+    arctic::TResultCache& cache = arctic::TResultCache::Instance();
+    arctic::TCheckpoint stratified = MakeEntry(20, 5, 100);
+    stratified.StratifiedSampling = !stratified.StratifiedSampling;
+    cache.Put(stratified);
+    arctic::TSimulationConfig config = MakeConfig(20);
+    arctic::TCheckpoint entry;
+    EXPECT_FALSE(cache.Get(config, entry));
+    config.StratifiedSampling = stratified.StratifiedSampling;
+    ASSERT_TRUE(cache.Get(config, entry));
+    EXPECT_EQ(entry.BaseSeed, 5u);
+}
+
+TEST_F(TResultCacheTest, LeastRecentlyUsedIsEvicted) {
+    arctic::GResultCacheEntries = 2;
+    arctic::TResultCache& cache = arctic::TResultCache::Instance();
+    cache.Put(MakeEntry(1, 1, 10));
+    cache.Put(MakeEntry(2, 2, 10));
+    arctic::TCheckpoint entry;
+    ASSERT_TRUE(cache.Get(MakeConfig(1), entry));
+    cache.Put(MakeEntry(3, 3, 10));
+    EXPECT_EQ(cache.Size(), 2u);
+    EXPECT_TRUE(cache.Get(MakeConfig(1), entry));
+    EXPECT_FALSE(cache.Get(MakeConfig(2), entry));
+    EXPECT_TRUE(cache.Get(MakeConfig(3), entry));
+}
+
+TEST_F(TResultCacheTest, ShorterEstimateDoesNotReplaceLonger) {
+    arctic::TResultCache& cache = arctic::TResultCache::Instance();
+    cache.Put(MakeEntry(20, 5, 100));
+    cache.Put(MakeEntry(20, 6, 50));
+    arctic::TCheckpoint entry;
+    ASSERT_TRUE(cache.Get(MakeConfig(20), entry));
+    EXPECT_EQ(entry.BaseSeed, 5u);
+    cache.Put(MakeEntry(20, 6, 150));
+    ASSERT_TRUE(cache.Get(MakeConfig(20), entry));
+    EXPECT_EQ(entry.NextSimIndex, 150u);
+}
+
+TEST_F(TResultCacheTest, DiskEntriesSurviveClear) {
+    const std::string dir = ::testing::TempDir() + "result_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    arctic::GResultCacheDir = dir;
+    arctic::TResultCache& cache = arctic::TResultCache::Instance();
+    cache.Put(MakeEntry(20, 5, 100));
+    cache.Clear();
+    arctic::TCheckpoint entry;
+    ASSERT_TRUE(cache.Get(MakeConfig(20), entry));
+    EXPECT_EQ(entry.BaseSeed, 5u);
+    EXPECT_EQ(entry.Stats.Sims, 100u);
+    EXPECT_EQ(cache.Size(), 1u);
+}
+
+// Возврат к прежним параметрам продолжает их оценку тем же потоком seed'ов.
+TEST_F(TResultCacheTest, EngineResumesPreviousParams) {
+    arctic::TEngineSnapshot initial;
+    initial.Params = arctic::MakeSmallTestParams();
+    initial.BaseSeed = 902;
+    arctic::TSimulationParams other = initial.Params;
+    other.FailureRate = 5;
+
+    arctic::TSimulationEngine engine;
+    ASSERT_TRUE(engine.Start(2, initial));
+    auto waitFor = [&engine](arctic::Ui64 generation, arctic::Ui64 count) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (std::chrono::steady_clock::now() < deadline) {
+            const arctic::TEngineSnapshot& snapshot = engine.ReadSnapshot();
+            if (snapshot.Generation == generation && snapshot.NextSimIndex >= count) {
+                return snapshot;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return engine.ReadSnapshot();
+    };
+    const arctic::Ui64 firstCount = waitFor(0, 10).NextSimIndex;
+    ASSERT_GE(firstCount, 10u);
+    ASSERT_TRUE(engine.PostParams(other, 903));
+    waitFor(1, 5);
+    ASSERT_TRUE(engine.PostParams(initial.Params, 904));
+    const arctic::TEngineSnapshot result = waitFor(2, firstCount + 5);
+    engine.Stop();
+
+    ASSERT_EQ(result.Generation, 2u);
+    EXPECT_EQ(result.BaseSeed, 902u);
+    ASSERT_GE(result.NextSimIndex, firstCount);
+    const arctic::TSimulationConfig config = arctic::MakeEngineConfig(initial.Params);
+    arctic::TSimulationStats sequential;
+    for (arctic::Ui64 simIndex = 0; simIndex < result.NextSimIndex; ++simIndex) {
+        sequential.AddResult(arctic::RunSingleSimulation(config, 902, simIndex));
+    }
+    EXPECT_TRUE(result.Stats == sequential);
+}
+
+TEST_F(TResultCacheTest, CachedEstimateRunsOnlyMissingSims) {
+    const arctic::TSimulationConfig config = MakeConfig(20);
+    arctic::TShardingOptions options;
+    options.BaseSeed = 777;
+    options.ShardSize = 8;
+    arctic::TCheckpoint first;
+    ASSERT_TRUE(arctic::RunCachedEstimate(config, options, 20, first));
+    EXPECT_EQ(first.NextSimIndex, 20u);
+
+    // Сид записи из кэша важнее переданного.
+    options.BaseSeed = 1;
+    arctic::TCheckpoint second;
+    ASSERT_TRUE(arctic::RunCachedEstimate(config, options, 40, second));
+    EXPECT_EQ(second.BaseSeed, 777u);
+    EXPECT_EQ(second.NextSimIndex, 40u);
+    arctic::TSimulationStats sequential;
+    for (arctic::Ui64 simIndex = 0; simIndex < 40; ++simIndex) {
+        sequential.AddResult(arctic::RunSingleSimulation(config, 777, simIndex));
+    }
+    EXPECT_TRUE(second.Stats == sequential);
+}
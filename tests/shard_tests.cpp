@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "controller/shard_coordinator.h"
+#include "model/simulation_runner.h"
+#include "model/simulation_params.h"
+#include "test_config.h"
+
+class TShardTest : public ::testing::Test {
+protected:
+    arctic::TSimulationConfig Config;
+
+    void SetUp() override {
+        arctic::InitTestLogger("shard_tests");
+        Config = arctic::MakeTestConfig(arctic::MakeSmallTestParams());
+    }
+
+    arctic::TSimulationStats RunSequential(arctic::Ui64 baseSeed, arctic::Ui64 count) const {
+        arctic::TSimulationStats stats;
+        for (arctic::Ui64 simIndex = 0; simIndex < count; ++simIndex) {
+            stats.AddResult(arctic::RunSingleSimulation(Config, baseSeed, simIndex));
+        }
+        return stats;
+    }
+};
+
+TEST_F(TShardTest, MatchesSequentialRun) {
+    arctic::TShardingOptions options;
+    options.Workers = 3;
+    options.BaseSeed = 777;
+    options.SimCount = 40;
+    options.ShardSize = 7;
+
+    arctic::TSimulationStats sharded;
+    ASSERT_TRUE(arctic::RunShardedEstimate(Config, options, sharded));
+
+    const arctic::TSimulationStats sequential = RunSequential(777, 40);
+    ASSERT_EQ(sharded.Sims, 40u);
+    ASSERT_TRUE(sharded == sequential);
+}
+
+TEST_F(TShardTest, FailedShardIsRescheduled) {
+    arctic::TShardingOptions options;
+    options.Workers = 2;
+    options.BaseSeed = 778;
+    options.SimCount = 20;
+    options.ShardSize = 5;
+    options.CrashAtSimIndex = 12;
+
+    arctic::TSimulationStats sharded;
+    ASSERT_TRUE(arctic::RunShardedEstimate(Config, options, sharded));
+
+    const arctic::TSimulationStats sequential = RunSequential(778, 20);
+    ASSERT_EQ(sharded.Sims, 20u);
+    ASSERT_TRUE(sharded == sequential);
+}
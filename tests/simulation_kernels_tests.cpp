@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "model/simulation_runner.h"
+#include "model/simulation_params.h"
+#include "test_config.h"
+
+class TSimulationKernelsTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+
+    void SetUp() override {
+        arctic::InitTestLogger("simulation_kernels_tests");
+        Params = arctic::MakeTestParams();
+        Params.DisksPerDc = 30;
+        Params.SpareDisksPerDc = 3;
+        Params.FailureRate = 30;
+        Params.HorizonHours = 10 * 24;
+    }
+
+    // Специализированные и общие циклы должны давать один и тот же прогон.
+    void ExpectSameRuns() const {
+        arctic::TSimulationConfig config = arctic::MakeTestConfig(Params);
+        arctic::TSimulationStats specialized;
+        arctic::TSimulationStats generic;
+        for (arctic::Ui64 simIndex = 0; simIndex < 40; ++simIndex) {
+            config.SpecializedKernels = true;
+            specialized.AddResult(arctic::RunSingleSimulation(config, 61, simIndex));
+            config.SpecializedKernels = false;
+            generic.AddResult(arctic::RunSingleSimulation(config, 61, simIndex));
+        }
+        EXPECT_GT(generic.GetLossProbability(Params.HorizonHours), 0.0);
+        EXPECT_TRUE(specialized == generic);
+    }
+};
+
+TEST_F(TSimulationKernelsTest, Mirror3DcWithNineVDisksMatchesGeneric) {
+    ExpectSameRuns();
+}
+
+TEST_F(TSimulationKernelsTest, Block42WithEightVDisksMatchesGeneric) {
+    Params.ErasureScheme = arctic::kBlock42Scheme;
+    Params.VDisksPerPDisk = 8;
+    ExpectSameRuns();
+}
+
+TEST_F(TSimulationKernelsTest, Mirror3Of4WithEightVDisksMatchesGeneric) {
+    Params.ErasureScheme = arctic::kMirror3Of4Scheme;
+    Params.NumDCs = 4;
+    Params.VDisksPerPDisk = 8;
+    ExpectSameRuns();
+}
+
+TEST_F(TSimulationKernelsTest, UnspecializedLayoutFallsBack) {
+    Params.VDisksPerPDisk = 5;
+    Params.HostOutagesPerYear = 2000;
+    ExpectSameRuns();
+}
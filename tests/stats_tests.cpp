@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include "model/simulation_stats.h"
+#include <cmath>
+
+TEST(TLossTimeHistogramTest, BucketsAreExactThenLogarithmic) {
+    for (arctic::Ui64 hours = 0; hours < 64; ++hours) {
+        ASSERT_EQ(arctic::TLossTimeHistogram::GetBucketBegin(arctic::TLossTimeHistogram::GetBucket(hours)), hours);
+    }
+    // Пять лет в часах укладываются в несколько сотен корзин с погрешностью не больше 1/64.
+    const arctic::Ui64 fiveYears = 5 * 365 * 24;
+    ASSERT_LT(arctic::TLossTimeHistogram::GetBucket(fiveYears), 1000u);
+    for (arctic::Ui64 hours = 64; hours < fiveYears; hours += 37) {
+        const arctic::Ui64 begin = arctic::TLossTimeHistogram::GetBucketBegin(arctic::TLossTimeHistogram::GetBucket(hours));
+        ASSERT_LE(begin, hours);
+        ASSERT_LE(hours - begin, hours / 64);
+    }
+}
+
+TEST(TLossTimeHistogramTest, QuantilesAndProbability) {
+    arctic::TSimulationStats stats;
+    for (arctic::Si64 hour = 0; hour < 100; ++hour) {
+        arctic::SimulationResult result;
+        result.lossHour = hour;
+        result.hoursSimulated = hour + 1;
+        stats.AddResult(result);
+    }
+    for (int i = 0; i < 100; ++i) {
+        arctic::SimulationResult result;
+        result.hoursSimulated = 1000;
+        stats.AddResult(result);
+    }
+
+    EXPECT_EQ(stats.Sims, 200u);
+    EXPECT_EQ(stats.GetLossCount(), 100u);
+    EXPECT_DOUBLE_EQ(stats.GetLossProbability(9), 0.05);
+    EXPECT_DOUBLE_EQ(stats.GetLossProbability(1000), 0.5);
+    EXPECT_EQ(stats.LossTimes.GetQuantile(0.0), 0u);
+    EXPECT_NEAR(static_cast<double>(stats.LossTimes.GetQuantile(0.5)), 49.0, 2.0);
+    EXPECT_NEAR(static_cast<double>(stats.LossTimes.GetQuantile(0.99)), 98.0, 2.0);
+    // Время наблюдения 100 * 1000 + (1 + ... + 100) на 100 потерь.
+    EXPECT_DOUBLE_EQ(stats.GetMeanTimeToDataLoss(), (100000.0 + 5050.0) / 100.0);
+}
+
+TEST(TLossTimeHistogramTest, MemoryDoesNotGrowWithSims) {
+    arctic::TSimulationStats stats;
+    for (arctic::Ui64 i = 0; i < 100000; ++i) {
+        arctic::SimulationResult result;
+        result.lossHour = (i * 7919) % (5 * 365 * 24);
+        result.hoursSimulated = result.lossHour + 1;
+        stats.AddResult(result);
+    }
+    EXPECT_LT(stats.LossTimes.GetBuckets().size(), 1000u);
+
+    std::vector<arctic::Ui8> buffer;
+    stats.Serialize(buffer);
+    arctic::TSimulationStats restored;
+    const arctic::Ui8* pos = buffer.data();
+    ASSERT_TRUE(restored.Deserialize(pos, buffer.data() + buffer.size()));
+    EXPECT_TRUE(restored == stats);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <string>
+#include "model/erasure_scheme.h"
+#include "model/simulation_params.h"
+#include "utils/logger.h"
+
+namespace arctic {
+
+// Журнал теста во временном каталоге gtest, только в файл.
+inline void InitTestLogger(const std::string& name) {
+    Logger::Init(::testing::TempDir() + name + ".log", 1000, Logger::OutputMode::FILE_ONLY);
+}
+
+// Значения по умолчанию из simulation_params.cpp, собранные явно: тесты не читают
+// глобальные параметры и не зависят от того, что с ними сделал другой тест.
+inline TSimulationParams MakeTestParams() {
+    TSimulationParams params;
+    params.DisksPerDc = 100;
+    params.SpareDisksPerDc = 10;
+    params.VDisksPerPDisk = 9;
+    params.DiskSize = 4096;
+    params.WriteSpeed = 100;
+    params.FailureRate = 3;
+    params.PDiskRecoveryTimeHours = 24;
+    params.ErasureScheme = kMirror3DcScheme;
+    params.NumDCs = 3;
+    params.RacksPerDc = 3;
+    params.DisksPerHost = 12;
+    params.HostOutageHours = 4;
+    params.RackOutageHours = 8;
+    params.DcOutageHours = 12;
+    params.WeibullShapeMilli = 700;
+    params.WeibullScaleDays = 100000;
+    params.FleetAgeDays = 365;
+    params.HorizonHours = 30 * 24;
+    return params;
+}
+
+// Маленький кластер с частыми отказами: прогон занимает миллисекунды, а потери в нём случаются.
+inline TSimulationParams MakeSmallTestParams() {
+    TSimulationParams params = MakeTestParams();
+    params.DisksPerDc = 10;
+    params.SpareDisksPerDc = 1;
+    params.FailureRate = 20;
+    return params;
+}
+
+// Конфигурация, которую из params собирает движок: с глобальными настройками оценки.
+inline TSimulationConfig MakeEngineConfig(const TSimulationParams& params) {
+    TSimulationConfig config;
+    EXPECT_TRUE(TSimulationConfig::FromParams(params, config));
+    return config;
+}
+
+// Настройки оценки задаются здесь же, а не через GControlCalibrationRuns и GStratifiedSampling.
+inline TSimulationConfig MakeTestConfig(const TSimulationParams& params, Ui32 calibrationRuns = 0, bool stratified = false) {
+    TSimulationConfig config = MakeEngineConfig(params);
+    config.ControlCalibrationRuns = calibrationRuns;
+    config.StratifiedSampling = stratified;
+    config.RecordTraces = false;
+    return config;
+}
+
+} // namespace arctic
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "utils/thread_affinity.h"
+#include "utils/logger.h"
+#include <set>
+#include <thread>
+#include <utility>
+#include <sched.h>
+
+class TThreadAffinityTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        arctic::Logger::Init(::testing::TempDir() + "thread_affinity_tests.log", 1000, arctic::Logger::OutputMode::FILE_ONLY);
+    }
+};
+
+TEST_F(TThreadAffinityTest, OrderCoversAllowedCpusOnce) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+
+    const std::vector<arctic::TCpuSlot> order = arctic::BuildWorkerCpuOrder(true);
+    ASSERT_EQ(order.size(), static_cast<size_t>(CPU_COUNT(&allowed)));
+    std::set<arctic::Ui32> cpus;
+    for (const arctic::TCpuSlot& slot : order) {
+        EXPECT_TRUE(CPU_ISSET(slot.Cpu, &allowed));
+        EXPECT_TRUE(cpus.insert(slot.Cpu).second);
+    }
+}
+
+TEST_F(TThreadAffinityTest, WithoutSmtOneCpuPerCore) {
+    const std::vector<arctic::TCpuSlot> withSmt = arctic::BuildWorkerCpuOrder(true);
+    const std::vector<arctic::TCpuSlot> withoutSmt = arctic::BuildWorkerCpuOrder(false);
+    ASSERT_FALSE(withoutSmt.empty());
+    ASSERT_LE(withoutSmt.size(), withSmt.size());
+    // Без SMT берётся префикс полного порядка: сначала ядра, потом их вторые потоки.
+    for (size_t i = 0; i < withoutSmt.size(); ++i) {
+        EXPECT_EQ(withoutSmt[i].Cpu, withSmt[i].Cpu);
+    }
+}
+
+TEST_F(TThreadAffinityTest, PinnedThreadRunsOnItsCpu) {
+    const std::vector<arctic::TCpuSlot> order = arctic::BuildWorkerCpuOrder(true);
+    ASSERT_FALSE(order.empty());
+    const arctic::TCpuSlot slot = order.back();
+    bool pinned = false;
+    int cpu = -1;
+    std::thread worker([&] {
+        pinned = arctic::PinCurrentThread(slot);
+        cpu = sched_getcpu();
+    });
+    worker.join();
+    ASSERT_TRUE(pinned);
+    EXPECT_EQ(cpu, static_cast<int>(slot.Cpu));
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include "model/topology.h"
+#include "model/simulation.h"
+#include "model/simulation_params.h"
+#include "test_config.h"
+#include <set>
+
+TEST(TTopologyTest, DomainsAreContiguousRanges) {
+    arctic::TTopology topology;
+    // 2 DC по 50 PDisk'ов, хосты по 12 дисков (5 хостов, последний неполный), 2 стойки.
+    topology.Build(2, 50, 2, 12);
+
+    EXPECT_EQ(topology.GetPDiskCount(), 100u);
+    EXPECT_EQ(topology.GetDomainCount(arctic::kDomainDC), 2u);
+    EXPECT_EQ(topology.GetDomainCount(arctic::kDomainRack), 4u);
+    EXPECT_EQ(topology.GetDomainCount(arctic::kDomainHost), 10u);
+    EXPECT_EQ(topology.GetDomainsInDC(arctic::kDomainHost, 1), 5u);
+
+    for (arctic::EFailDomainLevel level : {arctic::kDomainDC, arctic::kDomainRack, arctic::kDomainHost}) {
+        arctic::Ui32 expectedBegin = 0;
+        for (arctic::Ui32 domain = 0; domain < topology.GetDomainCount(level); ++domain) {
+            const arctic::TFailDomain& range = topology.GetDomainRange(level, domain);
+            EXPECT_EQ(range.Begin, expectedBegin);
+            for (arctic::Ui32 pdisk = range.Begin; pdisk < range.End; ++pdisk) {
+                EXPECT_EQ(topology.GetDomain(level, pdisk), domain);
+            }
+            expectedBegin = range.End;
+        }
+        EXPECT_EQ(expectedBegin, 100u);
+    }
+
+    // Хост целиком лежит в стойке-родителе, стойка - в своём DC.
+    for (arctic::Ui32 host = 0; host < topology.GetDomainCount(arctic::kDomainHost); ++host) {
+        const arctic::TFailDomain& range = topology.GetDomainRange(arctic::kDomainHost, host);
+        EXPECT_EQ(topology.GetDomain(arctic::kDomainRack, range.Begin), range.Parent);
+        EXPECT_EQ(topology.GetDomain(arctic::kDomainRack, range.End - 1), range.Parent);
+    }
+}
+
+TEST(TTopologyTest, Mirror3DcGroupsSpreadOverDomains) {
+    arctic::InitTestLogger("topology_tests");
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.NumDCs = 5;
+    params.ErasureScheme = arctic::kMirror3DcScheme;
+
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(params));
+    ASSERT_FALSE(sim.Groups.Empty());
+
+    std::vector<arctic::Ui32> groupsByDC(params.NumDCs, 0);
+    for (const auto& group : sim.Groups) {
+        std::set<arctic::Ui32> dcs;
+        std::set<arctic::Ui32> racks;
+        for (arctic::Ui32 position = 0; position < group.Size; ++position) {
+            const arctic::TVDiskId vdiskId = arctic::TVDiskId::FromValue(group.VDisks[position]);
+            const arctic::Ui32 pdisk = sim.VDisks[vdiskId]->GetPDiskId().GetRawId();
+            dcs.insert(sim.Topology.GetDomain(arctic::kDomainDC, pdisk));
+            racks.insert(sim.Topology.GetDomain(arctic::kDomainRack, pdisk));
+        }
+        EXPECT_EQ(dcs.size(), 3u);
+        EXPECT_EQ(racks.size(), 9u);
+        for (arctic::Ui32 dc : dcs) {
+            groupsByDC[dc]++;
+        }
+    }
+    // Группы используют все пять DC, а не только первые три.
+    for (arctic::Ui32 count : groupsByDC) {
+        EXPECT_GT(count, 0u);
+    }
+}
+
+TEST(TTopologyTest, Mirror3Of4GroupsUseFourDomains) {
+    arctic::InitTestLogger("topology_tests");
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.NumDCs = 4;
+    params.ErasureScheme = arctic::kMirror3Of4Scheme;
+
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(params));
+    ASSERT_FALSE(sim.Groups.Empty());
+    for (const auto& group : sim.Groups) {
+        ASSERT_EQ(group.Size, 8u);
+        std::vector<arctic::Ui32> vdisksByDC(params.NumDCs, 0);
+        for (arctic::Ui32 position = 0; position < group.Size; ++position) {
+            const arctic::TVDiskId vdiskId = arctic::TVDiskId::FromValue(group.VDisks[position]);
+            vdisksByDC[sim.VDisks[vdiskId]->GetDCId()]++;
+        }
+        EXPECT_EQ(vdisksByDC, std::vector<arctic::Ui32>(params.NumDCs, 2));
+    }
+
+    // Два домена целиком группа переживает, отказ в третьем - уже потеря.
+    sim.StartOutage(arctic::kDomainDC, 0, 2);
+    sim.StartOutage(arctic::kDomainDC, 1, 2);
+    sim.AdvanceHour();
+    EXPECT_TRUE(sim.LostGroupInfo.empty());
+    const arctic::TFailDomain& dc2 = sim.Topology.GetDomainRange(arctic::kDomainDC, 2);
+    ASSERT_TRUE(sim.FailPDisk(arctic::TPDiskId::FromValue(dc2.Begin)));
+    sim.AdvanceHour();
+    EXPECT_FALSE(sim.LostGroupInfo.empty());
+}
+
+TEST(TTopologyTest, DomainOutageIsTemporary) {
+    arctic::InitTestLogger("topology_tests");
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.ErasureScheme = arctic::kMirror3DcScheme;
+
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(params));
+    // Mirror-3-dc переживает потерю целого DC.
+    sim.StartOutage(arctic::kDomainDC, 0, 2);
+    sim.AdvanceHour();
+    EXPECT_TRUE(sim.LostGroupInfo.empty());
+    for (const auto& vdisk : sim.VDisks) {
+        EXPECT_EQ(vdisk->IsOffline(), vdisk->GetDCId() == 0);
+    }
+
+    sim.AdvanceHour();
+    sim.AdvanceHour();
+    for (const auto& vdisk : sim.VDisks) {
+        EXPECT_FALSE(vdisk->IsOffline());
+        EXPECT_EQ(vdisk->GetState(), arctic::TVDisk::Active);
+    }
+}
+
+TEST(TTopologyTest, RackOutageBreaksBlock42Groups) {
+    arctic::InitTestLogger("topology_tests");
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.ErasureScheme = arctic::kBlock42Scheme;
+
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(params));
+    // Стоек меньше, чем частей block-4-2, поэтому в одной стойке оказывается больше двух частей группы.
+    sim.StartOutage(arctic::kDomainRack, 0, 1);
+    sim.AdvanceHour();
+    EXPECT_FALSE(sim.LostGroupInfo.empty());
+
+    std::set<arctic::Ui32> brokenGroups;
+    for (const auto& vdisk : sim.VDisks) {
+        if (vdisk->IsOffline()) {
+            brokenGroups.insert(vdisk->GetGroupId().GetRawId());
+        }
+    }
+    for (const auto& [groupId, time] : sim.LostGroupInfo) {
+        EXPECT_TRUE(brokenGroups.count(groupId.GetRawId()));
+    }
+}
+
+// Спара только за аварией хоста: VDisk ждёт её, а не остаётся без репликации до нового отказа.
+TEST(TTopologyTest, ReplicationWaitsForOfflineSpare) {
+    arctic::InitTestLogger("topology_tests");
+    arctic::TSimulationParams params = arctic::MakeTestParams();
+    params.ErasureScheme = arctic::kMirror3DcScheme;
+    params.SpareDisksPerDc = 1;
+    arctic::Simulation sim;
+    sim.Reset(arctic::MakeTestConfig(params));
+
+    arctic::Ui32 spare = 0;
+    while (sim.PDisks[arctic::TPDiskId::FromValue(spare)]->GetState() != arctic::TPDisk::Spare) {
+        ++spare;
+    }
+    const arctic::Ui32 sparePDiskHost = sim.Topology.GetDomain(arctic::kDomainHost, spare);
+    ASSERT_NE(sim.Topology.GetDomain(arctic::kDomainHost, 0), sparePDiskHost);
+    const arctic::TVDisk& vdisk = *sim.VDisks[arctic::TVDiskId::FromValue(0)];
+    ASSERT_EQ(vdisk.GetDCId(), sim.PDisks[arctic::TPDiskId::FromValue(spare)]->GetDCId());
+
+    sim.StartOutage(arctic::kDomainHost, sparePDiskHost, 2);
+    ASSERT_TRUE(sim.FailPDisk(arctic::TPDiskId::FromValue(0)));
+    sim.AdvanceHour();
+    EXPECT_EQ(vdisk.GetState(), arctic::TVDisk::Faulty);
+    EXPECT_FALSE(vdisk.IsReplicationTriggered());
+    sim.AdvanceHour();
+    EXPECT_FALSE(vdisk.IsReplicationTriggered());
+    // Авария кончается в начале третьего часа, и в нём же начинается репликация.
+    sim.AdvanceHour();
+    EXPECT_EQ(vdisk.GetState(), arctic::TVDisk::Replicating);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "model/event_trace.h"
+#include "model/simulation.h"
+#include "model/simulation_params.h"
+#include "test_config.h"
+
+class TTraceTest : public ::testing::Test {
+protected:
+    arctic::TSimulationParams Params;
+
+    void SetUp() override {
+        arctic::InitTestLogger("trace_tests");
+        Params = arctic::MakeSmallTestParams();
+        Params.FailureRate = 30;
+    }
+};
+
+TEST(TVarintTest, RoundTrip) {
+    std::vector<arctic::Ui8> buffer;
+    const arctic::Ui64 values[] = {0, 1, 127, 128, 300, 1ull << 32, ~0ull};
+    for (arctic::Ui64 value : values) {
+        arctic::WriteVarint(buffer, value);
+    }
+    ASSERT_EQ(buffer[0], 0);
+    ASSERT_EQ(buffer[2], 127);
+
+    const arctic::Ui8* pos = buffer.data();
+    const arctic::Ui8* end = buffer.data() + buffer.size();
+    for (arctic::Ui64 value : values) {
+        arctic::Ui64 decoded = 0;
+        ASSERT_TRUE(arctic::ReadVarint(pos, end, decoded));
+        ASSERT_EQ(decoded, value);
+    }
+    ASSERT_EQ(pos, end);
+}
+
+TEST_F(TTraceTest, ReplayReproducesState) {
+    const std::string path = ::testing::TempDir() + "replay_test.dftrace";
+    ASSERT_TRUE(arctic::TTraceWriter::Instance().Open(path));
+
+    Params.HostOutagesPerYear = 2000;
+    Params.RackOutagesPerYear = 500;
+    // Seed прогона 64-битный и должен дойти до трейса целиком.
+    const arctic::Ui64 seed = arctic::MakeRunSeed(42, 0);
+    ASSERT_GT(seed >> 32, 0u);
+    arctic::TRandomStream rng(seed);
+    arctic::TTraceRecorder recorder;
+    arctic::Simulation original;
+    original.Reset(arctic::MakeTestConfig(Params));
+    original.Recorder = &recorder;
+    recorder.BeginRun(seed, original.GetConfig().Params);
+
+    arctic::Ui32 hours = 0;
+    while (hours < 30 * 24 && original.LostGroupInfo.empty()) {
+        original.SimulateHour(rng);
+        hours++;
+    }
+    recorder.EndRun(true);
+    arctic::TTraceWriter::Instance().Close();
+
+    arctic::TTraceReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    ASSERT_EQ(reader.GetRunCount(), 1u);
+    ASSERT_EQ(reader.GetRun(0).Seed, seed);
+    ASSERT_EQ(reader.GetRun(0).Params.DisksPerDc, 10u);
+
+    // Replay берёт параметры из трейса.
+    arctic::Simulation replayed;
+    ASSERT_TRUE(reader.Replay(0, hours, replayed));
+    ASSERT_EQ(replayed.GetConfig().Params, reader.GetRun(0).Params);
+
+    ASSERT_EQ(replayed.CurrentTime, original.CurrentTime);
+    ASSERT_EQ(replayed.LostGroupInfo, original.LostGroupInfo);
+    for (const auto& pdisk : original.PDisks) {
+        ASSERT_EQ(replayed.PDisks[pdisk->GetId()]->GetState(), pdisk->GetState());
+    }
+    for (const auto& vdisk : original.VDisks) {
+        ASSERT_EQ(replayed.VDisks[vdisk->GetId()]->GetState(), vdisk->GetState());
+        ASSERT_EQ(replayed.VDisks[vdisk->GetId()]->IsOffline(), vdisk->IsOffline());
+    }
+}
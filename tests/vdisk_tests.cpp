@@ -55,4 +55,21 @@ TEST(TVDiskTest, MarkReplication) {
     ASSERT_TRUE(vdisk.IsReplicationTriggered());
     ASSERT_EQ(vdisk.GetState(), arctic::TVDisk::Faulty);
     ASSERT_EQ(vdisk.GetReplicationCompleteTime(), 0.0);
-} 
\ No newline at end of file
+} 
+TEST(TVDiskTest, RepeatedFailureNeedsNewReplication) {
+    arctic::TVDisk vdisk(arctic::TVDiskId::FromValue(3), arctic::TPDiskId::FromValue(1), arctic::TDCId(0));
+
+    vdisk.SetState(arctic::TVDisk::Faulty);
+    vdisk.MarkReplicationTriggered(12.0);
+    vdisk.SetState(arctic::TVDisk::Replicated);
+    ASSERT_TRUE(vdisk.IsReplicationTriggered());
+
+    vdisk.SetState(arctic::TVDisk::Faulty);
+    ASSERT_FALSE(vdisk.IsReplicationTriggered());
+    ASSERT_EQ(vdisk.GetReplicationCompleteTime(), 0.0);
+
+    // Повторная пометка того же отказа флаг не сбрасывает.
+    vdisk.MarkReplicationTriggered(0.0);
+    vdisk.SetState(arctic::TVDisk::Faulty);
+    ASSERT_TRUE(vdisk.IsReplicationTriggered());
+}